@@ -0,0 +1,599 @@
+/*
+ * Copyright (C) 2019 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file   benchmarks/benchmark-suite.h
+ * @ingroup benchmarks
+ * @brief Regression benchmarks of the sparse apply, rank, det, solve, nullspace, CRA, polynomial matrix product
+ * and small prime dense kernels.
+ *
+ * Each group times one problem with each of its methods on a fixed corpus
+ * and adds one line per measure to a BenchmarkFile (see benchmarks/README):
+ * problem, algorithm, matrix, rowdim, coldim, nnz, time.
+ * Two such files are compared by compareRuns(), which reports the measures that got slower.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "benchmarks/CSValue.h"
+#include "benchmarks/BenchmarkFile.h"
+
+#include "linbox/algorithms/dense-nullspace.h"
+#include "linbox/algorithms/polynomial-matrix/polynomial-matrix-domain.h"
+#include "linbox/matrix/dense-matrix.h"
+#include "linbox/matrix/matrixdomain/blas-matrix-domain.h"
+#include "linbox/matrix/polynomial-matrix.h"
+#include "linbox/matrix/random-matrix.h"
+#include "linbox/matrix/sparse-matrix.h"
+#include "linbox/solutions/det.h"
+#include "linbox/solutions/methods.h"
+#include "linbox/solutions/rank.h"
+#include "linbox/solutions/solve.h"
+#include "linbox/util/args-parser.h"
+#include "linbox/util/error.h"
+#include "linbox/util/matrix-stream.h"
+#include "linbox/util/task-pool.h"
+#include "linbox/util/timer.h"
+#include "linbox/vector/blas-vector.h"
+
+#include <givaro/modular.h>
+#include <givaro/zring.h>
+
+namespace LinBox {
+    namespace Benchmarks {
+
+        /**
+         * \brief A matrix of the corpus, kept as its entries so that each format is built from the same data.
+         */
+        template <class Field>
+        struct CorpusMatrix {
+            typedef typename Field::Element Element;
+
+            std::string name;
+            size_t rowdim = 0;
+            size_t coldim = 0;
+            std::vector<std::tuple<size_t, size_t, Element>> entries;
+
+            size_t size() const { return entries.size(); }
+            bool square() const { return rowdim == coldim; }
+
+            /// Sets the entries of A, which has the dimensions of this matrix, and finalizes it.
+            template <class Matrix>
+            void fill(Matrix& A) const
+            {
+                for (const auto& e : entries) A.setEntry(std::get<0>(e), std::get<1>(e), std::get<2>(e));
+                A.finalize();
+            }
+
+            /// Sets the entries of the dense matrix A, which is zero.
+            void fillDense(BlasMatrix<Field>& A) const
+            {
+                for (const auto& e : entries) A.setEntry(std::get<0>(e), std::get<1>(e), std::get<2>(e));
+            }
+        };
+
+        /// Reads an SMS (or any MatrixStream format) file; throws LinboxError if it cannot be read.
+        template <class Field>
+        CorpusMatrix<Field> readCorpusMatrix(const Field& F, const std::string& path, const std::string& name)
+        {
+            std::ifstream input(path);
+            if (!input) throw LinboxError("LinBox ERROR: cannot open benchmark matrix " + path);
+
+            CorpusMatrix<Field> M;
+            M.name = name;
+            MatrixStream<Field> ms(F, input);
+            if (!ms.getDimensions(M.rowdim, M.coldim))
+                throw LinboxError("LinBox ERROR: bad benchmark matrix " + path);
+            size_t i, j;
+            typename Field::Element a;
+            while (ms.nextTriple(i, j, a)) {
+                if (!F.isZero(a)) M.entries.emplace_back(i, j, a);
+            }
+            return M;
+        }
+
+        /// Square matrix with a nonzero diagonal and w - 1 more random nonzero entries per row.
+        template <class Field>
+        CorpusMatrix<Field> randomCorpusMatrix(const Field& F, size_t n, size_t w, size_t seed)
+        {
+            CorpusMatrix<Field> M;
+            M.name = "random-" + std::to_string(n) + "-w" + std::to_string(w);
+            M.rowdim = M.coldim = n;
+            typename Field::RandIter G(F, 0, seed);
+            Givaro::GeneralRingNonZeroRandIter<Field, typename Field::RandIter> NZ(G);
+            std::vector<size_t> columns;
+            typename Field::Element a;
+            for (size_t i = 0; i < n; ++i) {
+                columns.assign(1, i);
+                for (size_t k = 1; k < w; ++k) columns.push_back((size_t)G.random(a) % n);
+                std::sort(columns.begin(), columns.end());
+                columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+                for (size_t j : columns) M.entries.emplace_back(i, j, NZ.random(a));
+            }
+            return M;
+        }
+
+        /**
+         * \brief The fixed corpus: the SMS files of benchmarks/matrix, then seeded random matrices
+         * of dimension scale and 4 scale with 3 and 10 entries per row.
+         * Files missing from matrixDir are skipped with a warning.
+         */
+        template <class Field>
+        std::vector<CorpusMatrix<Field>> corpus(const Field& F, const std::string& matrixDir, size_t scale)
+        {
+            static const char* files[] = {"bibd_12_5_66x792.sms", "bibd_13_6_78x1716.sms", "bibd_14_7_91x3432.sms"};
+
+            std::vector<CorpusMatrix<Field>> matrices;
+            for (const char* file : files) {
+                try {
+                    matrices.push_back(readCorpusMatrix(F, matrixDir + "/" + file, file));
+                } catch (const LinboxError& e) {
+                    std::cerr << e.what() << ", skipped." << std::endl;
+                }
+            }
+            size_t seed = 0;
+            for (size_t n : {scale, 4 * scale})
+                for (size_t w : {3, 10}) matrices.push_back(randomCorpusMatrix(F, n, w, ++seed));
+            return matrices;
+        }
+
+        /// What a measure is about, the key of the measure in compareRuns().
+        struct Record {
+            std::string problem;
+            std::string algorithm;
+            std::string matrix;
+            size_t rowdim = 0;
+            size_t coldim = 0;
+            size_t nnz = 0;
+        };
+
+        /**
+         * \brief Times functions and adds one line per measure to a BenchmarkFile.
+         * The time kept is the median of repeat runs.
+         */
+        class Suite {
+        public:
+            Suite(BenchmarkFile& file, size_t repeat = 3)
+                : _file(file)
+                , _repeat(std::max<size_t>(repeat, 1))
+            {
+                _file.setType("time", "seconds");
+            }
+
+            /// Times f and records it; a LinboxError thrown by f is reported and nothing is recorded.
+            template <class Function>
+            void run(const Record& r, Function f)
+            {
+                std::vector<double> times;
+                Timer chrono;
+                try {
+                    for (size_t k = 0; k < _repeat; ++k) {
+                        chrono.clear();
+                        chrono.start();
+                        f();
+                        chrono.stop();
+                        times.push_back(chrono.realtime());
+                    }
+                } catch (const LinboxError& e) {
+                    std::cerr << r.problem << " " << r.algorithm << " on " << r.matrix << " failed: " << e.what()
+                              << std::endl;
+                    return;
+                }
+                std::sort(times.begin(), times.end());
+
+                _file.addDataField("problem", CSString(r.problem));
+                _file.addDataField("algorithm", CSString(r.algorithm));
+                _file.addDataField("matrix", CSString(r.matrix));
+                _file.addDataField("rowdim", CSInt((int)r.rowdim));
+                _file.addDataField("coldim", CSInt((int)r.coldim));
+                _file.addDataField("nnz", CSInt((int)r.nnz));
+                _file.addDataField("time", CSDouble(times[times.size() / 2]));
+                _file.pushBackTest();
+            }
+
+        private:
+            BenchmarkFile& _file;
+            size_t _repeat;
+        };
+
+        template <class Field>
+        Record record(const std::string& problem, const std::string& algorithm, const CorpusMatrix<Field>& M)
+        {
+            Record r;
+            r.problem = problem;
+            r.algorithm = algorithm;
+            r.matrix = M.name;
+            r.rowdim = M.rowdim;
+            r.coldim = M.coldim;
+            r.nnz = M.size();
+            return r;
+        }
+
+        // Apply of one vector, then of b vectors one after the other and in parallel.
+        template <class Format, class Field>
+        void spmvFormat(Suite& suite, const Field& F, const std::string& format, const CorpusMatrix<Field>& M, size_t b)
+        {
+            SparseMatrix<Field, Format> A(F, M.rowdim, M.coldim);
+            M.fill(A);
+
+            typename Field::RandIter G(F, 0, 1);
+            std::vector<BlasVector<Field>> X(b, BlasVector<Field>(F, M.coldim)), Y(b, BlasVector<Field>(F, M.rowdim));
+            for (auto& x : X)
+                for (size_t i = 0; i < x.size(); ++i) G.random(x[i]);
+
+            // Enough applies for a measurable time.
+            const size_t count = std::max<size_t>(1, 10000000 / std::max<size_t>(1, M.size() * b));
+            suite.run(record("spmv", format + " apply", M), [&]() {
+                for (size_t k = 0; k < count * b; ++k) A.apply(Y[0], X[0]);
+            });
+            suite.run(record("spmv", format + " block apply", M), [&]() {
+                for (size_t k = 0; k < count; ++k)
+                    for (size_t j = 0; j < b; ++j) A.apply(Y[j], X[j]);
+            });
+            suite.run(record("spmv", format + " parallel block apply", M), [&]() {
+                for (size_t k = 0; k < count; ++k)
+                    TaskPool::global().parallelFor(0, b, 1, [&](size_t j) { A.apply(Y[j], X[j]); });
+            });
+        }
+
+        /// Sparse apply and block apply of b vectors, for each SparseMatrixFormat, on M.
+        template <class Field>
+        void spmv(Suite& suite, const Field& F, const CorpusMatrix<Field>& M, size_t b)
+        {
+            spmvFormat<SparseMatrixFormat::COO>(suite, F, "COO", M, b);
+            spmvFormat<SparseMatrixFormat::CSR>(suite, F, "CSR", M, b);
+            spmvFormat<SparseMatrixFormat::ELL>(suite, F, "ELL", M, b);
+            spmvFormat<SparseMatrixFormat::ELL_R>(suite, F, "ELL_R", M, b);
+            spmvFormat<SparseMatrixFormat::TPL>(suite, F, "TPL", M, b);
+#ifdef _OPENMP
+            spmvFormat<SparseMatrixFormat::TPL_omp>(suite, F, "TPL_omp", M, b);
+#endif
+            spmvFormat<SparseMatrixFormat::SMM>(suite, F, "SMM", M, b);
+            spmvFormat<SparseMatrixFormat::SparseSeq>(suite, F, "SparseSeq", M, b);
+            spmvFormat<SparseMatrixFormat::SparsePar>(suite, F, "SparsePar", M, b);
+            spmvFormat<SparseMatrixFormat::SparseMap>(suite, F, "SparseMap", M, b);
+        }
+
+        // Dense elimination is only timed up to this many entries.
+        static const size_t denseLimit = 16000000;
+
+        /// Rank by sparse elimination (vector and arena rows, Linear and Markowitz pivoting), dense elimination,
+        /// Method::Blackbox (Wiedemann) and Method::Auto.
+        template <class Field>
+        void rank(Suite& suite, const Field& F, const CorpusMatrix<Field>& M)
+        {
+            SparseMatrix<Field> A(F, M.rowdim, M.coldim);
+            M.fill(A);
+            size_t r;
+            suite.run(record("rank", "SparseElimination", M), [&]() { LinBox::rank(r, A, Method::SparseElimination()); });
+            suite.run(record("rank", "SparseElimination Markowitz", M),
+                      [&]() { LinBox::rank(r, A, Method::SparseElimination(PivotStrategy::Markowitz)); });
+            // Same elimination, with the rows in the arena of the thread; includes the copy, as rank does.
+            suite.run(record("rank", "SparseElimination arena", M), [&]() {
+                typename GaussDomain<Field>::Matrix B(F, M.rowdim, M.coldim);
+                M.fill(B);
+                GaussDomain<Field, GaussRowStorage::Arena>(F).rankInPlace(r, B);
+            });
+            if (M.rowdim * M.coldim <= denseLimit)
+                suite.run(record("rank", "DenseElimination", M), [&]() { LinBox::rank(r, A, Method::DenseElimination()); });
+            suite.run(record("rank", "Blackbox", M), [&]() { LinBox::rank(r, A, Method::Blackbox()); });
+            suite.run(record("rank", "Auto", M), [&]() { LinBox::rank(r, A, Method::Auto()); });
+        }
+
+        /// Determinant of square matrices, with the methods of rank.
+        template <class Field>
+        void det(Suite& suite, const Field& F, const CorpusMatrix<Field>& M)
+        {
+            if (!M.square()) return;
+            SparseMatrix<Field> A(F, M.rowdim, M.coldim);
+            M.fill(A);
+            typename Field::Element d;
+            suite.run(record("det", "SparseElimination", M), [&]() { LinBox::det(d, A, Method::SparseElimination()); });
+            suite.run(record("det", "SparseElimination Markowitz", M),
+                      [&]() { LinBox::det(d, A, Method::SparseElimination(PivotStrategy::Markowitz)); });
+            if (M.rowdim * M.coldim <= denseLimit)
+                suite.run(record("det", "DenseElimination", M), [&]() { LinBox::det(d, A, Method::DenseElimination()); });
+            suite.run(record("det", "Blackbox", M), [&]() { LinBox::det(d, A, Method::Blackbox()); });
+            suite.run(record("det", "Auto", M), [&]() { LinBox::det(d, A, Method::Auto()); });
+        }
+
+        /// Solve of square matrices for a random right hand side, with the methods of rank.
+        template <class Field>
+        void solve(Suite& suite, const Field& F, const CorpusMatrix<Field>& M)
+        {
+            if (!M.square()) return;
+            SparseMatrix<Field> A(F, M.rowdim, M.coldim);
+            M.fill(A);
+            BlasVector<Field> x(F, M.coldim), b(F, M.rowdim);
+            typename Field::RandIter G(F, 0, 2);
+            for (size_t i = 0; i < b.size(); ++i) G.random(b[i]);
+            suite.run(record("solve", "SparseElimination", M), [&]() { LinBox::solve(x, A, b, Method::SparseElimination()); });
+            if (M.rowdim * M.coldim <= denseLimit)
+                suite.run(record("solve", "DenseElimination", M), [&]() { LinBox::solve(x, A, b, Method::DenseElimination()); });
+            suite.run(record("solve", "Blackbox", M), [&]() { LinBox::solve(x, A, b, Method::Blackbox()); });
+            suite.run(record("solve", "Auto", M), [&]() { LinBox::solve(x, A, b, Method::Auto()); });
+        }
+
+        /// Right nullspace basis of the matrix made dense.
+        template <class Field>
+        void nullspace(Suite& suite, const Field& F, const CorpusMatrix<Field>& M)
+        {
+            if (M.rowdim * M.coldim > denseLimit) return;
+            BlasMatrix<Field> A(F, M.rowdim, M.coldim);
+            M.fillDense(A);
+            suite.run(record("nullspace", "NullSpaceBasis", M), [&]() {
+                BlasMatrix<Field> K(F);
+                size_t kerdim;
+                NullSpaceBasis(Tag::Side::Right, A, K, kerdim);
+            });
+        }
+
+        /// Integer determinant and solve by Chinese remaindering, on a random n x n matrix with entries of bits bits.
+        inline void cra(Suite& suite, size_t n, size_t bits, size_t seed)
+        {
+            typedef Givaro::ZRing<Integer> Ring;
+            Ring ZZ;
+            Ring::RandIter G(ZZ, bits, seed);
+            DenseMatrix<Ring> A(ZZ, n, n);
+            BlasVector<Ring> b(ZZ, n), x(ZZ, n);
+            RandomDenseMatrix<Ring::RandIter, Ring> RDM(ZZ, G);
+            RDM.randomFullRank(A);
+            b.random(G);
+
+            Record r;
+            r.matrix = "random-integer-" + std::to_string(n) + "-b" + std::to_string(bits);
+            r.rowdim = r.coldim = r.nnz = n;
+            r.nnz *= n;
+
+            r.problem = "det";
+            r.algorithm = "CRA";
+            Integer d;
+            suite.run(r, [&]() { LinBox::det(d, A, Method::Auto()); });
+
+            r.problem = "solve";
+            r.algorithm = "CRA";
+            suite.run(r, [&]() { LinBox::solve(x, d, A, b, Method::CRAAuto()); });
+        }
+
+        /// Product of two n x n polynomial matrices of degree d - 1 over an FFT prime.
+        inline void polynomialMatrixMul(Suite& suite, size_t n, size_t d, size_t seed)
+        {
+            typedef Givaro::Modular<double> Field;
+            typedef PolynomialMatrix<PMType::polfirst, PMStorage::plain, Field> MatrixP;
+            Field F(7340033); // 7 * 2^20 + 1
+            Field::RandIter G(F, 0, seed);
+            MatrixP A(F, n, n, d), B(F, n, n, d), C(F, n, n, 2 * d - 1);
+            for (size_t i = 0; i < n * n; ++i)
+                for (size_t k = 0; k < d; ++k) {
+                    G.random(A.ref(i, k));
+                    G.random(B.ref(i, k));
+                }
+            PolynomialMatrixDomain<Field> PMD(F);
+
+            Record r;
+            r.problem = "polynomial matrix mul";
+            r.algorithm = "PolynomialMatrixDomain";
+            r.matrix = "random-polynomial-" + std::to_string(n) + "-d" + std::to_string(d);
+            r.rowdim = r.coldim = n;
+            r.nnz = n * n * d;
+            suite.run(r, [&]() { PMD.mul(C, A, B); });
+        }
+
+        /// Product, matrix-vector product and rank of BlasMatrixDomain on random n x n matrices over F,
+        /// recorded as algorithm.
+        template <class Field>
+        void denseKernels(Suite& suite, const Field& F, const std::string& algorithm, size_t n, size_t seed)
+        {
+            const uint64_t p = (uint64_t)F.characteristic();
+            BlasMatrix<Field> A(F, n, n), B(F, n, n), C(F, n, n);
+            BlasVector<Field> x(F, n), y(F, n);
+            srand((unsigned)seed);
+            for (size_t i = 0; i < n; ++i) {
+                for (size_t j = 0; j < n; ++j) {
+                    F.init(A.refEntry(i, j), (uint64_t)rand() % p);
+                    F.init(B.refEntry(i, j), (uint64_t)rand() % p);
+                }
+                F.init(x[i], (uint64_t)rand() % p);
+            }
+            BlasMatrixDomain<Field> BMD(F);
+
+            Record r;
+            r.algorithm = algorithm;
+            r.matrix = "random-dense-" + std::to_string(n) + "-p" + std::to_string(p);
+            r.rowdim = r.coldim = n;
+            r.nnz = n * n;
+
+            r.problem = "dense mul";
+            suite.run(r, [&]() { BMD.mul(C, A, B); });
+            r.problem = "dense apply";
+            suite.run(r, [&]() { BMD.mul(y, A, x); });
+            r.problem = "dense rank";
+            suite.run(r, [&]() { BMD.rank(A); });
+        }
+
+        /// denseKernels over 8 and 16 bit residues (BLAS3::SmallPrimeDomain), and over
+        /// Givaro::Modular<double> (FFLAS) for the same primes.
+        inline void smallPrime(Suite& suite, size_t n, size_t seed)
+        {
+            denseKernels(suite, Givaro::Modular<uint8_t>(251), "SmallPrimeDomain uint8_t", n, seed);
+            denseKernels(suite, Givaro::Modular<double>(251), "FFLAS double", n, seed);
+            denseKernels(suite, Givaro::Modular<uint16_t>(65521), "SmallPrimeDomain uint16_t", n, seed);
+            denseKernels(suite, Givaro::Modular<double>(65521), "FFLAS double", n, seed);
+        }
+
+        /// Times of a BenchmarkFile written by a Suite, by "problem | algorithm | matrix".
+        inline std::map<std::string, double> readTimes(std::istream& is)
+        {
+            auto split = [](const std::string& line) {
+                std::vector<std::string> fields;
+                std::stringstream ss(line);
+                std::string field;
+                while (std::getline(ss, field, ',')) {
+                    const size_t first = field.find_first_not_of(' '), last = field.find_last_not_of(' ');
+                    fields.push_back(first == std::string::npos ? "" : field.substr(first, last - first + 1));
+                }
+                return fields;
+            };
+
+            std::string line;
+            while (std::getline(is, line) && line.compare(0, 13, "end, metadata") != 0) {
+            }
+            while (std::getline(is, line) && line.empty()) {
+            }
+            const std::vector<std::string> titles = split(line);
+            auto column = [&titles](const std::string& title) {
+                const size_t c = std::find(titles.begin(), titles.end(), title) - titles.begin();
+                if (c == titles.size()) throw LinboxError("LinBox ERROR: no " + title + " column in benchmark file");
+                return c;
+            };
+            const size_t problem = column("problem"), algorithm = column("algorithm");
+            const size_t matrix = column("matrix"), time = column("time");
+
+            std::map<std::string, double> times;
+            while (std::getline(is, line)) {
+                const std::vector<std::string> fields = split(line);
+                if (fields.size() != titles.size()) continue;
+                times[fields[problem] + " | " + fields[algorithm] + " | " + fields[matrix]] = std::atof(fields[time].c_str());
+            }
+            return times;
+        }
+
+        /**
+         * \brief Reports the measures of current that are slower than in base by more than tolerance
+         * (relative) and minTime seconds, and those missing from current. Returns the number of regressions.
+         */
+        inline size_t compareRuns(const std::map<std::string, double>& base, const std::map<std::string, double>& current,
+                                  double tolerance, double minTime, std::ostream& report)
+        {
+            size_t regressions = 0;
+            for (const auto& b : base) {
+                auto c = current.find(b.first);
+                if (c == current.end()) {
+                    report << "MISSING     " << b.first << std::endl;
+                    ++regressions;
+                    continue;
+                }
+                const double ratio = (b.second > 0) ? c->second / b.second : 1;
+                const bool significant = std::abs(c->second - b.second) > minTime;
+                const char* status = "ok         ";
+                if (significant && ratio > 1 + tolerance) {
+                    status = "REGRESSION ";
+                    ++regressions;
+                }
+                else if (significant && ratio < 1 - tolerance) {
+                    status = "improvement";
+                }
+                report << status << " " << b.first << ": " << b.second << "s -> " << c->second << "s (x" << ratio << ")"
+                       << std::endl;
+            }
+            for (const auto& c : current)
+                if (base.find(c.first) == base.end()) report << "NEW         " << c.first << ": " << c.second << "s" << std::endl;
+            return regressions;
+        }
+
+        /**
+         * \brief Options shared by the benchmark programs of the suite.
+         */
+        struct Options {
+            int repeat = 3;
+            int scale = 1000;
+            int block = LINBOX_DEFAULT_BLOCKING_FACTOR;
+            int seed = 0;
+            std::string matrixDir = "matrix";
+            std::string output;
+
+            /// Writes file to output, or to the standard output if none was given.
+            void write(BenchmarkFile& file) const
+            {
+                if (output.empty()) {
+                    file.write(std::cout);
+                }
+                else {
+                    std::ofstream os(output);
+                    file.write(os);
+                }
+            }
+        };
+
+        /// Metadata common to the files of the suite.
+        inline void addMetadata(BenchmarkFile& file, const std::string& problem, const Options& options)
+        {
+            file.addMetadata("problem", CSString(problem));
+            file.addMetadata("date", BenchmarkFile::getDateStamp());
+            file.setType("date", BenchmarkFile::getDateFormat());
+            file.addMetadata("threads", CSInt((int)TaskPool::global().numThreads()));
+            file.addMetadata("repeat", CSInt(options.repeat));
+            file.addMetadata("scale", CSInt(options.scale));
+            file.addMetadata("blockcoldim", CSInt(options.block));
+            file.addMetadata("seed", CSInt(options.seed));
+        }
+
+        /// Field of the corpus benchmarks, below BlasBound so that dense elimination applies.
+        typedef Givaro::Modular<double> CorpusField;
+
+        /**
+         * \brief main() of a benchmark program running group(suite, F, M, options) on each matrix M of the corpus.
+         */
+        template <class Group>
+        int runCorpusBenchmark(int argc, char** argv, const std::string& problem, Group group)
+        {
+            Options options;
+            Argument as[] = {{'i', "-i", "Set number of repetitions (the median is kept).", TYPE_INT, &options.repeat},
+                             {'n', "-n", "Set the dimension of the random matrices of the corpus.", TYPE_INT, &options.scale},
+                             {'b', "-b", "Set the number of vectors of block applies.", TYPE_INT, &options.block},
+                             {'s', "-s", "Seed for randomness.", TYPE_INT, &options.seed},
+                             {'d', "-d", "Directory of the SMS matrices of the corpus.", TYPE_STR, &options.matrixDir},
+                             {'o', "-o", "Benchmark file to write (standard output if none).", TYPE_STR, &options.output},
+                             END_OF_ARGUMENTS};
+            LinBox::parseArguments(argc, argv, as);
+
+            BenchmarkFile file;
+            addMetadata(file, problem, options);
+            CorpusField F(1000003);
+            file.addMetadata("field", CSString("Givaro::Modular<double>"));
+            file.addMetadata("modulus", CSInt(1000003));
+
+            Suite suite(file, options.repeat);
+            for (const auto& M : corpus(F, options.matrixDir, options.scale)) group(suite, F, M, options);
+            options.write(file);
+            return 0;
+        }
+    }
+}
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
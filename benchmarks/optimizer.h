@@ -24,12 +24,33 @@
 
 /*! @file   benchmarks/optimizer.h
  * @ingroup benchmarks
- *
+ * @brief Calibration of the Method::Auto cost model.
  */
 
 #ifndef __LINBOX_benchmarks_optimizer_H_
 #define __LINBOX_benchmarks_optimizer_H_
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "linbox/algorithms/blackbox-block-container.h"
+#include "linbox/algorithms/blackbox-container.h"
+#include "linbox/algorithms/block-coppersmith-domain.h"
+#include "linbox/algorithms/massey-domain.h"
+#include "linbox/matrix/dense-matrix.h"
+#include "linbox/matrix/matrix-domain.h"
+#include "linbox/matrix/sparse-matrix.h"
+#include "linbox/solutions/cost-model.h"
+#include "linbox/solutions/rank.h"
+#include "linbox/util/task-pool.h"
+#include "linbox/util/timer.h"
+#include "linbox/vector/blas-vector.h"
+#include "linbox/vector/vector-domain.h"
+
 namespace LinBox {
 
 	/* optimiser from a graph. */
@@ -49,29 +70,250 @@ namespace LinBox {
 	 *   ----
 	 */
 
-	// Optimizer opt(Data,Skeleton);
-	// opt.run();
-	// opt.report("file");
-
-	/* optimiser from two timers */
-	// Optimizer opt(class1,class2,Skeleton);
-	// opt.run();
-	// opt.report("file")
-	//
-	// opt.fit()
-	//
-	//
+	/** \brief Calibration of the cost model of Method::Auto (solutions/cost-model.h).
+	 *
+	 * run() times each kind of step of the model on random matrices over a word size field,
+	 * fit() derives the constants of a CostProfile from the timings,
+	 * report() writes the profile, to be read at run time through LINBOX_COST_PROFILE.
+	 * @code
+	 * Optimizer<Givaro::Modular<double>> opt(F, 1000);
+	 * opt.run();
+	 * opt.fit();
+	 * opt.report("linbox-cost-profile.txt");
+	 * @endcode
+	 */
+	template <class Field>
 	class Optimizer {
+	public:
+		typedef typename Field::Element Element;
+		typedef SparseMatrix<Field> Sparse;
+
+		/// Timings on matrices of dimension up to n (about 1000 takes a few seconds).
+		Optimizer(const Field& F, size_t n = 1000, size_t blockingFactor = LINBOX_DEFAULT_BLOCKING_FACTOR,
+			  size_t seed = 0) :
+			_field(F), _n(std::max<size_t>(n, 64)), _b(std::max<size_t>(blockingFactor, 2)), _seed(seed)
+		{}
+
+		/// Runs all timings.
+		void run()
+		{
+			srand((unsigned)_seed);
+			runDense();
+			runSparse();
+			runKrylov();
+			runBlock();
+		}
+
+		/// Sets the constants of profile() from the timings of run().
+		void fit()
+		{
+			CostProfile& P = _profile;
+
+			// t = denseOp n^3, least squares over the sizes.
+			double sxy = 0, sxx = 0;
+			for (const auto& t : _dense) {
+				const double x = t.first * t.first * t.first;
+				sxy += x * t.second;
+				sxx += x * x;
+			}
+			if (sxx > 0 && sxy > 0) P.denseOp = sxy / sxx;
+
+			P.applyOp = positive(_applyTime / _applyNonZeros, P.applyOp);
+			P.dotOp = positive(_dotTime / (double)_n, P.dotOp);
+
+			// t = sparseOp r w^2 with w = w0 r^alpha: the two sizes give t ~ r^(1 + 2 alpha).
+			if (_sparse.size() == 2) {
+				const double r1 = _sparse[0].rank, r2 = _sparse[1].rank;
+				const double t1 = _sparse[0].time, t2 = _sparse[1].time;
+				if (r1 > 0 && r2 > r1 && t1 > 0 && t2 > 0) {
+					const double alpha = (std::log(t2 / t1) / std::log(r2 / r1) - 1) / 2;
+					P.fillExponent = std::min(1.0, std::max(0.0, alpha));
+				}
+				const double w = std::min(r2, _sparse[1].rowWeight * std::pow(r2, P.fillExponent));
+				P.sparseOp = positive(t2 / (r2 * w * w), P.sparseOp);
+			}
+
+			// What is left of scalar Wiedemann once the applies and dot products are removed.
+			const double L = _krylovLength;
+			P.masseyOp = positive((_krylovTime - L * (_applyTime + P.dotOp * (double)_n)) / (L * L), P.masseyOp);
+
+			// Same for the block generator.
+			const double b = (double)_b, Lb = _blockLength, logL = std::log2(Lb + 1);
+			const double blockRest = _blockTime - Lb * b * _blockApplyTime - P.dotOp * b * b * (double)_n * Lb;
+			P.generatorOp = positive(blockRest / (b * b * b * Lb * logL * logL), P.generatorOp);
+
+			const double threads = (double)TaskPool::global().numThreads() - 1;
+			if (threads > 0 && _blockApplyParallel > 0) {
+				const double speedup = (_blockApplyTime * b) / (_blockApplyParallel * b);
+				P.blockEfficiency = std::min(1.0, std::max(0.0, (speedup - 1) / threads));
+			}
+		}
+
+		/// Prints the timings and the fitted constants, and writes the profile to filename.
+		void report(const std::string & filename)
+		{
+			std::ostream& os = std::cout;
+			for (const auto& t : _dense)
+				os << "dense rank n=" << t.first << ": " << t.second << "s" << std::endl;
+			for (const auto& t : _sparse)
+				os << "sparse rank n=" << t.n << " r=" << t.rank << ": " << t.time << "s" << std::endl;
+			os << "sparse apply nnz=" << _applyNonZeros << ": " << _applyTime << "s" << std::endl;
+			os << "dot n=" << _n << ": " << _dotTime << "s" << std::endl;
+			os << "Wiedemann sequence L=" << _krylovLength << ": " << _krylovTime << "s" << std::endl;
+			os << "block generator b=" << _b << " L=" << _blockLength << ": " << _blockTime << "s" << std::endl;
+			os << "block apply, 1 thread: " << _blockApplyTime * (double)_b << "s, "
+			   << TaskPool::global().numThreads() << " threads: " << _blockApplyParallel * (double)_b << "s" << std::endl;
+			_profile.save(filename);
+			os << "profile written to " << filename << std::endl;
+		}
+
+		const CostProfile& profile() const { return _profile; }
+
+	private:
+		struct SparseTiming {
+			double n, rank, rowWeight, time;
+		};
+
+		static double positive(double x, double fallback) { return (x > 0 && std::isfinite(x)) ? x : fallback; }
+
+		template <class Matrix>
+		void randomDense(Matrix& A)
+		{
+			typename Field::RandIter G(_field, 0, _seed);
+			for (size_t i = 0; i < A.rowdim(); ++i)
+				for (size_t j = 0; j < A.coldim(); ++j) G.random(A.refEntry(i, j));
+		}
+
+		// w nonzero entries per row, at random columns.
+		void randomSparse(Sparse& A, size_t w)
+		{
+			typename Field::RandIter G(_field, 0, _seed);
+			Givaro::GeneralRingNonZeroRandIter<Field, typename Field::RandIter> NZ(G);
+			Element a;
+			for (size_t i = 0; i < A.rowdim(); ++i)
+				for (size_t k = 0; k < w; ++k) A.setEntry(i, (size_t)rand() % A.coldim(), NZ.random(a));
+			A.finalize();
+		}
+
+		void runDense()
+		{
+			Timer chrono;
+			for (size_t n : {_n / 4, _n / 2, _n}) {
+				BlasMatrix<Field> A(_field, n, n);
+				randomDense(A);
+				size_t r;
+				chrono.clear();
+				chrono.start();
+				rank(r, A, Method::DenseElimination());
+				chrono.stop();
+				_dense.emplace_back((double)n, chrono.realtime());
+			}
+		}
+
+		void runSparse()
+		{
+			Timer chrono;
+			const size_t w = 3;
+			for (size_t n : {_n, 2 * _n}) {
+				Sparse A(_field, n, n);
+				randomSparse(A, w);
+				size_t r;
+				chrono.clear();
+				chrono.start();
+				rank(r, A, Method::SparseElimination());
+				chrono.stop();
+				_sparse.push_back({(double)n, (double)r, (double)A.size() / (double)n, chrono.realtime()});
+			}
+		}
+
+		// Sparse apply and dot product, then a whole scalar Wiedemann sequence and Berlekamp/Massey.
+		void runKrylov()
+		{
+			Timer chrono;
+			Sparse A(_field, _n, _n);
+			randomSparse(A, 10);
+			BlasVector<Field> x(_field, _n), y(_field, _n);
+			typename Field::RandIter G(_field, 0, _seed);
+			for (size_t i = 0; i < _n; ++i) G.random(x[i]);
+
+			const size_t repeat = 100;
+			chrono.clear();
+			chrono.start();
+			for (size_t k = 0; k < repeat; ++k) A.apply(y, x);
+			chrono.stop();
+			_applyNonZeros = (double)A.size();
+			_applyTime = chrono.realtime() / repeat;
 
+			VectorDomain<Field> VD(_field);
+			Element d;
+			chrono.clear();
+			chrono.start();
+			for (size_t k = 0; k < repeat; ++k) VD.dot(d, x, y);
+			chrono.stop();
+			_dotTime = chrono.realtime() / repeat;
 
+			BlasVector<Field> phi(_field);
+			size_t degree;
+			BlackboxContainer<Field, Sparse> sequence(&A, _field, G);
+			MasseyDomain<Field, BlackboxContainer<Field, Sparse>> WD(&sequence);
+			chrono.clear();
+			chrono.start();
+			WD.minpoly(phi, degree);
+			chrono.stop();
+			_krylovTime = chrono.realtime();
+			_krylovLength = 2.0 * (double)degree;
+		}
 
-		void report(const std::string & filename) ;
+		// Block Wiedemann generator, and block applies with one thread and with the whole pool.
+		void runBlock()
+		{
+			Timer chrono;
+			Sparse A(_field, _n, _n);
+			randomSparse(A, 10);
+			typedef BlackboxBlockContainer<Field, Sparse> Container;
+			MatrixDomain<Field> MD(_field);
+			std::vector<BlasMatrix<Field>> generator;
+			{
+				Container sequence(&A, _field, _b, _b, _seed);
+				BlockCoppersmithDomain<MatrixDomain<Field>, Container> coppersmith(MD, &sequence, 10);
+				chrono.clear();
+				chrono.start();
+				coppersmith.right_minpoly(generator);
+				chrono.stop();
+			}
+			_blockTime = chrono.realtime();
+			_blockLength = 2.0 * (double)_n / (double)_b + 10;
 
-		void run() ;
+			std::vector<BlasVector<Field>> X(_b, BlasVector<Field>(_field, _n)), Y(X);
+			typename Field::RandIter G(_field, 0, _seed);
+			for (auto& x : X)
+				for (size_t i = 0; i < _n; ++i) G.random(x[i]);
+			const size_t repeat = 10;
+			chrono.clear();
+			chrono.start();
+			for (size_t k = 0; k < repeat; ++k)
+				for (size_t j = 0; j < _b; ++j) A.apply(Y[j], X[j]);
+			chrono.stop();
+			_blockApplyTime = chrono.realtime() / (double)(repeat * _b);
+			chrono.clear();
+			chrono.start();
+			for (size_t k = 0; k < repeat; ++k)
+				TaskPool::global().parallelFor(0, _b, 1, [&](size_t j) { A.apply(Y[j], X[j]); });
+			chrono.stop();
+			_blockApplyParallel = chrono.realtime() / (double)(repeat * _b);
+		}
 
-		void fit();
+		const Field& _field;
+		size_t _n, _b, _seed;
+		CostProfile _profile;
 
-	}
+		std::vector<std::pair<double, double>> _dense; //!< (n, seconds)
+		std::vector<SparseTiming> _sparse;
+		double _applyNonZeros = 1, _applyTime = 0, _dotTime = 0;
+		double _krylovLength = 1, _krylovTime = 0;
+		double _blockLength = 1, _blockTime = 0;
+		double _blockApplyTime = 0, _blockApplyParallel = 0; //!< Seconds per vector.
+	};
 }
 
 #endif // __LINBOX_benchmarks_optimizer_H_
@@ -32,6 +32,7 @@
 
 #include "linbox/linbox-config.h"
 #include "linbox/util/debug.h"
+#include "linbox/util/tracer.h"
 
 #include "linbox/algorithms/blackbox-block-container-base.h"
 #include "linbox/matrix/dense-matrix.h"
@@ -111,6 +112,18 @@ namespace LinBox
 		}
 
 
+		/// Krylov block A^i V of the current value U A^i V.
+		const Block &krylov() const { return this->casenumber ? this->_blockV : _blockW; }
+
+		/** Positions the sequence on U W, for W = A^i V (e.g. saved by BlockSequenceStore):
+		 *  the next value is U A^{i+1} V, without the i applies.
+		 */
+		void seek(const Block &W) {
+			this->_blockV = W;
+			this->casenumber = 1;
+			_BMD.mul(this->_value, this->_blockU, this->_blockV);
+		}
+
 #ifdef _BBC_TIMING
 		void clearTimer() {
 			ttSequence.clear();
@@ -136,6 +149,7 @@ namespace LinBox
 			tSequence.clear();
 			tSequence.start();
 #endif
+			LINBOX_TRACE_COUNT (SpMV, _blockW.coldim());
 			if (this->casenumber) {
                                 this->Mul(_blockW,*this->_BB,this->_blockV);
 				_BMD.mul(this->_value, this->_blockU, _blockW);
@@ -68,6 +68,7 @@ namespace LinBox
 
 		void _launch ()
 		{
+			LINBOX_TRACE_COUNT (SpMV, 1);
 			if (this->casenumber > 0) {
 				if (this->casenumber == 1) {
 					this->casenumber = 2;
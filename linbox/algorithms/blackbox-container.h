@@ -33,6 +33,7 @@
 #include "linbox/randiter/archetype.h"
 #include "linbox/algorithms/blackbox-container-base.h"
 #include "linbox/util/timer.h"
+#include "linbox/util/tracer.h"
 
 namespace LinBox
 {
@@ -114,6 +115,7 @@ namespace LinBox
 #endif // INCLUDE_TIMING
 
 		void _launch () {
+			LINBOX_TRACE_COUNT (SpMV, 1);
 			if (this->casenumber) {
 #ifdef INCLUDE_TIMING
 				_timer.start ();
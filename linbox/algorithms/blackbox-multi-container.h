@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file algorithms/blackbox-multi-container.h
+ * @ingroup algorithms
+ * @brief Several scalar projections of the same Krylov sequence.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "linbox/integer.h"
+#include "linbox/matrix/dense-matrix.h"
+#include "linbox/util/debug.h"
+#include "linbox/util/tracer.h"
+
+namespace LinBox {
+
+    /**
+     * \brief Sequences u_j^T A^i v for k left projections u_1..u_k.
+     *
+     * Each step computes one apply A^i v, then the k projections at once
+     * as the product of the dense k x n matrix U by A^i v.
+     * The k sequences thus cost the applies of a single one,
+     * and give independent chances to find the minimal polynomial of v,
+     * which matters over small fields.
+     *
+     * Terms are computed on demand with extend() and kept, so that each
+     * projection can be read as a scalar sequence (see Projection) by MasseyDomain,
+     * possibly concurrently once the terms are there. See MultiMasseyDomain.
+     */
+    template <class Field, class Blackbox>
+    class BlackboxMultiContainer {
+    public:
+        using Element = typename Field::Element;
+
+        /// Scalar sequence u_j^T A^i v, for i < length, as expected by MasseyDomain.
+        class Projection {
+        public:
+            class const_iterator {
+            public:
+                const_iterator(const Projection* projection, size_t i)
+                    : _projection(projection)
+                    , _i(i)
+                {
+                }
+
+                const_iterator& operator++()
+                {
+                    ++_i;
+                    return *this;
+                }
+
+                const Element& operator*() const { return _projection->at(_i); }
+
+            private:
+                const Projection* _projection;
+                size_t _i;
+            };
+
+            Projection(const BlackboxMultiContainer& container, size_t j, size_t length)
+                : _container(&container)
+                , _j(j)
+                , _length(length)
+            {
+                linbox_check(length <= container.computed());
+            }
+
+            const_iterator begin() const { return const_iterator(this, 0); }
+
+            long size() const { return (long)_length; }
+
+            const Field& field() const { return _container->field(); }
+
+            /// Number of terms read so far, less than size() when Berlekamp/Massey terminated early.
+            size_t termsRead() const { return _read; }
+
+        private:
+            const Element& at(size_t i) const
+            {
+                linbox_check(i < _length);
+                _read = std::max(_read, i + 1);
+                return _container->term(_j, i);
+            }
+
+            const BlackboxMultiContainer* _container;
+            size_t _j;
+            size_t _length;
+            mutable size_t _read = 0;
+        };
+
+        /// Random projections U and vector v.
+        template <class RandIter>
+        BlackboxMultiContainer(const Blackbox* BB, const Field& F, RandIter& g, size_t numProjections)
+            : BlackboxMultiContainer(BB, F, BlasMatrix<Field>(F, numProjections, BB->rowdim()),
+                                     BlasVector<Field>(F, BB->coldim()))
+        {
+            for (size_t j = 0; j < numProjections; ++j)
+                for (size_t i = 0; i < _U.coldim(); ++i) g.random(_U.refEntry(j, i));
+            for (size_t i = 0; i < _krylov[0].size(); ++i) g.random(_krylov[0][i]);
+        }
+
+        /// Projections as the rows of U.
+        template <class Vector>
+        BlackboxMultiContainer(const Blackbox* BB, const Field& F, const BlasMatrix<Field>& U, const Vector& v)
+            : _field(&F)
+            , _BB(BB)
+            , _U(U)
+            , _krylov(2, BlasVector<Field>(F, BB->coldim()))
+            , _y(F, U.rowdim())
+            , _terms(U.rowdim())
+            , _size(2 * std::min(BB->rowdim(), BB->coldim()))
+        {
+            std::copy(v.begin(), v.end(), _krylov[0].begin());
+        }
+
+        const Field& field() const { return *_field; }
+        const Blackbox* getBB() const { return _BB; }
+
+        /// Length of the sequences needed for the minimal polynomial, 2 min(m, n).
+        long size() const { return (long)_size; }
+
+        size_t numProjections() const { return _terms.size(); }
+
+        /// Number of terms already computed.
+        size_t computed() const { return _terms[0].size(); }
+
+        /// u_j^T A^i v, with i < computed().
+        const Element& term(size_t j, size_t i) const { return _terms[j][i]; }
+
+        /// Computes the terms up to count, one apply and one k x n product each.
+        void extend(size_t count)
+        {
+            while (computed() < count) {
+                if (computed() > 0) {
+                    LINBOX_TRACE_COUNT(SpMV, 1);
+                    _BB->apply(_krylov[1 - _current], _krylov[_current]);
+                    _current = 1 - _current;
+                }
+                _U.apply(_y, _krylov[_current]);
+                for (size_t j = 0; j < numProjections(); ++j) _terms[j].push_back(_y[j]);
+            }
+        }
+
+    private:
+        const Field* _field;
+        const Blackbox* _BB;
+        BlasMatrix<Field> _U;
+        std::vector<BlasVector<Field>> _krylov; //!< A^i v and the previous one.
+        size_t _current = 0;
+        BlasVector<Field> _y;
+        std::vector<std::vector<Element>> _terms;
+        size_t _size;
+    };
+
+    /**
+     * \brief Number of projections worth setting in MethodBase::numProjections for Wiedemann over F.
+     * One projection finds each invariant factor of v with probability about 1 - 1/q,
+     * k of them with 1 - 1/q^k: k is chosen so that q^k > 2^10, at most 8.
+     * Above 2^10 elements, a single projection is kept.
+     * The default stays a single projection: more cost k dot products per apply.
+     */
+    template <class Field>
+    size_t suggestedNumProjections(const Field& F)
+    {
+        integer q;
+        F.cardinality(q);
+        if (q <= 1 || q >= 1024) return 1;
+        const double log2q = std::log2((double)q);
+        return std::min<size_t>(8, (size_t)std::ceil(10.0 / log2q));
+    }
+}
+
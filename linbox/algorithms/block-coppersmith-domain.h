@@ -30,6 +30,7 @@
 #include <iostream>
 #include <algorithm>
 #include <iomanip>
+#include <memory>
 
 #include "linbox/util/timer.h"
 
@@ -46,7 +47,11 @@ namespace LinBox {
 }
 #endif
 
+#include "linbox/algorithms/block-sequence-store.h"
 #include "linbox/util/commentator.h"
+#include "linbox/util/error.h"
+#include "linbox/util/task-pool.h"
+#include "linbox/util/tracer.h"
 
 #define DEFAULT_BLOCK_EARLY_TERM_THRESHOLD 10
 //Preprocessor variables for the state of BM_iterators
@@ -81,6 +86,7 @@ namespace LinBox
         Sequence                          *_container;
         const Domain                      *_MD;
         size_t            EARLY_TERM_THRESHOLD;
+        BlockSequenceStore<Field>         *_store = nullptr;
 
 
     public:
@@ -89,7 +95,7 @@ namespace LinBox
 Sequence> &Mat, size_t ett_default =
 DEFAULT_BLOCK_EARLY_TERM_THRESHOLD) :
             _container(Mat._container), _MD(Mat._MD),
-            EARLY_TERM_THRESHOLD (ett_default)
+            EARLY_TERM_THRESHOLD (ett_default), _store(Mat._store)
         {}
         BlockCoppersmithDomain (const Domain& MD, Sequence *D, size_t ett_default
 = DEFAULT_BLOCK_EARLY_TERM_THRESHOLD) :
@@ -108,6 +114,15 @@ EARLY_TERM_THRESHOLD (ett_default)
         Sequence *getSequence () const
         { return _container; }
 
+        /** Keeps the terms of the sequence in store instead of memory.
+         * Terms already in the store, e.g. computed by another job, are used first
+         * and the container (which may then be null) is only asked for the next ones.
+         * Every store->window() terms, the Krylov block of the container is saved as the resume point
+         * of the store, from which a container of a later job starts instead of recomputing the stored terms.
+         */
+        void setStore (BlockSequenceStore<Field> *store)
+        { _store = store; }
+
         // the principal function
         std::vector<size_t>  right_minpoly (std::vector<Coefficient> &P);
 
@@ -141,6 +156,7 @@ EARLY_TERM_THRESHOLD (ett_default)
 		std::list<Coefficient> _seq;
 		size_type _size;
 		size_t _row, _col;
+		BlockSequenceStore<Field> *_store = nullptr;
 
 	public:
 		BM_Seq(const Domain & MD, size_t r, size_t c) : _MD(&MD)
@@ -164,9 +180,27 @@ EARLY_TERM_THRESHOLD (ett_default)
 		BM_Seq() {}
 
 		BM_Seq(const BM_Seq& S) :
-			 _MD(S._MD), _seq(S._seq), _size(S._size), _row(S._row), _col(S._col)
+			 _MD(S._MD), _seq(S._seq), _size(S._size), _row(S._row), _col(S._col), _store(S._store)
 		{}
 
+		// The terms go to the store, which may already hold the first ones.
+		void setStore(BlockSequenceStore<Field> *store)
+		{
+			_store = store;
+			_size = (size_type)store->size();
+		}
+
+		bool stored() const
+		{
+			return _store != nullptr;
+		}
+
+		// M = i-th term, which stays on disk when stored.
+		const Coefficient &term(Coefficient &M, size_t i) const
+		{
+			return _store->read(M, i);
+		}
+
 		BM_Seq & operator=(const BM_Seq& S)
 		{
 			if(this != &S){
@@ -174,6 +208,7 @@ EARLY_TERM_THRESHOLD (ett_default)
 				(*this)._row = S._row;
 				(*this)._col = S._col;
 				(*this)._MD = S._MD;
+				(*this)._store = S._store;
 				_seq.clear();
 				for(typename std::list<Coefficient>::const_iterator it = S._seq.begin(); it != S._seq.end(); ++it)
 					_seq.push_back(*it);
@@ -205,7 +240,10 @@ EARLY_TERM_THRESHOLD (ett_default)
 		void push_back(const Coefficient &M)
 		{
 			if(_row==M.rowdim() && _col==M.coldim()){
-				_seq.push_back(M);
+				if (stored())
+					_store->push_back(M);
+				else
+					_seq.push_back(M);
 				++_size;
 			}
 		}
@@ -540,9 +578,11 @@ EARLY_TERM_THRESHOLD (ett_default)
 				//have become corrupt.
 				//Also reset the size to the correct size of the sequence
 				if(_size < _seq.size()){
-					_seqel = _seq.begin();
-					for(int i = 0; i<_t; ++i)
-						++_seqel;
+					if(!_seq.stored()){
+						_seqel = _seq.begin();
+						for(int i = 0; i<_t; ++i)
+							++_seqel;
+					}
 					_size = _seq.size();
 				}
 				//if the iterator points past the seq elements, do nothing
@@ -563,8 +603,10 @@ EARLY_TERM_THRESHOLD (ett_default)
 				std::vector<const Coefficient*> seqPtrVec;
 				for(genit = _gen.begin(); genit!=_gen.end(); ++genit){
 					coeffVec.push_back(&(*genit));
-					seqPtrVec.push_back(&(*cseqit));
-					--cseqit;
+					if(!_seq.stored()){
+						seqPtrVec.push_back(&(*cseqit));
+						--cseqit;
+					}
 				}
 				int numCoeffs=coeffVec.size();
 				std::vector <Coefficient> discComponents;
@@ -572,12 +614,15 @@ EARLY_TERM_THRESHOLD (ett_default)
 				for (int i=0;i<numCoeffs;++i) {
 					discComponents.push_back(Coefficient(field(),_row,_row+_col));
 				}
-#ifdef __LINBOX_USE_OPENMP
-#pragma omp parallel for
-#endif
-				for (int i=0;i<numCoeffs;++i) {
-					domain().axpyin(discComponents[i],*(seqPtrVec[i]),*(coeffVec[i]));
-				}
+				TaskPool::current().parallelFor(0, numCoeffs, 1, [&](size_t i) {
+					if(_seq.stored()){
+						// The terms on disk are read back one at a time by each task.
+						Coefficient seqTerm(field(),_row,_col);
+						domain().axpyin(discComponents[i],_seq.term(seqTerm,_t-i),*(coeffVec[i]));
+					}
+					else
+						domain().axpyin(discComponents[i],*(seqPtrVec[i]),*(coeffVec[i]));
+				});
 				for (int i=0;i<numCoeffs;++i) {
 					domain().addin(disc,discComponents[i]);
 				}
@@ -598,12 +643,9 @@ EARLY_TERM_THRESHOLD (ett_default)
 				g_time3 += start2.realtime();
 				CTimer start3; start3.start();
 				//Multiply tau into each matrix in the generator
-#ifdef __LINBOX_USE_OPENMP
-#pragma omp parallel for
-#endif
-				for (int i=0;i<numCoeffs;++i) {
+				TaskPool::current().parallelFor(0, numCoeffs, 1, [&](size_t i) {
 					domain().mulin(*(coeffVec[i]),tau);
-				}
+				});
                                 start3.stop();
 				g_time4 += start3.realtime();
 				//Increment the auxiliary degrees and beta
@@ -637,7 +679,8 @@ EARLY_TERM_THRESHOLD (ett_default)
 				domain().copy(genitaux,z1);
 				//Increment the t and seqel to the next element
 				++_t;
-				++_seqel;
+				if(!_seq.stored())
+					++_seqel;
 				//Update the state
 				if(/*  _delta < 0 || */_beta < _delta - _sigma + _mu +1){
 					if(_t == _size)
@@ -661,97 +704,10 @@ EARLY_TERM_THRESHOLD (ett_default)
 
 				return *this;
 			}
-			// Is this working? -AS
 			BM_iterator operator++(int)
 			{
-				//Create a copy of this
 				BM_iterator temp(*this);
-
-				//See if a matrix has been pushed on the sequence
-				//if it has, then recompute the seqel since it may
-				//have become corrupt.
-				//Also reset the size to the correct size of the sequence
-				if(_size < _seq.size()){
-					_seqel = _seq.begin();
-					for(int i = 0; i<_t; ++i)
-						++_seqel;
-					_size = _seq.size();
-				}
-				//if the iterator points past the seq elements, do nothing
-				if(_t == _size){
-					return *this;
-				}
-				//Initialize the discrepancy
-				Coefficient disc(field(),_row, _row+_col);
-				//Create two iterators, one for seq, and one for gen
-				typename BM_Seq::const_iterator cseqit;
-				typename std::list<Coefficient>::iterator genit;
-				//get an iterator to the seq element to be processed
-				cseqit = _seqel;
-				//Compute the discrepancy
-				for(genit = _gen.begin(); genit!=_gen.end(); ++genit, cseqit--){
-					domain().axpyin(disc,*cseqit,*genit);
-				} // cost: k*n^3 (nxn matrix muladds where k is current generator length)
-				  // is a reductive addition over independent muls.
-				//Compute tau with Algorith3.2
-				Coefficient tau(field(), _row+_col, _row+_col);
-				Algorithm3dot2(tau, disc, _deg, _mu, _sigma, _beta);
-				  // cost: n^3 for elim on n x about 2n
-				//Multiply tau into each matrix in the generator
-				for(genit = _gen.begin(); genit!=_gen.end(); ++genit){
-					domain().mulin(*genit,tau);
-				} // cost: k*n^3 (nxn matrix muls where k is current generator length)
-				  // is k independent muls with a shared mat tau.
-				//Increment the auxiliary degrees and beta
-				for(size_t j = _col; j <_row+_col; ++j)
-					_deg[j]++;
-				++_beta;
-				//Add a zero matrix to the end of the generator if needed.
-				int tmax = (int)_deg[0];
-				for(size_t j = 1; j<_row+_col; ++j)
-					if(tmax < _deg[j])
-						tmax = (int)_deg[j];
-				if(tmax+1 > _gensize){
-					_gen.push_back(Coefficient(field(),_col,_row+_col));
-					++_gensize;
-				}
-				//Mimic multiplication by z in the auxiliary columns
-				typename std::list<Coefficient>::reverse_iterator g1,g2;
-				g1 = _gen.rbegin();
-				g2 = _gen.rbegin();
-				++g1;
-				while(g1!=_gen.rend()){
-					Sub g1aux(*g1,0,_col,_col,_row);
-					Sub g2aux(*g2,0,_col,_col,_row);
-					domain().copy(g2aux,g1aux);
-					++g1;
-					++g2;
-				}
-				genit = _gen.begin();
-				Coefficient z1(field(),_col,_row);
-				Sub genitaux(*genit,0,_col,_col,_row);
-				domain().copy(genitaux,z1);
-				//Increment the t and seqel to the next element
-				++_t;
-				++_seqel;
-				//Update the state
-				if(/*  _delta < 0 || */ _beta < _delta - _sigma + _mu +1){
-					if(_t == _size)
-						_state._state = SequenceExceeded;
-					else{
-						if(_sigma > _delta /* && _delta >= 0 */)
-							_state._state = DeltaExceeded;
-						else
-							_state._state = GeneratorUnconfirmed;
-					}
-				}
-				else{
-					if(_sigma > _delta)
-						_state._state = DeltaExceeded;
-					else
-						_state._state = GeneratorFound;
-				}
-
+				++(*this);
 				return temp;
 			}
 			//return a reference to the current generator, in its algorithmic reversed form
@@ -829,30 +785,51 @@ EARLY_TERM_THRESHOLD (ett_default)
 	                                            _Sequence>::
 	right_minpoly (std::vector<Coefficient> &P)
     {
+	    LINBOX_TRACE_SPAN ("block coppersmith");
 	    //Get the row and column dimensions
-	    const size_t r = _container->rowdim();
-	    const size_t c = _container->coldim();
+	    const size_t r = _store ? _store->rowdim() : _container->rowdim();
+	    const size_t c = _store ? _store->coldim() : _container->coldim();
+	    const size_t n = _store ? _store->dimension() : _container->getBB()->rowdim();
 
-	    typename Sequence::const_iterator contiter(_container->begin());
 	    //Create the BM_Seq, that will use the Coppersmith Block Berlekamp Massey Algorithm to compute the minimal generator.
 	    BM_Seq seq(domain(),r,c);
+	    if (_store)
+		    seq.setStore(_store);
+
+	    //The container iterator points to the last term pushed, past the terms already stored.
+	    //It is positioned on the resume point of the store, if any, then advanced to the last term.
+	    std::unique_ptr<typename Sequence::const_iterator> contiter;
+	    if (_container) {
+		    contiter.reset(new typename Sequence::const_iterator(_container->begin()));
+		    const int first = (_store && seq.size() > 0) ? (int)_store->resume(*_container) : 0;
+		    for (int i = first + 1; i < seq.size(); ++i)
+			    ++(*contiter);
+	    }
 
 	    //Push the first projection onto the BM_Seq
-	    seq.push_back(*contiter);
+	    if (seq.size() == 0) {
+		    if (!_container)
+			    throw LinboxError("LinBox ERROR: empty block sequence");
+		    seq.push_back(**contiter);
+	    }
 
 	    //Create the BM_Seq iterator whose incrementation performs a step of the generator
 	    typename BM_Seq::BM_iterator bmit(seq.BM_begin(EARLY_TERM_THRESHOLD));
-	    bmit.setDelta((int)(2*_container->getBB()->rowdim()+1));
+	    bmit.setDelta((int)(2*n+1));
 	    typename BM_Seq::BM_iterator::TerminationState check = bmit.state();
 	    while(!check.IsGeneratorFound() ){
 		    ++bmit;
 		    check = bmit.state();
 		    if(check.IsSequenceExceeded()){
+			    if (!_container)
+				    throw LinboxError("LinBox ERROR: the stored block sequence is too short for its generator");
 			    CTimer start; start.start();
-			    ++contiter;
+			    ++(*contiter);
                             start.stop();
 			    g_time1+=start.realtime();
-			    seq.push_back(*contiter);
+			    seq.push_back(**contiter);
+			    if (_store && (seq.size() - 1) % std::max((int)_store->window(), 1) == 0)
+				    _store->saveResumePoint(*_container, seq.size() - 1);
 		    }
 	    }
 	    P = bmit.GetGenerator();
@@ -0,0 +1,404 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file algorithms/block-sequence-store.h
+ * @ingroup algorithms
+ * @brief Block sequence U A^i V kept in a file, for block Wiedemann runs that do not fit in memory.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "linbox/integer.h"
+#include "linbox/util/debug.h"
+#include "linbox/util/error.h"
+#include "linbox/util/tracer.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define __LINBOX_HAVE_MMAP 1
+#endif
+
+namespace LinBox {
+
+    /**
+     * \brief Block sequence stored in a file, with only the last terms in memory.
+     *
+     * Every term pushed is appended to the file; the last window() terms are also kept in memory.
+     * Older terms are read back from a read-only memory mapping of the file,
+     * so that the system can drop them from memory and page them in on demand.
+     * read() may be called concurrently, push_back() may not.
+     *
+     * The file is a 48 bytes header (magic, version, rowdim, coldim, dimension of the blackbox,
+     * size of an element, cardinality of the field, all little endian 64 bits words but the first two)
+     * followed by the terms, row major, as raw elements.
+     * A sequence computed by one job can then be opened by another one,
+     * on a machine with the same element representation, to compute the generator
+     * (see BlockCoppersmithDomain::setStore). A term partially written when a job was stopped is ignored.
+     *
+     * A resume point, the Krylov block A^i V of a term U A^i V, can be saved next to the file
+     * (path() + ".krylov": index, rowdim, coldim, then the raw elements), so that a container
+     * continuing the sequence is positioned on it instead of applying the blackbox i times again.
+     */
+    template <class Field>
+    class BlockSequenceStore {
+    public:
+        using Element = typename Field::Element;
+
+        static constexpr uint32_t Magic = 0x53424C42; // "BLBS"
+        static constexpr uint32_t Version = 1;
+        static constexpr size_t HeaderSize = 48;
+
+        /// Creates the file, replacing any previous one, for rowdim x coldim terms of the sequence of an n x n blackbox.
+        BlockSequenceStore(const Field& F, const std::string& path, size_t rowdim, size_t coldim, size_t dimension,
+                           size_t window = 16)
+            : _field(&F)
+            , _path(path)
+            , _rowdim(rowdim)
+            , _coldim(coldim)
+            , _dimension(dimension)
+            , _window(window)
+        {
+            static_assert(std::is_trivially_copyable<Element>::value,
+                          "BlockSequenceStore needs elements that can be written as raw bytes");
+            _file.handle = std::fopen(path.c_str(), "w+b");
+            if (_file.handle == nullptr) throw LinboxError("LinBox ERROR: cannot create block sequence " + path);
+
+            std::vector<uint8_t> header(HeaderSize, 0);
+            writeWord(header, 0, Magic, 4);
+            writeWord(header, 4, Version, 4);
+            writeWord(header, 8, _rowdim, 8);
+            writeWord(header, 16, _coldim, 8);
+            writeWord(header, 24, _dimension, 8);
+            writeWord(header, 32, sizeof(Element), 8);
+            writeWord(header, 40, cardinality(), 8);
+            if (std::fwrite(header.data(), 1, HeaderSize, _file.handle) != HeaderSize
+                || std::fflush(_file.handle) != 0) {
+                throw LinboxError("LinBox ERROR: cannot write block sequence " + path);
+            }
+            std::remove(resumePath().c_str());
+        }
+
+        /// Opens a sequence written before, possibly by another job. New terms are appended.
+        BlockSequenceStore(const Field& F, const std::string& path, size_t window = 16)
+            : _field(&F)
+            , _path(path)
+            , _window(window)
+        {
+            static_assert(std::is_trivially_copyable<Element>::value,
+                          "BlockSequenceStore needs elements that can be written as raw bytes");
+            _file.handle = std::fopen(path.c_str(), "r+b");
+            if (_file.handle == nullptr) throw LinboxError("LinBox ERROR: cannot open block sequence " + path);
+
+            std::vector<uint8_t> header(HeaderSize, 0);
+            const bool complete = std::fread(header.data(), 1, HeaderSize, _file.handle) == HeaderSize;
+            _rowdim = readWord(header, 8, 8);
+            _coldim = readWord(header, 16, 8);
+            _dimension = readWord(header, 24, 8);
+            if (!complete || readWord(header, 0, 4) != Magic || readWord(header, 4, 4) != Version
+                || readWord(header, 32, 8) != sizeof(Element)) {
+                throw LinboxError("LinBox ERROR: " + path + " is not a block sequence");
+            }
+            if (readWord(header, 40, 8) != cardinality()) {
+                throw LinboxError("LinBox ERROR: " + path + " is a block sequence over another field");
+            }
+
+            std::fseek(_file.handle, 0, SEEK_END);
+            _size = (static_cast<size_t>(std::ftell(_file.handle)) - HeaderSize) / termBytes();
+            // Drops a term partially written by a job that was stopped.
+            std::fseek(_file.handle, static_cast<long>(offset(_size)), SEEK_SET);
+            remap();
+        }
+
+        BlockSequenceStore(const BlockSequenceStore&) = delete;
+        BlockSequenceStore& operator=(const BlockSequenceStore&) = delete;
+
+        ~BlockSequenceStore() { unmap(); }
+
+        const Field& field() const { return *_field; }
+        const std::string& path() const { return _path; }
+        size_t rowdim() const { return _rowdim; }
+        size_t coldim() const { return _coldim; }
+
+        /// Dimension of the blackbox the sequence comes from.
+        size_t dimension() const { return _dimension; }
+
+        /// Number of terms.
+        size_t size() const { return _size; }
+
+        /// Number of the last terms also kept in memory.
+        size_t window() const { return _window; }
+
+        /// Appends a rowdim() x coldim() matrix.
+        template <class Matrix>
+        void push_back(const Matrix& M)
+        {
+            linbox_check(M.rowdim() == _rowdim && M.coldim() == _coldim);
+
+            std::vector<Element> term(_rowdim * _coldim);
+            for (size_t i = 0; i < _rowdim; ++i)
+                for (size_t j = 0; j < _coldim; ++j) _field->assign(term[i * _coldim + j], M.getEntry(i, j));
+
+            // The file may have been read in between, as fread and fwrite share the position.
+            std::fseek(_file.handle, static_cast<long>(offset(_size)), SEEK_SET);
+            if (std::fwrite(term.data(), sizeof(Element), term.size(), _file.handle) != term.size()
+                || std::fflush(_file.handle) != 0) {
+                throw LinboxError("LinBox ERROR: cannot write block sequence " + _path);
+            }
+            LINBOX_TRACE_COUNT(BytesMoved, term.size() * sizeof(Element));
+
+            _recent.push_back(std::move(term));
+            ++_size;
+            if (_recent.size() > _window) {
+                _recent.pop_front();
+                // Maps the new terms once the oldest term in memory is not mapped yet.
+                if (_size - _recent.size() > _mapped) remap();
+            }
+        }
+
+        /// M = i-th term.
+        template <class Matrix>
+        Matrix& read(Matrix& M, size_t i) const
+        {
+            linbox_check(i < _size);
+
+            const size_t firstRecent = _size - _recent.size();
+            if (i >= firstRecent) {
+                copy(M, _recent[i - firstRecent].data());
+                return M;
+            }
+
+            LINBOX_TRACE_COUNT(BytesMoved, _rowdim * _coldim * sizeof(Element));
+#ifdef __LINBOX_HAVE_MMAP
+            copy(M, reinterpret_cast<const Element*>(_map + offset(i)));
+#else
+            std::vector<Element> term(_rowdim * _coldim);
+            {
+                std::lock_guard<std::mutex> lock(_fileMutex);
+                std::fseek(_file.handle, static_cast<long>(offset(i)), SEEK_SET);
+                if (std::fread(term.data(), sizeof(Element), term.size(), _file.handle) != term.size()) {
+                    throw LinboxError("LinBox ERROR: cannot read block sequence " + _path);
+                }
+            }
+            copy(M, term.data());
+#endif
+            return M;
+        }
+
+        /// Appends the next count terms of a block container, e.g. BlackboxBlockContainer.
+        template <class Sequence>
+        void record(Sequence& sequence, size_t count)
+        {
+            const size_t first = _size;
+            typename Sequence::const_iterator it(sequence.begin());
+            for (size_t k = 0; k < count; ++k) {
+                if (k > 0) ++it;
+                push_back(*it);
+            }
+            // The terms of sequence are those of the store when it starts empty.
+            if (first == 0 && count > 0) saveResumePoint(sequence, _size - 1);
+        }
+
+        /**
+         * Saves the Krylov block A^index V of the current term U A^index V of sequence, the term index of the store,
+         * as the resume point. Does nothing for sequences which do not expose it (see BlackboxBlockContainer::krylov).
+         */
+        template <class Sequence>
+        void saveResumePoint(const Sequence& sequence, size_t index)
+        {
+            saveKrylov(sequence, index, 0);
+        }
+
+        /**
+         * Positions sequence, at its first term, on the resume point (see BlackboxBlockContainer::seek)
+         * and returns the index of its current term. Returns 0, the sequence being left as is,
+         * if there is no resume point or the sequence cannot be positioned.
+         */
+        template <class Sequence>
+        size_t resume(Sequence& sequence) const
+        {
+            return seekKrylov(sequence, 0);
+        }
+
+    private:
+        size_t termBytes() const { return _rowdim * _coldim * sizeof(Element); }
+
+        std::string resumePath() const { return _path + ".krylov"; }
+
+        template <class Sequence>
+        auto saveKrylov(const Sequence& sequence, size_t index, int) -> decltype(sequence.krylov(), void())
+        {
+            const auto& W = sequence.krylov();
+            std::vector<uint8_t> header(24, 0);
+            writeWord(header, 0, index, 8);
+            writeWord(header, 8, W.rowdim(), 8);
+            writeWord(header, 16, W.coldim(), 8);
+            std::vector<Element> block(W.rowdim() * W.coldim());
+            for (size_t i = 0; i < W.rowdim(); ++i)
+                for (size_t j = 0; j < W.coldim(); ++j) _field->assign(block[i * W.coldim() + j], W.getEntry(i, j));
+
+            // Written aside, then renamed: a job stopped meanwhile leaves the previous resume point.
+            const std::string path = resumePath() + ".tmp";
+            std::FILE* file = std::fopen(path.c_str(), "wb");
+            if (file == nullptr) throw LinboxError("LinBox ERROR: cannot write resume point " + path);
+            const bool written = std::fwrite(header.data(), 1, header.size(), file) == header.size()
+                                 && std::fwrite(block.data(), sizeof(Element), block.size(), file) == block.size();
+            if (std::fclose(file) != 0 || !written || std::rename(path.c_str(), resumePath().c_str()) != 0) {
+                throw LinboxError("LinBox ERROR: cannot write resume point " + path);
+            }
+            LINBOX_TRACE_COUNT(BytesMoved, block.size() * sizeof(Element));
+        }
+
+        template <class Sequence>
+        void saveKrylov(const Sequence&, size_t, long)
+        {
+        }
+
+        template <class Sequence>
+        auto seekKrylov(Sequence& sequence, int) const -> decltype(sequence.seek(sequence.krylov()), size_t())
+        {
+            std::FILE* file = std::fopen(resumePath().c_str(), "rb");
+            if (file == nullptr) return 0;
+
+            typename std::decay<decltype(sequence.krylov())>::type W(sequence.krylov());
+            std::vector<uint8_t> header(24, 0);
+            std::vector<Element> block(W.rowdim() * W.coldim());
+            bool complete = std::fread(header.data(), 1, header.size(), file) == header.size();
+            const size_t index = readWord(header, 0, 8);
+            complete = complete && readWord(header, 8, 8) == W.rowdim() && readWord(header, 16, 8) == W.coldim()
+                       && index < _size
+                       && std::fread(block.data(), sizeof(Element), block.size(), file) == block.size();
+            std::fclose(file);
+            if (!complete) return 0;
+
+            LINBOX_TRACE_COUNT(BytesMoved, block.size() * sizeof(Element));
+            for (size_t i = 0; i < W.rowdim(); ++i)
+                for (size_t j = 0; j < W.coldim(); ++j) W.setEntry(i, j, block[i * W.coldim() + j]);
+            sequence.seek(W);
+            return index;
+        }
+
+        template <class Sequence>
+        size_t seekKrylov(Sequence&, long) const
+        {
+            return 0;
+        }
+
+        size_t offset(size_t i) const { return HeaderSize + i * termBytes(); }
+
+        uint64_t cardinality() const
+        {
+            integer q;
+            _field->cardinality(q);
+            return static_cast<uint64_t>(q);
+        }
+
+        template <class Matrix>
+        void copy(Matrix& M, const Element* term) const
+        {
+            for (size_t i = 0; i < _rowdim; ++i)
+                for (size_t j = 0; j < _coldim; ++j) M.setEntry(i, j, term[i * _coldim + j]);
+        }
+
+        static void writeWord(std::vector<uint8_t>& bytes, size_t at, uint64_t value, size_t length)
+        {
+            for (size_t k = 0; k < length; ++k) bytes[at + k] = static_cast<uint8_t>(value >> (8 * k));
+        }
+
+        static uint64_t readWord(const std::vector<uint8_t>& bytes, size_t at, size_t length)
+        {
+            uint64_t value = 0;
+            for (size_t k = 0; k < length; ++k) value |= static_cast<uint64_t>(bytes[at + k]) << (8 * k);
+            return value;
+        }
+
+        // Maps all the terms of the file.
+        void remap()
+        {
+#ifdef __LINBOX_HAVE_MMAP
+            unmap();
+            if (_size == 0) return;
+            _mapBytes = offset(_size);
+            void* p = mmap(nullptr, _mapBytes, PROT_READ, MAP_SHARED, fileno(_file.handle), 0);
+            if (p == MAP_FAILED) {
+                _mapBytes = 0;
+                throw LinboxError("LinBox ERROR: cannot map block sequence " + _path);
+            }
+            _map = static_cast<const uint8_t*>(p);
+#endif
+            _mapped = _size;
+        }
+
+        void unmap()
+        {
+#ifdef __LINBOX_HAVE_MMAP
+            if (_map != nullptr) munmap(const_cast<uint8_t*>(_map), _mapBytes);
+            _map = nullptr;
+            _mapBytes = 0;
+#endif
+            _mapped = 0;
+        }
+
+        // Closed when the store is destroyed, or when its constructor throws.
+        struct File {
+            std::FILE* handle = nullptr;
+
+            File() = default;
+            File(const File&) = delete;
+            File& operator=(const File&) = delete;
+
+            ~File()
+            {
+                if (handle != nullptr) std::fclose(handle);
+            }
+        };
+
+        const Field* _field;
+        std::string _path;
+        File _file;
+        size_t _rowdim = 0;
+        size_t _coldim = 0;
+        size_t _dimension = 0;
+        size_t _window;
+        size_t _size = 0;
+        std::deque<std::vector<Element>> _recent; //!< The last terms, at most _window of them.
+        size_t _mapped = 0;                       //!< Terms covered by the mapping.
+        const uint8_t* _map = nullptr;
+        size_t _mapBytes = 0;
+        mutable std::mutex _fileMutex;
+    };
+}
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -34,6 +34,7 @@
 #include <stdlib.h>
 #include "linbox/integer.h"
 #include "linbox/solutions/methods.h"
+#include "linbox/util/serialization.h"
 #include "linbox/vector/blas-vector.h"
 #include <utility>
 
@@ -258,6 +259,67 @@ namespace LinBox
             return shelves_.rend();
         }
 
+        /** @brief Appends the shelves and their moduli to bytes, for a Checkpoint.
+         * The bound is not saved, it is the one given to the constructor.
+         */
+        uint64_t serialize(std::vector<uint8_t>& bytes) const
+        {
+            uint64_t bytesWritten = LinBox::serialize(bytes, totalsize_);
+            bytesWritten += LinBox::serialize(bytes, static_cast<uint64_t>(dimension_));
+            bytesWritten += LinBox::serialize(bytes, static_cast<uint64_t>(shelves_.size()));
+            for (const auto& shelf : shelves_) {
+                bytesWritten += LinBox::serialize(bytes, static_cast<uint8_t>(shelf.occupied));
+                if (! shelf.occupied) continue;
+                bytesWritten += LinBox::serialize(bytes, static_cast<int64_t>(shelf.count));
+                bytesWritten += LinBox::serialize(bytes, shelf.logmod);
+                bytesWritten += LinBox::serialize(bytes, shelf.mod());
+                bytesWritten += LinBox::serialize(bytes, static_cast<uint64_t>(shelf.residue.size()));
+                for (const auto& x : shelf.residue) {
+                    bytesWritten += LinBox::serialize(bytes, x);
+                }
+            }
+            return bytesWritten;
+        }
+
+        /** @brief Restores the state saved by serialize().
+         * @returns the number of bytes read.
+         */
+        uint64_t unserialize(const std::vector<uint8_t>& bytes, uint64_t offset = 0u)
+        {
+            uint64_t dimension, numShelves, size;
+            uint64_t bytesRead = LinBox::unserialize(totalsize_, bytes, offset);
+            bytesRead += LinBox::unserialize(dimension, bytes, offset + bytesRead);
+            bytesRead += LinBox::unserialize(numShelves, bytes, offset + bytesRead);
+            dimension_ = dimension;
+
+            shelves_.clear();
+            for (uint64_t k = 0; k < numShelves; ++k) {
+                shelves_.emplace_back(dimension_);
+                Shelf& shelf = shelves_.back();
+                uint8_t occupied;
+                bytesRead += LinBox::unserialize(occupied, bytes, offset + bytesRead);
+                shelf.occupied = occupied;
+                if (! shelf.occupied) continue;
+
+                int64_t count;
+                Integer mod;
+                bytesRead += LinBox::unserialize(count, bytes, offset + bytesRead);
+                bytesRead += LinBox::unserialize(shelf.logmod, bytes, offset + bytesRead);
+                bytesRead += LinBox::unserialize(mod, bytes, offset + bytesRead);
+                bytesRead += LinBox::unserialize(size, bytes, offset + bytesRead);
+                shelf.count = count;
+                shelf.mod.initialize(mod);
+                shelf.residue.resize(size);
+                for (auto& x : shelf.residue) {
+                    bytesRead += LinBox::unserialize(x, bytes, offset + bytesRead);
+                }
+            }
+
+            collapsed_ = false;
+            normalized_ = false;
+            return bytesRead;
+        }
+
 	protected:
         /** Returns the index where the shelf (with specified natural log of modulus) belongs.
          */
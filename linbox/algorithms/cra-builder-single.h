@@ -37,6 +37,7 @@
 #include "linbox/solutions/methods.h"
 #include "linbox/algorithms/cra-domain.h"
 #include "linbox/algorithms/cra-builder-full-multip.h"
+#include "linbox/util/serialization.h"
 #include <vector>
 #include <array>
 #include <utility>
@@ -311,6 +312,27 @@ namespace LinBox
 			return primeProd_.bitsize() + nextM_.bitsize() - 1;
 		}
 
+		/** @brief Appends the residue and the modulus to bytes, for a Checkpoint.
+		 */
+		uint64_t serialize(std::vector<uint8_t>& bytes) const
+		{
+			uint64_t bytesWritten = LinBox::serialize(bytes, primeProd_);
+			bytesWritten += LinBox::serialize(bytes, nextM_);
+			bytesWritten += LinBox::serialize(bytes, residue_);
+			return bytesWritten;
+		}
+
+		/** @brief Restores the state saved by serialize().
+		 * @returns the number of bytes read.
+		 */
+		uint64_t unserialize(const std::vector<uint8_t>& bytes, uint64_t offset = 0u)
+		{
+			uint64_t bytesRead = LinBox::unserialize(primeProd_, bytes, offset);
+			bytesRead += LinBox::unserialize(nextM_, bytes, offset + bytesRead);
+			bytesRead += LinBox::unserialize(residue_, bytes, offset + bytesRead);
+			return bytesRead;
+		}
+
 		virtual ~CRABuilderSingleBase() {}
 
 #ifdef _LB_CRATIMING
@@ -440,6 +462,23 @@ namespace LinBox
 		{
 			return occurency_ > EARLY_TERM_THRESHOLD;
 		}
+
+		/** @brief Appends the residue, the modulus and the termination counter to bytes.
+		 */
+		uint64_t serialize(std::vector<uint8_t>& bytes) const
+		{
+			uint64_t bytesWritten = Base::serialize(bytes);
+			return bytesWritten + LinBox::serialize(bytes, static_cast<uint32_t>(occurency_));
+		}
+
+		uint64_t unserialize(const std::vector<uint8_t>& bytes, uint64_t offset = 0u)
+		{
+			uint32_t occurency;
+			uint64_t bytesRead = Base::unserialize(bytes, offset);
+			bytesRead += LinBox::unserialize(occurency, bytes, offset + bytesRead);
+			occurency_ = occurency;
+			return bytesRead;
+		}
 	};
 
 
@@ -552,6 +591,20 @@ namespace LinBox
 		{
 			return curfailprob_ <= failbound_;
 		}
+
+		/** @brief Appends the residue, the modulus and the failure probability to bytes.
+		 */
+		uint64_t serialize(std::vector<uint8_t>& bytes) const
+		{
+			uint64_t bytesWritten = Base::serialize(bytes);
+			return bytesWritten + LinBox::serialize(bytes, curfailprob_);
+		}
+
+		uint64_t unserialize(const std::vector<uint8_t>& bytes, uint64_t offset = 0u)
+		{
+			uint64_t bytesRead = Base::unserialize(bytes, offset);
+			return bytesRead + LinBox::unserialize(curfailprob_, bytes, offset + bytesRead);
+		}
 	};
 
 
@@ -26,10 +26,13 @@
 
 #pragma once
 
+#include <deque>
+#include <type_traits>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "linbox/algorithms/cra-builder-full-multip.h"
 #include "linbox/algorithms/cra-domain.h"
 #include "linbox/algorithms/rational-cra.h"
 #include "linbox/algorithms/rational-cra-var-prec.h"
@@ -43,19 +46,60 @@
 
 namespace LinBox {
 
+    /**
+     * Whether the builder can incorporate a vector of residues modulo
+     * a composite Integer modulus, i.e. the result of another builder.
+     */
+    template <class CRABase>
+    struct CRABuilderAcceptsIntegerModulus {
+        template <class B>
+        static auto test(int) -> decltype(std::declval<B&>().progress(std::declval<const Integer&>(),
+                                                                      std::declval<const std::vector<Integer>&>()),
+                                          std::true_type());
+        template <class B>
+        static std::false_type test(...);
+
+        using type = decltype(test<CRABase>(0));
+    };
+
+    /**
+     * CRA distributed over MPI.
+     *
+     * The master (rank 0) hands out the primes on demand:
+     * each worker has at most two primes pending, and asks for a new one
+     * each time it is done with one, so that faster workers compute more residues.
+     * Workers look for new primes with non-blocking probes while computing.
+     * Once the builder is terminated, the master sends a stop message (prime 0)
+     * to every worker: a worker drops the primes it did not start and answers with 0,
+     * the master collecting the residues sent meanwhile until every worker answered.
+     *
+     * For vector results, when the builder accepts Integer moduli (full multiplicity builders),
+     * workers fold their residues into local CRABuilderFullMultip shelves and only report
+     * the primes they are done with. The master stops when these primes reach the bound,
+     * which is the termination test of the builder, then the partial results are merged
+     * along a binary tree over the workers, so that the master receives a single message.
+     * Otherwise (early terminated builders), every residue is sent to the master,
+     * which checks Builder_.terminated() after each of them.
+     *
+     * Primes and stop messages, reports of the workers and merged results each have their
+     * own tag, so that the master receiving reports from any worker never gets a merged result.
+     */
     template <class CRABase>
     struct ChineseRemainderDistributed {
         using Domain = typename CRABase::Domain;
 
-        // @note This causes the algorithm to give wrong answer sometimes...
-        // using MaskedPrimeGenerator = MaskedPrimeIterator<IteratorCategories::HeuristicTag>;
-        using MaskedPrimeGenerator = MaskedPrimeIterator<IteratorCategories::DeterministicTag>;
-
     protected:
         CRABase Builder_;
         Communicator* _pCommunicator;
         double _hadamardLogBound;
-        double _workerHadamardLogBound = 0.0; //!< Each worker will compute primes until this is hit.
+        size_t _pendingPrimesPerWorker = 2; //!< Primes given in advance to each worker.
+
+        // Message tags
+        enum : int {
+            PrimeTag = 1,  // master -> worker: a prime to compute, 0 to stop
+            ReportTag = 2, // worker -> master: a prime done (and its residue), 0 when stopped
+            MergeTag = 3,  // worker -> worker or master: partial results of the reduction tree
+        };
 
     public:
         ChineseRemainderDistributed(double b, Communicator* c)
@@ -63,9 +107,6 @@ namespace LinBox {
             , _pCommunicator(c)
             , _hadamardLogBound(b)
         {
-            if (c && c->size() > 1) {
-                _workerHadamardLogBound = _hadamardLogBound / (c->size() - 1);
-            }
         }
 
         /** \brief The CRA loop.
@@ -126,10 +167,10 @@ namespace LinBox {
             typename Domain::Element r;
 
             if (_pCommunicator->master()) {
-                master_process_task(Iteration, D, r);
+                master_process_task(Iteration, primeGenerator, D, r, std::false_type());
             }
             else {
-                worker_process_task(Iteration, r);
+                worker_process_task(Iteration, r, std::false_type());
             }
         }
 
@@ -139,70 +180,198 @@ namespace LinBox {
             Domain D(*primeGenerator);
             BlasVector<Domain> r(D);
 
+            typename CRABuilderAcceptsIntegerModulus<CRABase>::type precombine;
             if (_pCommunicator->master()) {
-                master_process_task(Iteration, D, r);
+                master_process_task(Iteration, primeGenerator, D, r, precombine);
             }
             else {
-                worker_process_task(Iteration, r);
+                worker_process_task(Iteration, r, precombine);
             }
         }
 
-        template <class Any, class PrimeIterator, class Function>
-        void worker_compute(PrimeIterator& gen, Function& Iteration, Any& r)
+        // ----- Workers
+
+        /// Computes the residues for the primes given by the master, until it sends 0.
+        template <class Any, class Function, class Precombine>
+        void worker_process_task(Function& Iteration, Any& r, Precombine precombine)
         {
-            // Process mutual independent prime number generation
-            ++gen;
-            while (Builder_.noncoprime(*gen)) {
-                ++gen;
+            CRABuilderFullMultip<Domain> shelves(_hadamardLogBound);
+            std::deque<uint64_t> primes;
+
+            while (true) {
+                // Block only when there is nothing left to compute
+                bool stopped = false;
+                while (!stopped && (primes.empty() || _pCommunicator->iprobe(0, PrimeTag))) {
+                    uint64_t p;
+                    _pCommunicator->recv(p, 0, PrimeTag);
+                    if (p == 0) {
+                        stopped = true;
+                    }
+                    else {
+                        primes.push_back(p);
+                    }
+                }
+                if (stopped) break;
+
+                uint64_t p = primes.front();
+                primes.pop_front();
+                Domain D(p);
+                Iteration(r, D);
+                worker_report(shelves, D, p, r, precombine);
             }
 
-            Domain D(*gen);
-            Iteration(r, D);
+            // The primes still queued are not needed anymore.
+            const uint64_t done = 0;
+            _pCommunicator->send(done, 0, ReportTag);
+            worker_flush(shelves, precombine);
+        }
+
+        template <class Any>
+        void worker_report(CRABuilderFullMultip<Domain>& shelves, Domain& D, uint64_t p, Any& r, std::true_type)
+        {
+            shelves.progress(D, r);
+            _pCommunicator->send(p, 0, ReportTag);
         }
 
-        template <class Any, class Function>
-        void worker_process_task(Function& Iteration, Any& r)
+        template <class Any>
+        void worker_report(CRABuilderFullMultip<Domain>&, Domain&, uint64_t p, Any& r, std::false_type)
         {
-            MaskedPrimeGenerator gen(_pCommunicator->rank() - 1, _pCommunicator->size() - 1);
+            _pCommunicator->send(p, 0, ReportTag);
+            _pCommunicator->send(r, 0, ReportTag);
+        }
+
+        void worker_flush(CRABuilderFullMultip<Domain>&, std::false_type) {}
 
-            // Each worker will work until _workerHadamardLogBound is hit
-            double primesLogSum = 0.0;
-            while (primesLogSum < _workerHadamardLogBound) {
-                worker_compute(gen, Iteration, r);
+        // Binary reduction tree over the workers: at each step,
+        // worker k receives the partial result of worker k + step.
+        void worker_flush(CRABuilderFullMultip<Domain>& shelves, std::true_type)
+        {
+            const int k = _pCommunicator->rank() - 1;
+            const int numWorkers = _pCommunicator->size() - 1;
+            Integer modulus;
+            std::vector<Integer> residue;
+            for (int step = 1; step < numWorkers; step <<= 1) {
+                if (k % (2 * step) == step) {
+                    send_shelves(shelves, k - step + 1);
+                    return;
+                }
 
-                uint64_t p = *gen;
-                primesLogSum += Givaro::logtwo(p);
-                _pCommunicator->send(p, 0);
-                _pCommunicator->send(r, 0);
+                if (k + step < numWorkers) {
+                    _pCommunicator->recv(modulus, k + step + 1, MergeTag);
+                    _pCommunicator->recv(residue, k + step + 1, MergeTag);
+                    if (modulus > 1) shelves.progress(modulus, residue);
+                }
             }
 
-            uint64_t poisonPill = 0;
-            _pCommunicator->send(poisonPill, 0);
+            send_shelves(shelves, 0);
         }
 
-        template <class Any, class Function>
-        void master_process_task(Function& Iteration, Domain& D, Any& r)
+        void send_shelves(const CRABuilderFullMultip<Domain>& shelves, int dest)
+        {
+            Integer modulus;
+            std::vector<Integer> residue;
+            shelves.getModulus(modulus);
+            shelves.result(residue);
+            _pCommunicator->send(modulus, dest, MergeTag);
+            _pCommunicator->send(residue, dest, MergeTag);
+        }
+
+        // ----- Master
+
+        /// Hands out the primes on demand and stops the workers once the builder is terminated.
+        template <class Any, class Function, class PrimeIterator, class Precombine>
+        void master_process_task(Function& Iteration, PrimeIterator& primeGenerator, Domain& D, Any& r,
+                                 Precombine precombine)
         {
             Iteration(r, D);
             Builder_.initialize(D, r);
 
-            uint32_t workersDone = _pCommunicator->size() - 1;
-            while (workersDone > 0) {
-                // Receive the prime
+            const uint64_t firstPrime = *primeGenerator;
+            std::unordered_set<uint64_t> usedPrimes = {firstPrime};
+            auto nextPrime = [&]() {
+                uint64_t p;
+                do {
+                    ++primeGenerator;
+                    p = *primeGenerator;
+                } while (!usedPrimes.insert(p).second);
+                return p;
+            };
+
+            const int numWorkers = _pCommunicator->size() - 1;
+            for (int w = 1; w <= numWorkers; ++w) {
+                for (size_t k = 0; k < _pendingPrimesPerWorker; ++k) {
+                    _pCommunicator->send(nextPrime(), w, PrimeTag);
+                }
+            }
+
+            bool terminated = Builder_.terminated();
+            bool stopSent = false;
+            auto stopWorkers = [&]() {
+                const uint64_t stop = 0;
+                for (int w = 1; w <= numWorkers; ++w) _pCommunicator->send(stop, w, PrimeTag);
+                stopSent = true;
+            };
+            if (terminated) stopWorkers();
+
+            // Only used with pre-combination, where the residues stay on the workers.
+            double primesLogSum = Givaro::logtwo(firstPrime);
+            int runningWorkers = numWorkers;
+            while (runningWorkers > 0) {
                 uint64_t p;
-                _pCommunicator->recv(p, MPI_ANY_SOURCE);
+                _pCommunicator->recv(p, MPI_ANY_SOURCE, ReportTag);
+                const int w = _pCommunicator->status().MPI_SOURCE;
+
+                // Worker w got the stop and dropped its queue.
                 if (p == 0) {
-                    workersDone -= 1;
+                    --runningWorkers;
                     continue;
                 }
 
-                // Receive result vector and update builder
-                _pCommunicator->recv(r, _pCommunicator->status().MPI_SOURCE);
+                if (master_collect(p, w, r, primesLogSum, precombine)) {
+                    terminated = true;
+                }
 
+                if (!terminated) {
+                    _pCommunicator->send(nextPrime(), w, PrimeTag);
+                }
+                else if (!stopSent) {
+                    stopWorkers();
+                }
+            }
+
+            master_finalize(precombine);
+        }
+
+        // The residue of p stays in the shelves of worker w.
+        template <class Any>
+        bool master_collect(uint64_t p, int, Any&, double& primesLogSum, std::true_type)
+        {
+            primesLogSum += Givaro::logtwo(p);
+            return primesLogSum > _hadamardLogBound;
+        }
+
+        template <class Any>
+        bool master_collect(uint64_t p, int w, Any& r, double&, std::false_type)
+        {
+            _pCommunicator->recv(r, w, ReportTag);
+            if (!Builder_.terminated()) {
                 Domain D(p);
                 Builder_.progress(D, r);
             }
+            return Builder_.terminated();
         }
+
+        // Everything from the workers, combined by worker 1
+        void master_finalize(std::true_type)
+        {
+            Integer modulus;
+            std::vector<Integer> residue;
+            _pCommunicator->recv(modulus, 1, MergeTag);
+            _pCommunicator->recv(residue, 1, MergeTag);
+            if (modulus > 1) Builder_.progress(modulus, residue);
+        }
+
+        void master_finalize(std::false_type) {}
     };
 }
 
@@ -2,7 +2,7 @@
  * Copyright (C) 1999-2010 The LinBox group
  *
  * Naive parallel chinese remaindering
- * Launch NN iterations in parallel, where NN=omp_get_max_threads()
+ * Launch NN iterations in parallel, where NN is the number of threads of TaskPool::current()
  * Then synchronization and termintation test.
  * Time-stamp: <13 Mar 12 13:49:58 Jean-Guillaume.Dumas@imag.fr>
  *
@@ -36,9 +36,9 @@
 #ifndef DISABLE_COMMENTATOR
 #define DISABLE_COMMENTATOR
 #endif
-#include <omp.h>
 #include <set>
 #include "linbox/algorithms/cra-domain-sequential.h"
+#include "linbox/util/task-pool.h"
 
 namespace LinBox
 {
@@ -62,16 +62,21 @@ namespace LinBox
 		ResultType& operator() (ResultType& res, Function& Iteration, PrimeIterator& primeiter)
 		{
 			using ResidueType = typename CRAResidue<ResultType,Function>::template ResidueType<Domain>;
-			size_t NN = omp_get_max_threads();
+			TaskPool& pool = TaskPool::current();
+			size_t NN = pool.numThreads();
 			//std::cerr << "Blocs: " << NN << " iterations." << std::endl;
 			// commentator().start ("Parallel OMP Givaro::Modular iteration", "mmcrait");
 			if (NN == 1) return Father_t::operator()(res,Iteration,primeiter);
+			LINBOX_TRACE_SPAN ("parallel cra");
 
 			std::vector<Domain> ROUNDdomains; ROUNDdomains.reserve(NN);
 			std::vector<ResidueType> ROUNDresidues; ROUNDresidues.reserve(NN);
 			std::vector<IterationResult> ROUNDresults(NN);
 			std::set<Integer> coprimeset;
 
+			typename CRABuilderIsCheckpointable<CRABase>::type checkpointable;
+			this->restoreCheckpoint(checkpointable);
+
 			while (! this->Builder_.terminated()) {
 				ROUNDdomains.clear();
 				ROUNDresidues.clear();
@@ -87,12 +92,12 @@ namespace LinBox
 					ROUNDdomains.emplace_back(*coprimesetiter);
 					ROUNDresidues.emplace_back(CRAResidue<ResultType,Function>::create(ROUNDdomains.back()));
 				}
+				LINBOX_TRACE_COUNT (Primes, NN);
 
-#pragma omp parallel for
-				for(size_t i=0;i<NN;++i) {
+				pool.parallelFor(0, NN, 1, [&](size_t i) {
+					LINBOX_TRACE_SPAN ("cra residue");
 					ROUNDresults[i] = Iteration(ROUNDresidues[i], ROUNDdomains[i]);
-				}
-#pragma omp barrier
+				});
 
 				// if any thread says RESTART, then all CONTINUEs become SKIPs
 				bool anyrestart = false;
@@ -122,7 +127,9 @@ namespace LinBox
 					}
 				}
 				//std::cerr << "Computed: " << iterCount() << " primes." << std::endl;
+				this->saveCheckpoint(false, checkpointable);
 			}
+			this->saveCheckpoint(true, checkpointable);
 
 			// commentator().stop ("done", NULL, "mmcrait");
 			//std::cerr << "Used: " << this->iterCount() << " primes." << std::endl;
@@ -34,13 +34,32 @@
 #include "linbox/integer.h"
 #include "linbox/solutions/methods.h"
 #include "linbox/vector/blas-vector.h"
+#include <type_traits>
 #include <utility>
 #include <stdlib.h>
+#include "linbox/util/checkpoint.h"
 #include "linbox/util/commentator.h"
+#include "linbox/util/tracer.h"
 
 namespace LinBox
 {
 
+	/** Whether the state of the builder can be saved to a Checkpoint,
+	 * i.e. it has serialize() and unserialize() members.
+	 */
+	template <class CRABase>
+	struct CRABuilderIsCheckpointable {
+		template <class B>
+		static auto test(int) -> decltype(std::declval<const B&>().serialize(std::declval<std::vector<uint8_t>&>()),
+						  std::declval<B&>().unserialize(std::declval<const std::vector<uint8_t>&>(), uint64_t(0)),
+						  std::true_type());
+		template <class B>
+		static std::false_type test(...);
+
+		using type = decltype(test<CRABase>(0));
+		static constexpr bool value = type::value;
+	};
+
         /// No doc.
         /// @ingroup CRA
 	template<class CRABase>
@@ -57,6 +76,8 @@ namespace LinBox
 		int ngood_ = 0;
 		int nbad_ = 0;
 		int nskip_ = 0;
+		int nrestored_ = 0; // primes used before the checkpoint we resumed from
+		Checkpoint* checkpoint_ = nullptr;
 
 		/** \brief Helper class to sample unique primes.
 		*/
@@ -77,7 +98,7 @@ namespace LinBox
 				while (outer_.Builder_.noncoprime(*primeiter_)) {
 					++primeiter_;
 					++coprime;
-					if (coprime > outer_.MAXNONCOPRIME) {
+					if (coprime > outer_.MAXNONCOPRIME + outer_.nrestored_) {
 						commentator().report(Commentator::LEVEL_ALWAYS,INTERNAL_ERROR) << "you are running out of primes. " << outer_.iterCount() << " used and " << coprime << " coprime primes tried for a new one.";
 						throw LinboxError("LinBox ERROR: ran out of primes in CRA\n");
 					}
@@ -101,9 +122,56 @@ namespace LinBox
 		 */
 		template <class PrimeIterator>
 		inline auto get_coprime(PrimeIterator& primeiter) const -> decltype(*primeiter) {
+			// After a restart, even unique samplers give again the primes used before the checkpoint.
+			if (nrestored_ > 0) return PrimeSampler<PrimeIterator, false>(*this, primeiter)();
 			return PrimeSampler<PrimeIterator>(*this, primeiter)();
 		}
 
+		/** \brief Resumes from the checkpoint, if any.
+		 */
+		void restoreCheckpoint(std::true_type)
+		{
+			std::vector<uint8_t> bytes;
+			if (checkpoint_ == nullptr || ngood_ > 0 || ! checkpoint_->load(bytes)) return;
+
+			int32_t ngood, nbad;
+			uint64_t offset = unserialize(ngood, bytes);
+			offset += unserialize(nbad, bytes, offset);
+			Builder_.unserialize(bytes, offset);
+			ngood_ = ngood;
+			nbad_ = nbad;
+			nrestored_ = ngood + nbad;
+			commentator().report(Commentator::LEVEL_IMPORTANT, INTERNAL_DESCRIPTION)
+				<< "Resuming from " << checkpoint_->path() << " after " << ngood_ << " primes" << std::endl;
+		}
+
+		void restoreCheckpoint(std::false_type) {}
+
+		/** \brief Saves the builder and the prime counters, if a checkpoint is due.
+		 */
+		void saveCheckpoint(bool force, std::true_type)
+		{
+			if (checkpoint_ == nullptr || ngood_ == 0 || ! (force || checkpoint_->due())) return;
+
+			std::vector<uint8_t> bytes;
+			serialize(bytes, static_cast<int32_t>(ngood_));
+			serialize(bytes, static_cast<int32_t>(nbad_));
+			Builder_.serialize(bytes);
+			checkpoint_->save(bytes);
+		}
+
+		void saveCheckpoint(bool, std::false_type) {}
+
+		/** \brief Counts the prime, and reports it only if the commentator prints it.
+		 */
+		template <class Prime>
+		void reportPrime(const Prime& p) const
+		{
+			LINBOX_TRACE_COUNT (Primes, 1);
+			if (commentator().isPrinted(Commentator::LEVEL_IMPORTANT, INTERNAL_DESCRIPTION))
+				commentator().report(Commentator::LEVEL_IMPORTANT, INTERNAL_DESCRIPTION) << "With prime " << p << std::endl;
+		}
+
 	public:
 		/** \brief Pass-through constructor to create the underlying builder.
 		 */
@@ -120,6 +188,20 @@ namespace LinBox
 			return ngood_ + nbad_;
 		}
 
+		/** \brief Saves the state of the loop to checkpoint every checkpoint->period() seconds.
+		 *
+		 * If the checkpoint file exists, the next call to the loop resumes from it:
+		 * the residues already combined are not computed again,
+		 * the primes they used are skipped.
+		 * The prime iterator must give the same primes as the interrupted run,
+		 * or at least primes coprime to them.
+		 */
+		void setCheckpoint(Checkpoint* checkpoint)
+		{
+			static_assert(CRABuilderIsCheckpointable<CRABase>::value, "This CRA builder cannot be checkpointed.");
+			checkpoint_ = checkpoint;
+		}
+
             /** \brief The \ref CRA loop
              *
              * Given a function to generate residues \c mod a single prime,
@@ -173,10 +255,14 @@ namespace LinBox
 		template<class ResultType, class Function, class PrimeIterator>
 		bool operator() (int k, ResultType& res, Function& Iteration, PrimeIterator& primeiter)
             {
+				LINBOX_TRACE_SPAN ("cra");
+				typename CRABuilderIsCheckpointable<CRABase>::type checkpointable;
+				restoreCheckpoint(checkpointable);
+
 				while (k != 0 && ngood_ == 0) {
 					--k;
 					Domain D(*primeiter);
-                    commentator().report(Commentator::LEVEL_IMPORTANT, INTERNAL_DESCRIPTION) << "With prime " << *primeiter << std::endl;
+					reportPrime(*primeiter);
 					++primeiter;
 					auto r = CRAResidue<ResultType,Function>::create(D);
 #ifdef _LB_CRATIMING
@@ -198,7 +284,7 @@ namespace LinBox
 				while (k != 0 && ! Builder_.terminated()) {
 					--k;
 					Domain D(get_coprime(primeiter));
-                    commentator().report(Commentator::LEVEL_IMPORTANT, INTERNAL_DESCRIPTION) << "With prime " << *primeiter << std::endl;
+					reportPrime(*primeiter);
 					++primeiter;
 					auto r = CRAResidue<ResultType,Function>::create(D);
 
@@ -217,8 +303,10 @@ namespace LinBox
 						Builder_.initialize(D, r);
 						break;
 					}
+					saveCheckpoint(false, checkpointable);
 				}
 
+				saveCheckpoint(true, checkpointable);
                 Builder_.result(res);
 				return ngood_ > 0 && Builder_.terminated();
             }
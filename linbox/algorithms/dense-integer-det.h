@@ -0,0 +1,261 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file algorithms/dense-integer-det.h
+ * @ingroup algorithms
+ * @brief Determinant of a dense integer matrix: batches of modular PLUQ determinants,
+ * with the last invariant factor computed meanwhile.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "linbox/algorithms/cra-builder-single.h"
+#include "linbox/algorithms/last-invariant-factor.h"
+#include "linbox/algorithms/rational-solver.h"
+#include "linbox/field/field-traits.h"
+#include "linbox/matrix/dense-matrix.h"
+#include "linbox/matrix/matrixdomain/blas-matrix-domain.h"
+#include "linbox/randiter/random-prime.h"
+#include "linbox/ring/modular.h"
+#include "linbox/util/commentator.h"
+#include "linbox/util/task-pool.h"
+#include "linbox/util/tracer.h"
+
+namespace LinBox {
+
+    /**
+     * \brief Determinants of an integer matrix A modulo several primes at once,
+     * one PLUQ factorization (FFPACK::Det) per prime, run in parallel on a TaskPool.
+     *
+     * When the entries of A fit in a double, A is converted once and each prime
+     * only reduces doubles; otherwise each prime reduces the integers of A.
+     */
+    template <class IMatrix>
+    class ModularDetBatch {
+    public:
+        typedef Givaro::ModularBalanced<double> Field;
+        typedef Field::Element Element;
+
+        ModularDetBatch(const IMatrix& A, TaskPool& pool)
+            : _A(A)
+            , _pool(pool)
+            , _n(A.rowdim())
+        {
+            // 2^52: exactly represented, and reduced exactly by Field::init
+            const integer bound(4503599627370496.0);
+            bool small = true;
+            for (size_t i = 0; small && i < _n; ++i)
+                for (size_t j = 0; small && j < _n; ++j) small = absCompare(A.getEntry(i, j), bound) < 0;
+            if (small) {
+                _entries.resize(_n * _n);
+                for (size_t i = 0; i < _n; ++i)
+                    for (size_t j = 0; j < _n; ++j) _entries[i * _n + j] = (double)A.getEntry(i, j);
+            }
+        }
+
+        /// residues[k] = det(A) mod primes[k].
+        void operator()(std::vector<Element>& residues, const std::vector<integer>& primes) const
+        {
+            residues.resize(primes.size());
+            _pool.parallelFor(0, primes.size(), 1, [&](size_t k) {
+                Field F(primes[k]);
+                BlasMatrix<Field> Ap(F, _n, _n);
+                for (size_t i = 0; i < _n; ++i)
+                    for (size_t j = 0; j < _n; ++j) {
+                        if (_entries.empty())
+                            F.init(Ap.refEntry(i, j), _A.getEntry(i, j));
+                        else
+                            F.init(Ap.refEntry(i, j), _entries[i * _n + j]);
+                    }
+                residues[k] = BlasMatrixDomain<Field>(F).detInPlace(Ap);
+            });
+        }
+
+    private:
+        const IMatrix& _A;
+        TaskPool& _pool;
+        size_t _n;
+        std::vector<double> _entries; //!< A row by row, empty if an entry does not fit.
+    };
+
+    /** \brief Determinant of a dense integer matrix.
+     *
+     * Chinese remaindering of determinants modulo primes, computed by batches of as many primes
+     * as Meth.taskPool() has threads, see ModularDetBatch.
+     * Once twice Meth.earlyTerminationThreshold primes did not suffice, the last invariant factor
+     * s of A, a large factor of det(A), is computed by a Dixon solve on a thread of its own, while the
+     * batches go on. When s is known, the remaindering starts again on det(A)/s, from the residues
+     * already computed: usually few more primes are needed.
+     * Either way, the result is the one of the early terminated remaindering (CRABuilderEarlySingle).
+     *
+     * The Dixon solve works on its own copy of A: if the remaindering terminates before s is known,
+     * it is abandoned rather than waited for. It is not a task of the pool, which the batches
+     * wait on: a waiting batch would run it, and a pool destroyed at the end of the call would join it.
+     *
+     * This is the strategy of lif_cra_det (algorithms/hybrid-det.h), with batches of primes
+     * and the Dixon solve overlapped with the remaindering.
+     *
+     * @bib
+     * - John Abbott, Manuel Bronstein and Thom Mulders, <i>Fast deterministic computation of
+     * determinants of dense matrices</i>. In ISSAC'99, pages 197--204.
+     * - Jean-Guillaume Dumas, Pascal Giorgi and Clement Pernet, <i>Dense Linear Algebra over
+     * Word-Size Prime Fields: the FFLAS and FFPACK Packages</i>. ACM Trans. Math. Softw. 35(3), 2008.
+     */
+    template <class Ring, class MyMethod>
+    typename Ring::Element& dense_integer_det(typename Ring::Element& d, const BlasMatrix<Ring>& A,
+                                              const MyMethod& Meth)
+    {
+        typedef ModularDetBatch<BlasMatrix<Ring>> Batch;
+        typedef typename Batch::Field Field;
+        typedef typename Ring::Element Integer_t;
+        typedef DixonSolver<Ring, Field, PrimeIterator<IteratorCategories::HeuristicTag>, Method::DenseElimination>
+            Solver;
+
+        if (A.coldim() != A.rowdim())
+            throw LinboxError("LinBox ERROR: matrix must be square for determinant computation\n");
+
+        LINBOX_TRACE_SPAN("dense integer det");
+        commentator().start("Dense integer determinant", "didet");
+
+        TaskPool& pool = Meth.taskPool();
+        const Batch dets(A, pool);
+        PrimeIterator<IteratorCategories::HeuristicTag> genprime(FieldTraits<Field>::bestBitSize(A.coldim()));
+        const size_t threshold = std::max<size_t>(Meth.earlyTerminationThreshold, 1);
+        const size_t batchSize = pool.numThreads();
+
+        // Every residue, for the restart on det(A)/s
+        std::vector<integer> primes, batch;
+        std::vector<typename Field::Element> residues, batchResidues;
+
+        // cra gets det(A)/beta mod p, for the primes p which do not divide beta
+        std::unique_ptr<CRABuilderEarlySingle<Field>> cra(new CRABuilderEarlySingle<Field>(threshold));
+        bool started = false;
+        auto terminated = [&]() { return started && cra->terminated(); };
+        Integer_t beta(1);
+        auto progress = [&](const integer& p, typename Field::Element r) {
+            Field F(p);
+            typename Field::Element b;
+            F.init(b, beta);
+            if (F.isZero(b)) return;
+            F.divin(r, b);
+            if (started)
+                cra->progress(F, r);
+            else
+                cra->initialize(F, r);
+            started = true;
+        };
+
+        auto nextBatch = [&]() {
+            batch.clear();
+            while (batch.size() < batchSize) {
+                ++genprime;
+                if (std::find(primes.begin(), primes.end(), *genprime) == primes.end()
+                    && std::find(batch.begin(), batch.end(), *genprime) == batch.end())
+                    batch.push_back(*genprime);
+            }
+            dets(batchResidues, batch);
+            LINBOX_TRACE_COUNT(Primes, batch.size());
+            for (size_t k = 0; k < batch.size() && !terminated(); ++k) {
+                primes.push_back(batch[k]);
+                residues.push_back(batchResidues[k]);
+                progress(batch[k], batchResidues[k]);
+            }
+        };
+
+        // Small determinants terminate within about threshold primes, the Dixon solve would be wasted.
+        while (primes.size() < 2 * threshold && !terminated()) nextBatch();
+
+        if (!terminated()) {
+            commentator().report(Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
+                << "no early termination after " << primes.size() << " primes, last invariant factor" << std::endl;
+
+            // The thread may outlive this call: it owns A and its ring.
+            struct LifInput {
+                Ring R;
+                BlasMatrix<Ring> A;
+                std::promise<Integer_t> lif;
+
+                LifInput(const BlasMatrix<Ring>& A0)
+                    : R(A0.field())
+                    , A(R, A0.rowdim(), A0.coldim())
+                {
+                    for (size_t i = 0; i < A.rowdim(); ++i)
+                        for (size_t j = 0; j < A.coldim(); ++j) A.setEntry(i, j, A0.getEntry(i, j));
+                }
+            };
+            std::shared_ptr<LifInput> input = std::make_shared<LifInput>(A);
+            std::future<Integer_t> lifFuture = input->lif.get_future();
+
+            // No commentator in the loop below: the solve reports on another thread.
+            std::thread([input]() {
+                try {
+                    Integer_t lif(0);
+                    BlasVector<Ring> num(input->R, input->A.coldim());
+                    LastInvariantFactor<Ring, Solver> LIF((Solver()));
+                    LIF.lastInvariantFactor1(lif, num, input->A);
+                    input->lif.set_value(lif);
+                } catch (...) {
+                    input->lif.set_exception(std::current_exception());
+                }
+            }).detach();
+            bool lifKnown = false;
+
+            while (!terminated()) {
+                if (!lifKnown && lifFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                    lifKnown = true;
+                    // Zero if the solve failed, A is singular or the prime was bad: det(A) as it is.
+                    const Integer_t lif = lifFuture.get();
+                    if (lif > 1) {
+                        beta = lif;
+                        cra.reset(new CRABuilderEarlySingle<Field>(threshold));
+                        started = false;
+                        for (size_t k = 0; k < primes.size() && !terminated(); ++k) progress(primes[k], residues[k]);
+                        if (terminated()) break;
+                    }
+                }
+                nextBatch();
+            }
+        }
+
+        Integer_t k;
+        cra->result(k);
+        A.field().mul(d, k, beta);
+        commentator().report(Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
+            << primes.size() << " primes, factor of size " << beta.bitsize() << " bits" << std::endl;
+        commentator().stop("done", NULL, "didet");
+        return d;
+    }
+}
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
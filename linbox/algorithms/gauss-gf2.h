@@ -70,6 +70,10 @@ namespace LinBox
 		*/
 		const Field &field () const { return *(new GF2()); }
 
+		/// Over GF2, the strategies other than None are all Linear: no pivot search.
+		size_t pivotSearch () const { return 1; }
+		void setPivotSearch (size_t) {}
+
 		/** @name rank
 		  Callers of the different rank routines
 		  @li  The "in" suffix indicates in place computation
@@ -177,6 +181,15 @@ namespace LinBox
 				 SparseSeqMatrix        &A,
 				 const Vector2& b, Random& generator) const;
 
+		/// The pivoting strategy is not used over GF2.
+		template <class SparseSeqMatrix, class Vector1, class Vector2>
+		Vector1& solveInPlace(Vector1& x,
+				 SparseSeqMatrix        &A,
+				 const Vector2& b, PivotStrategy) const
+		{
+			return solveInPlace(x, A, b);
+		}
+
 
 		template <class SparseSeqMatrix, class Perm>
 		size_t& InPlaceLinearPivoting(size_t &Rank,
@@ -44,6 +44,9 @@
 
 #include "linbox/util/debug.h"
 #include "linbox/util/commentator.h"
+#include "linbox/util/tracer.h"
+#include "linbox/algorithms/gauss/gauss-arena.h"
+#include "linbox/algorithms/gauss/gauss-ordering.h"
 #include "linbox/field/archetype.h"
 #include "linbox/field/gf2.h"
 #include "linbox/matrix/sparse-matrix.h"
@@ -64,18 +67,28 @@ namespace LinBox
 	  Several versions allow for adjustment of the pivoting strategy
 	  and for choosing in-place elimination or for not modifying the input matrix.
 	  Also an LU interface is offered.
+
+	  With _RowStorage = GaussRowStorage::Arena, the elimination of InPlaceLinearPivoting
+	  without permutation (rank and determinant with PivotStrategy::Linear) moves the rows
+	  to the SparseRowArena of the thread: no allocation per row or per elimination step.
+	  The other eliminations work on the rows of the matrix in both cases.
+
+	  Rank, determinant and solve also take the PivotStrategy values Markowitz,
+	  ColumnOrdering and Singletons, see OrderedPivoting.
 	  */
-	template <class _Field>
+	template <class _Field, class _RowStorage = GaussRowStorage::Vector>
 	class GaussDomain {
 	public:
 		typedef _Field Field;
 		typedef typename Field::Element Element;
+		typedef _RowStorage RowStorage;
 
 		// Preferred Matrix type
 		using Matrix=SparseMatrix<Field, SparseMatrixFormat::SparseSeq>;
 
 	private:
 		const Field         *_field;
+		size_t               _pivotSearch;
 
 	public:
 
@@ -83,19 +96,23 @@ namespace LinBox
 		 * over which to perform computations
 		 */
 		GaussDomain (const Field &F) :
-			_field (&F)
+			_field (&F), _pivotSearch (4)
 		{}
 
 		//Copy constructor
 		///
 		GaussDomain (const GaussDomain &Mat) :
-			_field (Mat._field)
+			_field (Mat._field), _pivotSearch (Mat._pivotSearch)
 		{}
 
 		/** accessor for the field of computation
 		*/
 		const Field &field () const { return *_field; }
 
+		/// Number of columns and rows examined for a pivot by PivotStrategy::Markowitz (at least 1).
+		size_t pivotSearch () const { return _pivotSearch; }
+		void setPivotSearch (size_t n) { _pivotSearch = std::max (n, (size_t)1); }
+
 		/** @name rank
 		  Callers of the different rank routines\\
 		  -/ The "in" suffix indicates in place computation\\
@@ -208,6 +225,16 @@ namespace LinBox
 				 _Matrix         &A,
 				 const Vector2	&b, Random& generator)  const;
 
+		/** Solve with the elimination of OrderedPivoting for the strategies
+		 * Markowitz, ColumnOrdering and Singletons; the free variables are zero.
+		 * Linear and None use the QLUP factorization, as above.
+		 * @throws LinboxMathInconsistentSystem if Ax = b has no solution.
+		 */
+		template <class _Matrix, class Vector1, class Vector2>
+		Vector1& solveInPlace(Vector1	&x,
+				 _Matrix         &A,
+				 const Vector2	&b, PivotStrategy reord)  const;
+
 
 		template <class _Matrix, class Perm, class Block>
 		Block& nullspacebasis(Block& x,
@@ -243,6 +270,30 @@ namespace LinBox
 						     size_t Nj) const;
 
 
+		/** \brief Sparse in place Gaussian elimination, pivots chosen by a PivotStrategy
+		 * among the active rows and columns kept in CountBuckets by number of entries.
+		 *
+		 * - Markowitz: smallest (r-1)(c-1) among the entries of the pivotSearch() sparsest
+		 *   columns and rows, r and c being the numbers of entries of the row and the column.
+		 * - ColumnOrdering: columns in the order of approximateMinimumDegreeOrdering,
+		 *   sparsest row in each.
+		 * - Singletons: columns with one entry first, then the sparsest row
+		 *   and the sparsest column in it, as Linear.
+		 *
+		 * The pivots (row, column) are returned in order. The rows are erased,
+		 * except when rhs is given: then the pivot rows stay, for a back substitution,
+		 * and the right hand side rhs follows the elimination.
+		 */
+		template <class _Matrix>
+		size_t& OrderedPivoting(size_t &rank,
+					Element& determinant,
+					_Matrix        &A,
+					size_t Ni,
+					size_t Nj,
+					PivotStrategy reord,
+					std::vector<std::pair<size_t, size_t> > &pivots,
+					std::vector<Element> *rhs = nullptr) const;
+
 		/** \brief Sparse Gaussian elimination without reordering.
 
 		  Gaussian elimination is done on a copy of the matrix.
@@ -276,6 +327,24 @@ Using : FindPivot and LU
 
 	protected:
 
+		typedef SparseRowArena<Element> Arena;
+
+		// InPlaceLinearPivoting on the rows of the SparseRowArena of the thread,
+		// with arenaFindPivot and arenaEliminate, the SoA versions of
+		// SparseFindPivot and eliminate with column densities
+		template <class _Matrix>
+		size_t& ArenaLinearPivoting(size_t &rank,
+					    Element& determinant,
+					    _Matrix        &A,
+					    size_t Ni,
+					    size_t Nj) const;
+
+		void arenaFindPivot (Arena &rows, size_t k, size_t &indcol, long &indpermut,
+				     std::vector<size_t> &columns, Element& determinant) const;
+
+		void arenaEliminate (Arena &rows, size_t l, size_t piv, size_t indcol, long indpermut,
+				     std::vector<size_t> &columns) const;
+
 		//-----------------------------------------
 		// Sparse elimination using a pivot row :
 		// lc <-- lc - lc[k]/lp[0] * lp
@@ -395,6 +464,8 @@ Using : FindPivot and LU
 #include "linbox/algorithms/gauss/gauss-nullspace.inl"
 #include "linbox/algorithms/gauss/gauss-rank.inl"
 #include "linbox/algorithms/gauss/gauss-det.inl"
+#include "linbox/algorithms/gauss/gauss-arena.inl"
+#include "linbox/algorithms/gauss/gauss-ordering.inl"
 
 #endif // __LINBOX_gauss_H
 
@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file algorithms/gauss/gauss-arena.h
+ * @ingroup algorithms
+ * @brief Sparse rows stored in one arena, for the sparse eliminations of GaussDomain.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "linbox/util/debug.h"
+
+namespace LinBox {
+
+    /// Where GaussDomain keeps the rows during a sparse elimination.
+    namespace GaussRowStorage {
+        /// In the rows of the matrix, each one a std::vector of (index, value) pairs.
+        struct Vector {};
+        /// In a SparseRowArena of the calling thread, with the indices and values in separate arrays.
+        struct Arena {};
+    }
+
+    /**
+     * \brief Sparse rows of one elimination, all kept in two arrays: column indices and values.
+     *
+     * Each row is a slice [start, start + capacity) of both arrays, of which the first size
+     * entries are used. A row gets some headroom when it is stored, so that it can grow
+     * a little in place. A row which outgrows its slice moves to the end of the arrays,
+     * leaving a hole; once the holes make up half of the arrays, compact() moves
+     * the rows down over them. Rows are swapped or released without copying their entries.
+     * No memory is allocated per row: the arrays only grow geometrically,
+     * and keep their capacity from one elimination to the next.
+     *
+     * One arena per thread and element type is given by local().
+     */
+    template <class _Element, class _Index = uint32_t>
+    class SparseRowArena {
+    public:
+        typedef _Element Element;
+        typedef _Index Index;
+
+        /// The arena of the calling thread.
+        static SparseRowArena& local()
+        {
+            static thread_local SparseRowArena arena;
+            return arena;
+        }
+
+        /// rowdim empty rows; the storage of the previous rows is reused.
+        void reset(size_t rowdim)
+        {
+            _rows.assign(rowdim, Row());
+            _index.clear();
+            _value.clear();
+            _garbage = 0;
+        }
+
+        /// Frees all the storage.
+        void release()
+        {
+            std::vector<Row>().swap(_rows);
+            std::vector<Index>().swap(_index);
+            std::vector<Element>().swap(_value);
+            _garbage = 0;
+        }
+
+        size_t rowdim() const { return _rows.size(); }
+        size_t size(size_t i) const { return _rows[i].size; }
+        size_t capacity(size_t i) const { return _rows[i].capacity; }
+
+        /// Slots of the arrays in use, holes included.
+        size_t storage() const { return _index.size(); }
+
+        Index* index(size_t i) { return _index.data() + _rows[i].start; }
+        const Index* index(size_t i) const { return _index.data() + _rows[i].start; }
+        Element* value(size_t i) { return _value.data() + _rows[i].start; }
+        const Element* value(size_t i) const { return _value.data() + _rows[i].start; }
+
+        /// Row i = the (index, value) pairs of v, sorted by index.
+        template <class Vector>
+        void assign(size_t i, const Vector& v)
+        {
+            reserve(i, v.size());
+            Index* I = index(i);
+            Element* V = value(i);
+            size_t j = 0;
+            for (const auto& e : v) {
+                I[j] = (Index)e.first;
+                V[j] = e.second;
+                ++j;
+            }
+            _rows[i].size = j;
+        }
+
+        /// Makes room for n entries in row i, keeping its entries.
+        /// Pointers to the entries of any row are invalidated.
+        void reserve(size_t i, size_t n)
+        {
+            if (n <= _rows[i].capacity) return;
+            if (2 * _garbage > _index.size()) {
+                compact();
+                if (n <= _rows[i].capacity) return;
+            }
+
+            Row& r = _rows[i];
+            const size_t capacity = headroom(n);
+            if (r.capacity > 0 && r.start + r.capacity == _index.size()) {
+                // Last row of the arrays: it grows in place.
+                grow(capacity - r.capacity);
+                r.capacity = capacity;
+                return;
+            }
+
+            const size_t start = _index.size();
+            grow(capacity);
+            std::copy(_index.begin() + r.start, _index.begin() + r.start + r.size, _index.begin() + start);
+            std::copy(_value.begin() + r.start, _value.begin() + r.start + r.size, _value.begin() + start);
+            _garbage += r.capacity;
+            r.start = start;
+            r.capacity = capacity;
+        }
+
+        /// Sets the number of entries of row i, at most its capacity.
+        void resize(size_t i, size_t n)
+        {
+            linbox_check(n <= _rows[i].capacity);
+            _rows[i].size = n;
+        }
+
+        /// Exchanges rows i and j.
+        void swap(size_t i, size_t j) { std::swap(_rows[i], _rows[j]); }
+
+        /// Empties row i and gives its storage back to the next compaction.
+        void release(size_t i)
+        {
+            _garbage += _rows[i].capacity;
+            _rows[i] = Row();
+        }
+
+        /// Moves the rows down over the holes, in place, in the order of their storage.
+        void compact()
+        {
+            std::vector<size_t> order;
+            order.reserve(_rows.size());
+            for (size_t i = 0; i < _rows.size(); ++i)
+                if (_rows[i].capacity > 0) order.push_back(i);
+            std::sort(order.begin(), order.end(),
+                      [this](size_t a, size_t b) { return _rows[a].start < _rows[b].start; });
+
+            size_t end = 0;
+            for (size_t i : order) {
+                Row& r = _rows[i];
+                // Never more than the old slice, so that a row does not overwrite the next one.
+                const size_t capacity = std::min(r.capacity, headroom(r.size));
+                if (r.start != end) {
+                    std::copy(_index.begin() + r.start, _index.begin() + r.start + r.size, _index.begin() + end);
+                    std::copy(_value.begin() + r.start, _value.begin() + r.start + r.size, _value.begin() + end);
+                    r.start = end;
+                }
+                r.capacity = capacity;
+                end += capacity;
+            }
+            _index.resize(end);
+            _value.resize(end);
+            _garbage = 0;
+        }
+
+        /// Scratch arrays of n entries, for the result of a merge.
+        void scratch(Index*& index, Element*& value, size_t n)
+        {
+            if (_scratchIndex.size() < n) {
+                _scratchIndex.resize(n);
+                _scratchValue.resize(n);
+            }
+            index = _scratchIndex.data();
+            value = _scratchValue.data();
+        }
+
+    private:
+        struct Row {
+            size_t start = 0, size = 0, capacity = 0;
+        };
+
+        /// Capacity given to a row of n entries.
+        static size_t headroom(size_t n) { return n + n / 4 + 4; }
+
+        void grow(size_t n)
+        {
+            _index.resize(_index.size() + n);
+            _value.resize(_value.size() + n);
+        }
+
+        std::vector<Row> _rows;
+        std::vector<Index> _index;
+        std::vector<Element> _value;
+        size_t _garbage = 0; //!< Slots of the arrays not used by any row.
+        std::vector<Index> _scratchIndex;
+        std::vector<Element> _scratchValue;
+    };
+}
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
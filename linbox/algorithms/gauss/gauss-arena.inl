@@ -0,0 +1,289 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file algorithms/gauss/gauss-arena.inl
+ * @ingroup algorithms
+ * @brief InPlaceLinearPivoting on the rows of a SparseRowArena (GaussRowStorage::Arena).
+ *
+ * Same pivoting, permutations and determinant sign as the vector rows version
+ * of gauss.inl, gauss-pivot.inl and gauss-elim.inl.
+ */
+
+#pragma once
+
+namespace LinBox {
+
+    template <class _Field, class _RowStorage>
+    template <class _Matrix>
+    inline size_t& GaussDomain<_Field, _RowStorage>::ArenaLinearPivoting(size_t& Rank, Element& determinant,
+                                                                         _Matrix& LigneA, size_t Ni, size_t Nj) const
+    {
+        typedef typename _Matrix::Row Vector;
+
+        LINBOX_TRACE_SPAN("gauss IPLR arena");
+        commentator().start("IPLR Gaussian elimination with reordering, arena rows", "IPLR", Ni);
+        field().write(commentator().report(Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
+                      << "Gaussian elimination on " << Ni << " x " << Nj << " matrix, over: ")
+            << std::endl;
+
+        // The rows move to the arena; as for vector rows, the matrix is emptied.
+        Arena& rows = Arena::local();
+        rows.reset(Ni);
+        std::vector<size_t> col_density(Nj);
+        Vector Vzer(0);
+        for (size_t i = 0; i < Ni; ++i) {
+            rows.assign(i, LigneA[i]);
+            for (size_t k = 0; k < LigneA[i].size(); ++k) ++col_density[LigneA[i][k].first];
+            LigneA[i] = Vzer;
+        }
+
+        field().assign(determinant, field().one);
+        Rank = 0;
+        const long last = (long)Ni - 1;
+        long c;
+
+#ifdef __LINBOX_OFTEN__
+        long sstep = last / 40;
+        if (sstep > __LINBOX_OFTEN__) sstep = __LINBOX_OFTEN__;
+        if (sstep <= 0) sstep = 1;
+#else
+        long sstep = 1000;
+#endif
+        for (long k = 0; k < last; ++k) {
+            if (!(k % sstep)) commentator().progress(k);
+
+            size_t p = (size_t)k, s = rows.size((size_t)k);
+            if (s) {
+                // Row permutation for the sparsest row
+                for (size_t l = (size_t)k + 1; l < Ni; ++l) {
+                    const size_t sl = rows.size(l);
+                    if (sl < s && sl) {
+                        s = sl;
+                        p = l;
+                    }
+                }
+                if (p != (size_t)k) {
+                    field().negin(determinant);
+                    rows.swap((size_t)k, p);
+                }
+
+                arenaFindPivot(rows, (size_t)k, Rank, c, col_density, determinant);
+                if (c != -1) {
+                    for (size_t l = (size_t)k + 1; l < Ni; ++l) arenaEliminate(rows, l, (size_t)k, Rank, c, col_density);
+                }
+                rows.release((size_t)k);
+            }
+        }
+
+        if (Ni > 0) {
+            // Last row: no reordering
+            const size_t l = (size_t)last;
+            if (rows.size(l) > 0) {
+                field().mulin(determinant, rows.value(l)[0]);
+                if ((size_t)rows.index(l)[0] != Rank) field().negin(determinant);
+                ++Rank;
+            }
+        }
+        rows.reset(0);
+
+        if ((Rank < Ni) || (Rank < Nj) || (Ni == 0) || (Nj == 0)) field().assign(determinant, field().zero);
+
+        integer card;
+        field().write(commentator().report(Commentator::LEVEL_NORMAL, PARTIAL_RESULT) << "Determinant : ", determinant)
+            << " over GF (" << field().cardinality(card) << ")" << std::endl;
+        commentator().report(Commentator::LEVEL_NORMAL, PARTIAL_RESULT)
+            << "Rank : " << Rank << " over GF (" << card << ")" << std::endl;
+        commentator().stop("done", 0, "IPLR");
+        return Rank;
+    }
+
+    // As SparseFindPivot with column densities: pivot of row k in its sparsest column,
+    // moved to the front with column index indcol.
+    template <class _Field, class _RowStorage>
+    inline void GaussDomain<_Field, _RowStorage>::arenaFindPivot(Arena& rows, size_t k, size_t& indcol, long& indpermut,
+                                                                 std::vector<size_t>& columns,
+                                                                 Element& determinant) const
+    {
+        const size_t nj = rows.size(k);
+        if (nj == 0) {
+            indpermut = -1;
+            return;
+        }
+
+        typename Arena::Index* I = rows.index(k);
+        Element* V = rows.value(k);
+        bool pivoting = false;
+        indpermut = (long)I[0];
+
+        long ds = (long)--columns[I[0]];
+        size_t p = 0;
+        for (size_t j = 1; j < nj; ++j) {
+            const long dl = (long)--columns[I[j]];
+            if (dl < ds) {
+                ds = dl;
+                p = j;
+            }
+        }
+
+        if (p != 0) {
+            pivoting = true;
+            if (indpermut == (long)indcol) {
+                indpermut = (long)I[p];
+                std::swap(V[p], V[0]);
+            }
+            else {
+                const typename Arena::Index ti = I[p];
+                Element tv = V[p];
+                indpermut = (long)ti;
+                std::copy_backward(I, I + p, I + p + 1);
+                std::copy_backward(V, V + p, V + p + 1);
+                I[0] = ti;
+                V[0] = tv;
+            }
+        }
+
+        field().mulin(determinant, V[0]);
+        if (indpermut != (long)indcol) {
+            I[0] = (typename Arena::Index)indcol;
+            pivoting = true;
+        }
+        if (pivoting) field().negin(determinant);
+        ++indcol;
+    }
+
+    // As eliminate with column densities: row l -= row l[indcol-1] / pivot * row piv,
+    // after the exchange of columns indcol-1 and indpermut.
+    template <class _Field, class _RowStorage>
+    inline void GaussDomain<_Field, _RowStorage>::arenaEliminate(Arena& rows, size_t l, size_t piv, size_t indcol,
+                                                                 long indpermut, std::vector<size_t>& columns) const
+    {
+        typedef typename Arena::Index Index;
+
+        const size_t nj = rows.size(l);
+        if (nj == 0) return;
+
+        const size_t k = indcol - 1;
+        const Index kIndex = (Index)k, permIndex = (Index)indpermut;
+        Index* I = rows.index(l);
+        Element* V = rows.value(l);
+        size_t j_head = (size_t)(std::lower_bound(I, I + nj, permIndex) - I);
+
+        if (j_head < nj && I[j_head] == permIndex) {
+            // Permutation
+            if (indpermut != (long)k) {
+                if (I[0] == kIndex) {
+                    // non zero <--> non zero
+                    std::swap(V[0], V[j_head]);
+                }
+                else {
+                    // zero <--> non zero
+                    Element tv = V[j_head];
+                    --columns[permIndex];
+                    ++columns[k];
+                    std::copy_backward(I, I + j_head, I + j_head + 1);
+                    std::copy_backward(V, V + j_head, V + j_head + 1);
+                    I[0] = kIndex;
+                    V[0] = tv;
+                }
+                j_head = 0;
+            }
+
+            // Elimination, merged into the scratch arrays
+            const size_t npiv = rows.size(piv);
+            const Index* PI = rows.index(piv);
+            const Element* PV = rows.value(piv);
+            Index* OI;
+            Element* OV;
+            rows.scratch(OI, OV, nj + npiv);
+
+            Element headcoeff;
+            field().divin(field().neg(headcoeff, V[j_head]), PV[0]);
+            --columns[I[j_head]];
+
+            size_t j = 0, m = j_head + 1, q = 0;
+            std::copy(I, I + j_head, OI);
+            std::copy(V, V + j_head, OV);
+            j = j_head;
+            while (q < npiv && PI[q] <= kIndex) ++q;
+
+            Element tmp;
+            for (; q < npiv; ++q) {
+                const Index jp = PI[q];
+                // Run of entries with no pivot entry under them
+                size_t e = m;
+                while (e < nj && I[e] < jp) ++e;
+                std::copy(I + m, I + e, OI + j);
+                std::copy(V + m, V + e, OV + j);
+                j += e - m;
+                m = e;
+
+                if (m < nj && I[m] == jp) {
+                    field().axpy(tmp, headcoeff, PV[q], V[m]);
+                    if (!field().isZero(tmp)) {
+                        OI[j] = jp;
+                        OV[j++] = tmp;
+                    }
+                    else
+                        --columns[jp];
+                    ++m;
+                }
+                else {
+                    ++columns[jp];
+                    OI[j] = jp;
+                    field().mul(OV[j++], headcoeff, PV[q]);
+                }
+            }
+            std::copy(I + m, I + nj, OI + j);
+            std::copy(V + m, V + nj, OV + j);
+            j += nj - m;
+
+            if (j > nj) LINBOX_TRACE_COUNT(FillIn, j - nj);
+            // May move the rows, I and V are not valid anymore.
+            rows.reserve(l, j);
+            std::copy(OI, OI + j, rows.index(l));
+            std::copy(OV, OV + j, rows.value(l));
+            rows.resize(l, j);
+        }
+        else if (indpermut != (long)k) {
+            // Nothing under the pivot, permutation only: column k of the row goes to indpermut
+            const size_t f = (size_t)(std::lower_bound(I, I + nj, kIndex) - I);
+            if (f < j_head && I[f] == kIndex) {
+                // non zero <--> zero
+                Element tv = V[f];
+                --columns[k];
+                ++columns[permIndex];
+                std::copy(I + f + 1, I + j_head, I + f);
+                std::copy(V + f + 1, V + j_head, V + f);
+                I[j_head - 1] = permIndex;
+                V[j_head - 1] = tv;
+            } // else zero <--> zero
+        }
+    }
+}
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -30,9 +30,9 @@
 
 namespace LinBox
 {
-	template <class _Field>
-	template <class _Matrix> inline typename GaussDomain<_Field>::Element&
-	GaussDomain<_Field>::detInPlace(Element        &determinant,
+	template <class _Field, class _RowStorage>
+	template <class _Matrix> inline typename GaussDomain<_Field, _RowStorage>::Element&
+	GaussDomain<_Field, _RowStorage>::detInPlace(Element        &determinant,
 				   _Matrix        &A,
 				   size_t  Ni,
 				   size_t  Nj,
@@ -41,15 +41,19 @@ namespace LinBox
 		size_t Rank;
 		if (reord == PivotStrategy::None)
 			NoReordering(Rank, determinant, A,  Ni, Nj);
-		else
+		else if (reord == PivotStrategy::Linear)
 			InPlaceLinearPivoting(Rank, determinant, A, Ni, Nj);
+		else {
+			std::vector<std::pair<size_t, size_t> > pivots;
+			OrderedPivoting(Rank, determinant, A, Ni, Nj, reord, pivots);
+		}
 		return determinant;
 	}
 
 
-	template <class _Field>
-	template <class _Matrix> inline typename GaussDomain<_Field>::Element&
-	GaussDomain<_Field>::detInPlace(Element &determinant,
+	template <class _Field, class _RowStorage>
+	template <class _Matrix> inline typename GaussDomain<_Field, _RowStorage>::Element&
+	GaussDomain<_Field, _RowStorage>::detInPlace(Element &determinant,
 				   _Matrix  &A,
 				   PivotStrategy   reord)  const
 	{
@@ -58,18 +62,18 @@ namespace LinBox
 
 
 
-	template <class _Field>
-	template <class _Matrix> inline typename GaussDomain<_Field>::Element&
-	GaussDomain<_Field>::det(Element        &determinant,
+	template <class _Field, class _RowStorage>
+	template <class _Matrix> inline typename GaussDomain<_Field, _RowStorage>::Element&
+	GaussDomain<_Field, _RowStorage>::det(Element        &determinant,
 				 const _Matrix   &A,
 				 PivotStrategy   reord)  const
 	{
 		return det(determinant, A,  A.rowdim (), A.coldim (), reord);
 	}
 
-	template <class _Field>
-	template <class _Matrix> inline typename GaussDomain<_Field>::Element&
-	GaussDomain<_Field>::det(Element       &determinant,
+	template <class _Field, class _RowStorage>
+	template <class _Matrix> inline typename GaussDomain<_Field, _RowStorage>::Element&
+	GaussDomain<_Field, _RowStorage>::det(Element       &determinant,
 				 const _Matrix  &A,
 				 size_t  Ni,
 				 size_t  Nj,
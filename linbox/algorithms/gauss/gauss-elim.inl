@@ -30,9 +30,9 @@
 
 namespace LinBox
 {
-	template <class _Field>
+	template <class _Field, class _RowStorage>
 	template <class Vector> inline void
-	GaussDomain<_Field>::permute (Vector              &lignecourante,
+	GaussDomain<_Field, _RowStorage>::permute (Vector              &lignecourante,
 				      const size_t &indcol,
 				      const long &indpermut) const
 	{
@@ -117,9 +117,9 @@ namespace LinBox
 
 
 
-	template <class _Field>
+	template <class _Field, class _RowStorage>
 	template <class Vector, class D> inline void
-	GaussDomain<_Field>::eliminate (Vector              &lignecourante,
+	GaussDomain<_Field, _RowStorage>::eliminate (Vector              &lignecourante,
 					const Vector        &lignepivot,
 					const size_t &indcol,
 					const long &indpermut,
@@ -252,6 +252,7 @@ namespace LinBox
 					while (m<nj)
 						construit[j++] = lignecourante[m++];
 
+					if (j > nj) LINBOX_TRACE_COUNT (FillIn, j - nj);
 					construit.resize (j);
 					lignecourante = construit;
 				}
@@ -347,9 +348,9 @@ namespace LinBox
 	}
 
 
-	template <class _Field>
+	template <class _Field, class _RowStorage>
 	template <class Vector, class D> inline void
-	GaussDomain<_Field>::eliminate (Element             &headpivot,
+	GaussDomain<_Field, _RowStorage>::eliminate (Element             &headpivot,
 					Vector              &lignecourante,
 					const Vector        &lignepivot,
 					const size_t indcol,
@@ -486,6 +487,7 @@ namespace LinBox
 					while (m<nj)
 						construit[j++] = lignecourante[m++];
 
+					if (j > nj) LINBOX_TRACE_COUNT (FillIn, j - nj);
 					construit.resize (j);
 					lignecourante = construit;
 				}
@@ -581,9 +583,9 @@ namespace LinBox
 
 
 
-	template <class _Field>
+	template <class _Field, class _RowStorage>
 	template <class Vector> inline void
-	GaussDomain<_Field>::eliminate (Vector              &lignecourante,
+	GaussDomain<_Field, _RowStorage>::eliminate (Vector              &lignecourante,
 					const Vector        &lignepivot,
 					const size_t &indcol,
 					const long &indpermut) const
@@ -685,6 +687,7 @@ namespace LinBox
 					while (m < nj)
 						construit[j++] = lignecourante[m++];
 
+					if (j > nj) LINBOX_TRACE_COUNT (FillIn, j - nj);
 					construit.resize (j);
 					lignecourante = construit;
 				}
@@ -756,9 +759,9 @@ namespace LinBox
 #endif // __LINBOX_gauss_elim_INL
 
 #if 0
-template <class _Field>
+template <class _Field, class _RowStorage>
 template <class Vector>
-void GaussDomain<_Field>::permute (Vector              &lignecourante,
+void GaussDomain<_Field, _RowStorage>::permute (Vector              &lignecourante,
 				   const size_t &indcol,
 				   const long &indpermut)
 {
@@ -59,6 +59,7 @@ namespace LinBox
 		// In place (LigneA is modified)
 		// With reordering (D is a density type. Density is allocated here)
 		//    long Ni = LigneA.n_row (), Nj = LigneA.n_col ();
+		LINBOX_TRACE_SPAN ("gauss GF2");
 		commentator().start ("Gaussian elimination with reordering over GF2",
 				   "IPLRGF2", Ni);
 		commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
@@ -227,6 +228,7 @@ namespace LinBox
 		// In place (LigneA is modified)
 		// With reordering (D is a density type. Density is allocated here)
 		//    long Ni = LigneA.n_row (), Nj = LigneA.n_col ();
+		LINBOX_TRACE_SPAN ("gauss GF2");
 		commentator().start ("Gaussian elimination with reordering over GF2",
 				   "IPLRGF2", Ni);
 		commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
@@ -40,9 +40,9 @@ namespace LinBox
 
 
 	// U is supposed full Rank upper triangular
-	template <class _Field>
+	template <class _Field, class _RowStorage>
 	template <class _Matrix, class Perm, class Block> inline Block&
-	GaussDomain<_Field>::nullspacebasis(Block& x, size_t Rank, const _Matrix& U, const Perm& P)  const
+	GaussDomain<_Field, _RowStorage>::nullspacebasis(Block& x, size_t Rank, const _Matrix& U, const Perm& P)  const
 	{
 		if (Rank == 0) {
 			for(size_t i=0; i<U.coldim(); ++i)
@@ -94,9 +94,9 @@ namespace LinBox
 	}
 
 	// _Matrix A is upper triangularized
-	template <class _Field>
+	template <class _Field, class _RowStorage>
 	template <class _Matrix, class Block> inline Block&
-	GaussDomain<_Field>::nullspacebasisin(Block& x, _Matrix& A)  const
+	GaussDomain<_Field, _RowStorage>::nullspacebasisin(Block& x, _Matrix& A)  const
 	{
 		typename Field::Element Det;
 		size_t Rank;
@@ -128,9 +128,9 @@ namespace LinBox
 		return this->nullspacebasis(x, Rank, A, P);
 	}
 
-	template <class _Field>
+	template <class _Field, class _RowStorage>
 	template <class _Matrix, class Block> inline Block&
-	GaussDomain<_Field>::nullspacebasis(Block& x, const _Matrix& A)  const
+	GaussDomain<_Field, _RowStorage>::nullspacebasis(Block& x, const _Matrix& A)  const
 	{
 		Matrix A1 (A); // Must copy, then best to copy to preferred
 		return this->nullspacebasisin(x, A1);
@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file algorithms/gauss/gauss-ordering.h
+ * @ingroup algorithms
+ * @brief Priority queues of rows and columns by number of entries,
+ * and a column ordering by approximate minimum degree, for the pivoting strategies of GaussDomain
+ * and StructuredGauss.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "linbox/util/debug.h"
+
+namespace LinBox {
+
+    /**
+     * \brief Items 0..n-1 kept in buckets by their count, from 0 to maxCount.
+     *
+     * Insertion, removal and change of count are O(1): each bucket is a doubly linked list.
+     * The smallest non empty bucket is found by moving a pointer, which only moves up
+     * when buckets are emptied: a whole elimination costs O(n + maxCount) for the searches.
+     */
+    class CountBuckets {
+    public:
+        enum : size_t { npos = ~(size_t)0 };
+
+        CountBuckets(size_t n, size_t maxCount)
+            : _head(maxCount + 1, npos)
+            , _next(n, npos)
+            , _prev(n, npos)
+            , _count(n, npos)
+            , _min(maxCount + 1)
+            , _size(0)
+        {
+        }
+
+        size_t size() const { return _size; }
+        bool empty() const { return _size == 0; }
+        size_t maxCount() const { return _head.size() - 1; }
+
+        bool contains(size_t i) const { return _count[i] != npos; }
+        size_t count(size_t i) const { return _count[i]; }
+
+        /// Puts item i, which is not in a bucket, in bucket c.
+        void insert(size_t i, size_t c)
+        {
+            linbox_check(!contains(i) && c <= maxCount());
+            _count[i] = c;
+            _prev[i] = npos;
+            _next[i] = _head[c];
+            if (_head[c] != npos) _prev[_head[c]] = i;
+            _head[c] = i;
+            if (c < _min) _min = c;
+            ++_size;
+        }
+
+        /// Takes item i out of its bucket, if any.
+        void erase(size_t i)
+        {
+            if (!contains(i)) return;
+            if (_prev[i] != npos)
+                _next[_prev[i]] = _next[i];
+            else
+                _head[_count[i]] = _next[i];
+            if (_next[i] != npos) _prev[_next[i]] = _prev[i];
+            _count[i] = npos;
+            --_size;
+        }
+
+        /// Moves item i to bucket c.
+        void update(size_t i, size_t c)
+        {
+            if (_count[i] == c) return;
+            erase(i);
+            insert(i, c);
+        }
+
+        /// The smallest count of an item, npos if there is none.
+        size_t minCount()
+        {
+            if (empty()) return npos;
+            while (_head[_min] == npos) ++_min;
+            return _min;
+        }
+
+        /// First item of bucket c, npos if it is empty; next(i) iterates over the bucket.
+        size_t first(size_t c) const { return c <= maxCount() ? _head[c] : npos; }
+        size_t next(size_t i) const { return _next[i]; }
+
+    private:
+        std::vector<size_t> _head, _next, _prev, _count;
+        size_t _min, _size;
+    };
+
+    /// Whether the permutation i -> perm[i] of 0..n-1 is odd.
+    inline bool isOddPermutation(const std::vector<size_t>& perm)
+    {
+        // Parity of n - number of cycles
+        std::vector<bool> seen(perm.size(), false);
+        bool odd = false;
+        for (size_t i = 0; i < perm.size(); ++i) {
+            if (seen[i]) continue;
+            for (size_t j = perm[i]; j != i; j = perm[j]) {
+                seen[j] = true;
+                odd = !odd;
+            }
+            seen[i] = true;
+        }
+        return odd;
+    }
+
+    /**
+     * \brief Column ordering for sparse LU, by approximate minimum degree, in the spirit of COLAMD.
+     *
+     * Only the structure of the rows of A is used. Columns are ordered one by one,
+     * by smallest score: the sum of the sizes, minus one, of the rows in the column.
+     * Ordering a column merges its rows into one, the pivot row of the symbolic elimination,
+     * and the scores of the columns of this row are computed again.
+     * As in COLAMD, rows of more than 10 sqrt(Nj) entries are left out
+     * and columns of more than 10 sqrt(Ni) entries are ordered last.
+     *
+     * @bib
+     * - Timothy A. Davis, John R. Gilbert, Stefan I. Larimore and Esmond G. Ng,
+     * <i>A column approximate minimum degree ordering algorithm</i>.
+     * ACM Trans. Math. Softw. 30(3), pages 353--376, 2004.
+     */
+    template <class _Matrix>
+    std::vector<size_t>& approximateMinimumDegreeOrdering(std::vector<size_t>& order, const _Matrix& A, size_t Ni,
+                                                          size_t Nj)
+    {
+        const size_t denseRow = std::max((size_t)16, (size_t)(10 * std::sqrt((double)Nj)));
+        const size_t denseCol = std::max((size_t)16, (size_t)(10 * std::sqrt((double)Ni)));
+
+        std::vector<std::vector<size_t>> rows;
+        std::vector<std::vector<size_t>> colRows(Nj);
+        rows.reserve(Ni);
+        for (size_t i = 0; i < Ni; ++i) {
+            if (A[i].size() > denseRow) continue;
+            rows.emplace_back();
+            for (const auto& e : A[i]) {
+                rows.back().push_back(e.first);
+                colRows[e.first].push_back(rows.size() - 1);
+            }
+        }
+        std::vector<bool> alive(rows.size(), true);
+
+        order.clear();
+        order.reserve(Nj);
+        std::vector<size_t> dense;
+        std::vector<bool> ordered(Nj, false);
+        CountBuckets scores(Nj, Nj);
+
+        // Score of column j; dead rows are removed from its list.
+        auto score = [&](size_t j) {
+            size_t s = 0, n = 0;
+            for (size_t r : colRows[j])
+                if (alive[r]) {
+                    colRows[j][n++] = r;
+                    s += rows[r].size() - 1;
+                }
+            colRows[j].resize(n);
+            return std::min(s, Nj);
+        };
+
+        for (size_t j = 0; j < Nj; ++j) {
+            if (colRows[j].size() > denseCol)
+                dense.push_back(j);
+            else
+                scores.insert(j, score(j));
+        }
+
+        std::vector<size_t> mark(Nj, (size_t)-1);
+        while (!scores.empty()) {
+            const size_t j = scores.first(scores.minCount());
+            scores.erase(j);
+            order.push_back(j);
+            ordered[j] = true;
+
+            // Symbolic elimination: the rows of column j are merged into a new row, without j.
+            std::vector<size_t> merged;
+            mark[j] = j;
+            for (size_t r : colRows[j]) {
+                if (!alive[r]) continue;
+                alive[r] = false;
+                for (size_t c : rows[r])
+                    if (mark[c] != j && !ordered[c]) {
+                        mark[c] = j;
+                        merged.push_back(c);
+                    }
+                std::vector<size_t>().swap(rows[r]);
+            }
+            std::vector<size_t>().swap(colRows[j]);
+            if (merged.empty()) continue;
+
+            rows.push_back(std::move(merged));
+            alive.push_back(true);
+            const size_t r = rows.size() - 1;
+            for (size_t c : rows[r]) {
+                colRows[c].push_back(r);
+                if (scores.contains(c)) scores.update(c, score(c));
+            }
+        }
+
+        std::sort(dense.begin(), dense.end(),
+                  [&](size_t a, size_t b) { return colRows[a].size() < colRows[b].size(); });
+        order.insert(order.end(), dense.begin(), dense.end());
+        return order;
+    }
+}
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file algorithms/gauss/gauss-ordering.inl
+ * @ingroup algorithms
+ * @brief Sparse elimination with the Markowitz, ColumnOrdering and Singletons pivoting strategies.
+ */
+
+#pragma once
+
+namespace LinBox {
+
+    template <class _Field, class _RowStorage>
+    template <class _Matrix>
+    size_t& GaussDomain<_Field, _RowStorage>::OrderedPivoting(size_t& Rank, Element& determinant, _Matrix& A,
+                                                              size_t Ni, size_t Nj, PivotStrategy reord,
+                                                              std::vector<std::pair<size_t, size_t>>& pivots,
+                                                              std::vector<Element>* rhs) const
+    {
+        typedef typename _Matrix::Row Vector;
+        typedef typename Vector::value_type E;
+        const size_t npos = CountBuckets::npos;
+
+        LINBOX_TRACE_SPAN("gauss ordered pivoting");
+        commentator().start("Gaussian elimination with ordered pivoting", "OPIV", Ni);
+
+        // Active rows by number of entries; active columns by number of entries in the active rows,
+        // each with a list of rows which may have an entry in it.
+        CountBuckets rowQueue(Ni, Nj), colQueue(Nj, Ni);
+        std::vector<size_t> colCount(Nj, 0);
+        std::vector<std::vector<size_t>> colRows(Nj);
+        for (size_t i = 0; i < Ni; ++i) {
+            if (A[i].size()) rowQueue.insert(i, A[i].size());
+            for (const E& e : A[i]) {
+                ++colCount[e.first];
+                colRows[e.first].push_back(i);
+            }
+        }
+        for (size_t j = 0; j < Nj; ++j)
+            if (colCount[j]) colQueue.insert(j, colCount[j]);
+
+        std::vector<size_t> order;
+        size_t next = 0;
+        if (reord == PivotStrategy::ColumnOrdering) approximateMinimumDegreeOrdering(order, A, Ni, Nj);
+
+        // Position of column j in row i, A[i].size() if absent
+        auto find = [&A](size_t i, size_t j) {
+            const Vector& row = A[i];
+            auto it = std::lower_bound(row.begin(), row.end(), j, [](const E& e, size_t c) { return e.first < c; });
+            return (it != row.end() && it->first == j) ? (size_t)(it - row.begin()) : row.size();
+        };
+
+        // The active rows with an entry in column j, once each: the list of the column is cleaned.
+        std::vector<size_t> stamp(Ni, npos);
+        size_t tag = 0;
+        auto activeRows = [&](size_t j) -> const std::vector<size_t>& {
+            std::vector<size_t>& l = colRows[j];
+            size_t n = 0;
+            ++tag;
+            for (size_t i : l)
+                if (stamp[i] != tag && rowQueue.contains(i) && find(i, j) < A[i].size()) {
+                    stamp[i] = tag;
+                    l[n++] = i;
+                }
+            l.resize(n);
+            return l;
+        };
+
+        field().assign(determinant, field().one);
+        Rank = 0;
+        pivots.clear();
+        Vector merged;
+        Element pivot, headcoeff, tmp;
+
+        while (!colQueue.empty()) {
+            if (!(Rank % 1000)) commentator().progress((long)Rank);
+            size_t p = npos, q = npos;
+
+            if (reord == PivotStrategy::ColumnOrdering) {
+                // Next column of the ordering, sparsest row in it
+                while (next < order.size() && !colQueue.contains(order[next])) ++next;
+                if (next == order.size()) break;
+                q = order[next++];
+                for (size_t i : activeRows(q))
+                    if (p == npos || A[i].size() < A[p].size()) p = i;
+            }
+            else if (reord == PivotStrategy::Singletons) {
+                // Column singletons, then as Linear: sparsest row (row singletons first), sparsest column in it
+                if (colQueue.minCount() == 1) {
+                    q = colQueue.first(1);
+                    p = activeRows(q)[0];
+                }
+                else {
+                    p = rowQueue.first(rowQueue.minCount());
+                    for (const E& e : A[p])
+                        if (q == npos || colCount[e.first] < colCount[q]) q = e.first;
+                }
+            }
+            else {
+                // Markowitz: smallest (r_i - 1)(c_j - 1) among the entries of the sparsest columns and rows,
+                // at most _pivotSearch of them
+                size_t best = npos, examined = 0;
+                for (size_t c = std::min(colQueue.minCount(), rowQueue.minCount());; ++c) {
+                    for (size_t j = colQueue.first(c); j != npos && examined < _pivotSearch;
+                         j = colQueue.next(j), ++examined)
+                        for (size_t i : activeRows(j)) {
+                            const size_t cost = (A[i].size() - 1) * (c - 1);
+                            if (cost < best) {
+                                best = cost;
+                                p = i;
+                                q = j;
+                            }
+                        }
+                    if (p != npos && (examined >= _pivotSearch || best <= c * (c - 1))) break;
+                    for (size_t i = rowQueue.first(c); i != npos && examined < _pivotSearch;
+                         i = rowQueue.next(i), ++examined)
+                        for (const E& e : A[i]) {
+                            const size_t cost = (c - 1) * (colCount[e.first] - 1);
+                            if (cost < best) {
+                                best = cost;
+                                p = i;
+                                q = e.first;
+                            }
+                        }
+                    if (p != npos && (examined >= _pivotSearch || best <= c * c)) break;
+                }
+            }
+
+            // Pivot A[p][q]: row p and column q leave the active submatrix
+            pivots.emplace_back(p, q);
+            const size_t t = find(p, q);
+            field().assign(pivot, A[p][t].second);
+            field().mulin(determinant, pivot);
+            ++Rank;
+            rowQueue.erase(p);
+            colQueue.erase(q);
+            for (const E& e : A[p]) --colCount[e.first];
+
+            size_t fill = 0;
+            const Vector& rowp = A[p];
+            for (size_t i : activeRows(q)) {
+                // A[i] <-- A[i] - A[i][q] / pivot * A[p], merged without column q
+                Vector& rowi = A[i];
+                const size_t ti = find(i, q), ni = rowi.size(), np = rowp.size();
+                field().divin(field().neg(headcoeff, rowi[ti].second), pivot);
+                if (rhs) field().axpyin((*rhs)[i], headcoeff, (*rhs)[p]);
+
+                merged.clear();
+                size_t a = 0, b = 0;
+                while (a < ni || b < np) {
+                    if (a == ti) {
+                        ++a;
+                        continue;
+                    }
+                    if (b == t) {
+                        ++b;
+                        continue;
+                    }
+                    if (b == np || (a < ni && rowi[a].first < rowp[b].first)) {
+                        merged.push_back(rowi[a++]);
+                    }
+                    else if (a == ni || rowp[b].first < rowi[a].first) {
+                        const size_t j = rowp[b].first;
+                        field().mul(tmp, headcoeff, rowp[b++].second);
+                        merged.push_back(E(j, tmp));
+                        ++colCount[j];
+                        colRows[j].push_back(i);
+                        ++fill;
+                    }
+                    else {
+                        field().axpy(tmp, headcoeff, rowp[b++].second, rowi[a].second);
+                        if (!field().isZero(tmp))
+                            merged.push_back(E(rowi[a].first, tmp));
+                        else
+                            --colCount[rowi[a].first];
+                        ++a;
+                    }
+                }
+                std::swap(rowi, merged);
+                if (rowi.size())
+                    rowQueue.update(i, rowi.size());
+                else
+                    rowQueue.erase(i);
+            }
+            if (fill) LINBOX_TRACE_COUNT(FillIn, fill);
+            std::vector<size_t>().swap(colRows[q]);
+
+            for (const E& e : rowp)
+                if (e.first != q) {
+                    if (colCount[e.first])
+                        colQueue.update(e.first, colCount[e.first]);
+                    else
+                        colQueue.erase(e.first);
+                }
+            // The pivot rows are kept for the back substitution of a solve
+            if (!rhs) A[p] = Vector();
+        }
+
+        if ((Rank < Ni) || (Rank < Nj) || (Ni == 0) || (Nj == 0))
+            field().assign(determinant, field().zero);
+        else {
+            // det(A) = sign(rows) sign(columns) * product of the pivots
+            std::vector<size_t> rowPerm(Ni), colPerm(Nj);
+            for (size_t k = 0; k < Rank; ++k) {
+                rowPerm[k] = pivots[k].first;
+                colPerm[k] = pivots[k].second;
+            }
+            if (isOddPermutation(rowPerm) != isOddPermutation(colPerm)) field().negin(determinant);
+        }
+
+        integer card;
+        field().write(commentator().report(Commentator::LEVEL_NORMAL, PARTIAL_RESULT) << "Determinant : ", determinant)
+            << " over GF (" << field().cardinality(card) << ")" << std::endl;
+        commentator().report(Commentator::LEVEL_NORMAL, PARTIAL_RESULT)
+            << "Rank : " << Rank << " over GF (" << card << ")" << std::endl;
+        commentator().stop("done", 0, "OPIV");
+        return Rank;
+    }
+
+    template <class _Field, class _RowStorage>
+    template <class _Matrix, class Vector1, class Vector2>
+    inline Vector1& GaussDomain<_Field, _RowStorage>::solveInPlace(Vector1& x, _Matrix& A, const Vector2& b,
+                                                                   PivotStrategy reord) const
+    {
+        if (reord == PivotStrategy::None || reord == PivotStrategy::Linear) return solveInPlace(x, A, b);
+
+        const size_t Ni = A.rowdim(), Nj = A.coldim();
+        std::vector<Element> y(Ni);
+        for (size_t i = 0; i < Ni; ++i) field().assign(y[i], b[i]);
+
+        size_t Rank;
+        Element Det;
+        std::vector<std::pair<size_t, size_t>> pivots;
+        OrderedPivoting(Rank, Det, A, Ni, Nj, reord, pivots, &y);
+
+        // The rows without pivot are now zero, so must be their right hand side.
+        std::vector<bool> pivotRow(Ni, false);
+        for (const auto& pq : pivots) pivotRow[pq.first] = true;
+        for (size_t i = 0; i < Ni; ++i)
+            if (!pivotRow[i] && !field().isZero(y[i]))
+                throw LinboxMathInconsistentSystem("From sparse elimination solve.");
+
+        // Back substitution; the columns without pivot are set to zero.
+        // A pivot row only has entries in the columns of the later pivots.
+        for (size_t j = 0; j < Nj; ++j) field().assign(x[j], field().zero);
+        Element pivot;
+        for (size_t k = Rank; k-- > 0;) {
+            const size_t p = pivots[k].first, q = pivots[k].second;
+            for (const auto& e : A[p]) {
+                if (e.first == q)
+                    field().assign(pivot, e.second);
+                else
+                    field().maxpyin(y[p], e.second, x[e.first]);
+            }
+            field().div(x[q], y[p], pivot);
+        }
+        return x;
+    }
+}
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -31,9 +31,9 @@
 namespace LinBox
 {
 
-	template <class _Field>
+	template <class _Field, class _RowStorage>
 	template <class Vector, class D> inline void
-	GaussDomain<_Field>::SparseFindPivot (Vector        	&lignepivot,
+	GaussDomain<_Field, _RowStorage>::SparseFindPivot (Vector        	&lignepivot,
 					      size_t 	&indcol,
 					      long 		&indpermut,
 					      D             	&columns,
@@ -105,9 +105,9 @@ namespace LinBox
 	}
 
 
-	template <class _Field>
+	template <class _Field, class _RowStorage>
 	template <class Vector> inline void
-	GaussDomain<_Field>::SparseFindPivot (Vector &lignepivot,
+	GaussDomain<_Field, _RowStorage>::SparseFindPivot (Vector &lignepivot,
 					      size_t &indcol,
 					      long &indpermut,
 					      Element& determinant) const
@@ -128,9 +128,9 @@ namespace LinBox
 			indpermut = -1;
 	}
 
-	template <class _Field>
+	template <class _Field, class _RowStorage>
 	template <class Vector> inline void
-	GaussDomain<_Field>::FindPivot (Vector &lignepivot,
+	GaussDomain<_Field, _RowStorage>::FindPivot (Vector &lignepivot,
 					size_t &k,
 					long &indpermut) const
 	{
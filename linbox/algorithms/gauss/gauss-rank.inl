@@ -30,9 +30,9 @@
 
 namespace LinBox
 {
-	template <class _Field>
+	template <class _Field, class _RowStorage>
 	template <class _Matrix> size_t&
-	GaussDomain<_Field>::rankInPlace(size_t &Rank,
+	GaussDomain<_Field, _RowStorage>::rankInPlace(size_t &Rank,
 				    _Matrix        &A,
 				    size_t  Ni,
 				    size_t  Nj,
@@ -41,14 +41,18 @@ namespace LinBox
 		Element determinant;
 		if (reord == PivotStrategy::None)
 			return NoReordering(Rank, determinant, A,  Ni, Nj);
-		else
+		else if (reord == PivotStrategy::Linear)
 			return InPlaceLinearPivoting(Rank, determinant, A, Ni, Nj);
+		else {
+			std::vector<std::pair<size_t, size_t> > pivots;
+			return OrderedPivoting(Rank, determinant, A, Ni, Nj, reord, pivots);
+		}
 	}
 
 
-	template <class _Field>
+	template <class _Field, class _RowStorage>
 	template <class _Matrix> size_t&
-	GaussDomain<_Field>::rankInPlace(size_t &Rank,
+	GaussDomain<_Field, _RowStorage>::rankInPlace(size_t &Rank,
 				    _Matrix        &A,
 				    PivotStrategy   reord)  const
 	{
@@ -57,18 +61,18 @@ namespace LinBox
 
 
 
-	template <class _Field>
+	template <class _Field, class _RowStorage>
 	template <class _Matrix> size_t&
-	GaussDomain<_Field>::rank(size_t &rk,
+	GaussDomain<_Field, _RowStorage>::rank(size_t &rk,
 				  const _Matrix        &A,
 				  PivotStrategy   reord)  const
 	{
 		return rank(rk, A,  A.rowdim (), A.coldim (), reord);
 	}
 
-	template <class _Field>
+	template <class _Field, class _RowStorage>
 	template <class _Matrix> size_t&
-	GaussDomain<_Field>::rank(size_t &Rank,
+	GaussDomain<_Field, _RowStorage>::rank(size_t &Rank,
 				  const _Matrix        &A,
 				  size_t  Ni,
 				  size_t  Nj,
@@ -36,9 +36,9 @@ namespace LinBox
 {
 
 
-	template <class _Field>
+	template <class _Field, class _RowStorage>
 	template <class _Matrix, class Perm, class Vector1, class Vector2> inline Vector1&
-	GaussDomain<_Field>::solve(Vector1& x, Vector1& w, size_t Rank, const Perm& Q, const _Matrix& L, const _Matrix& U, const Perm& P, const Vector2& b)  const
+	GaussDomain<_Field, _RowStorage>::solve(Vector1& x, Vector1& w, size_t Rank, const Perm& Q, const _Matrix& L, const _Matrix& U, const Perm& P, const Vector2& b)  const
 	{
             // Q L U P x = b
 		Vector2 y(U.field(),U.rowdim()), v(U.field(),U.rowdim());
@@ -56,9 +56,9 @@ namespace LinBox
 		return P.applyTranspose(x, w);
 	}
 
-	template <class _Field>
+	template <class _Field, class _RowStorage>
 	template <class _Matrix, class Vector1, class Vector2> inline Vector1&
-	GaussDomain<_Field>::solveInPlace(Vector1& x, _Matrix& A, const Vector2& b)  const
+	GaussDomain<_Field, _RowStorage>::solveInPlace(Vector1& x, _Matrix& A, const Vector2& b)  const
 	{
 
 		typename Field::Element Det;
@@ -94,9 +94,9 @@ namespace LinBox
 		return this->solve(x, w, Rank, Q, L, A, P, b);
 	}
 
-	template <class _Field>
+	template <class _Field, class _RowStorage>
 	template <class _Matrix, class Vector1, class Vector2, class Random> inline Vector1&
-	GaussDomain<_Field>::solveInPlace(Vector1& x, _Matrix& A, const Vector2& b, Random& generator)  const
+	GaussDomain<_Field, _RowStorage>::solveInPlace(Vector1& x, _Matrix& A, const Vector2& b, Random& generator)  const
 	{
 		typename Field::Element Det;
 		size_t Rank;
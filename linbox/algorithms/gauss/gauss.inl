@@ -36,6 +36,7 @@
 #include "linbox/util/commentator.h"
 #include <givaro/zring.h>
 #include <givaro/ring-interface.h>
+#include <limits>
 #include <utility>
 #include <type_traits>
 
@@ -56,9 +57,9 @@
 
 namespace LinBox
 {
-    template <class _Field>
+    template <class _Field, class _RowStorage>
     template <class _Matrix, class Perm> inline size_t&
-    GaussDomain<_Field>::QLUPin (size_t &Rank,
+    GaussDomain<_Field, _RowStorage>::QLUPin (size_t &Rank,
                      Element       &determinant,
                      Perm          &Q,
                      _Matrix        &LigneL,
@@ -81,6 +82,7 @@ namespace LinBox
         // In place (LigneA is modified)
         // With reordering (D is a density type. Density is allocated here)
         //    long Ni = LigneA.n_row (), Nj = LigneA.n_col ();
+        LINBOX_TRACE_SPAN ("gauss QLUPin");
         commentator().start ("QLUPin Gaussian elimination with reordering",
                      "IPLR", Ni);
         commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
@@ -267,9 +269,9 @@ namespace LinBox
 
 
 
-    template <class _Field>
+    template <class _Field, class _RowStorage>
     template <class _Matrix, class Perm> inline size_t&
-    GaussDomain<_Field>::SparseContinuation (size_t &Rank,
+    GaussDomain<_Field, _RowStorage>::SparseContinuation (size_t &Rank,
                      Element       &determinant,
                      std::deque<std::pair<size_t,size_t> > &invQ,
                      _Matrix        &LigneL,
@@ -294,13 +296,13 @@ namespace LinBox
     }
 
 
-    template <class _Field>
+    template <class _Field, class _RowStorage>
     template<class _Matrix, class Perm>
-    struct GaussDomain<_Field>::Continuation<_Matrix,Perm,false> {
+    struct GaussDomain<_Field, _RowStorage>::Continuation<_Matrix,Perm,false> {
         size_t& operator()(
-            const GaussDomain<_Field>& GD,
+            const GaussDomain<_Field, _RowStorage>& GD,
             size_t &Rank,
-            typename GaussDomain<_Field>::Element       &determinant,
+            typename GaussDomain<_Field, _RowStorage>::Element       &determinant,
             std::deque<std::pair<size_t,size_t> > &invQ,
             _Matrix        &LigneL,
             _Matrix        &LigneA,
@@ -313,13 +315,13 @@ namespace LinBox
             }
     };
 
-    template <class _Field>
+    template <class _Field, class _RowStorage>
     template <class _Matrix, class Perm>
-    struct GaussDomain<_Field>::Continuation<_Matrix,Perm,true> {
+    struct GaussDomain<_Field, _RowStorage>::Continuation<_Matrix,Perm,true> {
         size_t& operator()(
-            const GaussDomain<_Field>& GD,
+            const GaussDomain<_Field, _RowStorage>& GD,
             size_t &Rank,
-            typename GaussDomain<_Field>::Element       &determinant,
+            typename GaussDomain<_Field, _RowStorage>::Element       &determinant,
             std::deque<std::pair<size_t,size_t> > &invQ,
             _Matrix        &LigneL,
             _Matrix        &LigneA,
@@ -341,9 +343,9 @@ namespace LinBox
 
 
 
-    template <class _Field>
+    template <class _Field, class _RowStorage>
     template <class _Matrix, class Perm> inline size_t&
-    GaussDomain<_Field>::DenseQLUPin (size_t &Rank,
+    GaussDomain<_Field, _RowStorage>::DenseQLUPin (size_t &Rank,
                      Element       &determinant,
                      std::deque<std::pair<size_t,size_t> > &dinvQ,
                      _Matrix        &dLigneL,
@@ -466,9 +468,9 @@ namespace LinBox
     }
 
 
-    template <class _Field>
+    template <class _Field, class _RowStorage>
     template <class _Matrix> inline size_t&
-    GaussDomain<_Field>::InPlaceLinearPivoting (size_t &Rank,
+    GaussDomain<_Field, _RowStorage>::InPlaceLinearPivoting (size_t &Rank,
                             Element        &determinant,
                             _Matrix         &LigneA,
                             size_t   Ni,
@@ -476,10 +478,15 @@ namespace LinBox
     {
         typedef typename _Matrix::Row        Vector;
 
+        if (std::is_same<RowStorage, GaussRowStorage::Arena>::value
+            && Nj <= (size_t)std::numeric_limits<typename Arena::Index>::max ())
+            return ArenaLinearPivoting (Rank, determinant, LigneA, Ni, Nj);
+
         // Requirements : LigneA is an array of sparse rows
         // In place (LigneA is modified)
         // With reordering (D is a density type. Density is allocated here)
         //    long Ni = LigneA.n_row (), Nj = LigneA.n_col ();
+        LINBOX_TRACE_SPAN ("gauss IPLR");
         commentator().start ("IPLR Gaussian elimination with reordering",
                      "IPLR", Ni);
         field().write( commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
@@ -608,9 +615,9 @@ namespace LinBox
 
 
 
-    template <class _Field>
+    template <class _Field, class _RowStorage>
     template <class _Matrix, class Perm> inline size_t&
-    GaussDomain<_Field>::InPlaceLinearPivoting (size_t &Rank,
+    GaussDomain<_Field, _RowStorage>::InPlaceLinearPivoting (size_t &Rank,
                             Element        &determinant,
                             _Matrix         &LigneA,
                             Perm           &P,
@@ -623,6 +630,7 @@ namespace LinBox
         // In place (LigneA is modified)
         // With reordering (D is a density type. Density is allocated here)
         //    long Ni = LigneA.n_row (), Nj = LigneA.n_col ();
+        LINBOX_TRACE_SPAN ("gauss IPperm");
         commentator().start ("IPperm Gaussian elimination with reordering",
                      "IPLR", Ni);
         field().write( commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
@@ -761,9 +769,9 @@ namespace LinBox
         return Rank;
     }
 
-    template <class _Field>
+    template <class _Field, class _RowStorage>
     template <class _Matrix> inline size_t&
-    GaussDomain<_Field>::NoReordering (size_t &res,
+    GaussDomain<_Field, _RowStorage>::NoReordering (size_t &res,
                        Element       &determinant,
                        _Matrix        &LigneA,
                        size_t  Ni,
@@ -774,6 +782,7 @@ namespace LinBox
         // Without reordering (Pivot is first non-zero in row)
         //     long Ni = SLA.n_row (), Nj = SLA.n_col ();
         //    long Ni = LigneA.n_row (), Nj = LigneA.n_col ();
+        LINBOX_TRACE_SPAN ("gauss NoReordering");
         commentator().start ("Gaussian elimination (no reordering)",
                      "NoRe", Ni);
         commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
@@ -841,9 +850,9 @@ namespace LinBox
     }
 
 
-    template <class _Field>
+    template <class _Field, class _RowStorage>
     template<class Vector> inline void
-    GaussDomain<_Field>::Upper (Vector        &lignecur,
+    GaussDomain<_Field, _RowStorage>::Upper (Vector        &lignecur,
                     const Vector  &lignepivot,
                     size_t  indcol,
                     long  indpermut) const
@@ -870,9 +879,9 @@ namespace LinBox
             field().axpyin (lignecur[j], headcoeff, lignepivot[j]) ;
     }
 
-    template <class _Field>
+    template <class _Field, class _RowStorage>
     template <class Vector> inline void
-    GaussDomain<_Field>::LU (Vector        &lignecur,
+    GaussDomain<_Field, _RowStorage>::LU (Vector        &lignecur,
                  const Vector  &lignepivot,
                  size_t  indcol,
                  long  indpermut) const
@@ -897,9 +906,9 @@ namespace LinBox
     }
 
 
-    template <class _Field>
+    template <class _Field, class _RowStorage>
     template <class _Matrix> inline size_t &
-    GaussDomain<_Field>::upperin (size_t &res, _Matrix &A) const
+    GaussDomain<_Field, _RowStorage>::upperin (size_t &res, _Matrix &A) const
     {
         // Requirements : A is an array of rows
         // In place (A is modified)
@@ -920,9 +929,9 @@ namespace LinBox
         return res = indcol;
     }
 
-    template <class _Field>
+    template <class _Field, class _RowStorage>
     template <class _Matrix> inline size_t &
-    GaussDomain<_Field>::LUin (size_t &res, _Matrix &A) const
+    GaussDomain<_Field, _RowStorage>::LUin (size_t &res, _Matrix &A) const
     {
         // Requirements : A is an array of rows
         // In place (A is modified)
@@ -0,0 +1,595 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file algorithms/integer-matrix-apply.h
+ * @ingroup algorithms
+ * @brief Products of a fixed integer matrix with bounded integer vectors or matrices.
+ *
+ * This is the engine behind the p-adic lifting residual update
+ * (residual := (residual - A digit) / p), where the same matrix is applied
+ * to many small-entried operands.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <givaro/modular.h>
+#include <givaro/zring.h>
+
+#include <fflas-ffpack/fflas/fflas.h>
+
+#include "linbox/algorithms/integer-rns.h"
+#include "linbox/integer.h"
+#include "linbox/linbox-config.h"
+#include "linbox/matrix/matrix-domain.h"
+#include "linbox/matrix/transpose-matrix.h"
+#include "linbox/util/debug.h"
+#include "linbox/util/task-pool.h"
+#include "linbox/vector/fixed-precision-vector.h"
+
+namespace LinBox {
+
+    /**
+     * \brief Apply a fixed integer matrix to operands bounded by a modulus.
+     *
+     * The m x n matrix A is given at construction and must stay alive and unchanged.
+     * setup(p) declares that every entry x of the right operand satisfies |x| < p,
+     * then estimates the cost of each strategy and keeps the cheapest one:
+     *
+     * - Classic: multiprecision dot products.
+     * - MatrixQadic: the entries of A are cut in s-bit signed chunks stored as doubles,
+     *   all chunks are stacked so that a single dgemv (dgemm) computes every partial product,
+     *   the result is recombined by a Horner scheme in base 2^s.
+     * - VectorQadic: A fits in doubles and the operand is cut in s-bit chunks instead.
+     * - RNS: A is reduced once modulo word-size primes (IntegerRNS),
+     *   the product is done by one fgemv (fgemm) per prime and reconstructed by CRT.
+     *
+     * Chunks are read from the GMP limbs, so no strategy depends on the byte order.
+     * The double products are split in row tiles (and primes for RNS) which run
+     * on a TaskPool, as do the recombinations.
+     *
+     * The scratch buffers are reused from one call to the next:
+     * a domain must not be used by several threads at once.
+     */
+    template <class _Ring, class _IMatrix>
+    class IntegerMatrixApplyDomain {
+    public:
+        using Ring = _Ring;
+        using IMatrix = _IMatrix;
+        using Element = typename Ring::Element;
+        using Vector = BlasVector<Ring>;
+
+        enum class Strategy { Auto, Classic, MatrixQadic, VectorQadic, RNS };
+
+    public:
+        IntegerMatrixApplyDomain(const Ring& R, const IMatrix& A, TaskPool& pool = TaskPool::current())
+            : _ring(R)
+            , _A(A)
+            , _MD(R)
+            , _pool(pool)
+            , _m(A.rowdim())
+            , _n(A.coldim())
+        {
+            // Magnitude of A, computed once.
+            Integer tmp;
+            _maxA = 0;
+            for (size_t i = 0; i < _m; ++i) {
+                for (size_t j = 0; j < _n; ++j) {
+                    _ring.convert(tmp, _A.getEntry(i, j));
+                    if (tmp < 0) tmp = -tmp;
+                    if (tmp > _maxA) _maxA = tmp;
+                }
+            }
+        }
+
+        /**
+         * \brief Prepare the products with operands bounded by prime.
+         *
+         * \param prime   Every entry of the right operand must be smaller than prime in absolute value.
+         * \param forced  Use this strategy if it is feasible, otherwise let the cost model choose.
+         * \returns The strategy retained.
+         */
+        Strategy setup(const Integer& prime, Strategy forced = Strategy::Auto)
+        {
+            _maxX = prime - 1;
+            if (_maxX < 0) _maxX = 0;
+            _chunks.clear();
+            _rnsA.clear();
+            _rns.reset();
+
+            const size_t bitsA = _maxA.bitsize();
+            const size_t bitsX = _maxX.bitsize();
+            const size_t bitsN = Integer(static_cast<uint64_t>(_n)).bitsize();
+            const double limbsA = std::ceil(bitsA / 64.0);
+            const double limbsX = std::ceil(bitsX / 64.0);
+
+            // Costs are in double multiply-adds per column of the operand.
+            const double mn = static_cast<double>(_m) * static_cast<double>(_n);
+            double costs[5] = {0, 0, 0, 0, 0};
+            bool feasible[5] = {false, true, false, false, false};
+            costs[index(Strategy::Classic)] = mn * (ClassicOverhead + 2 * limbsA * limbsX);
+
+            // MatrixQadic: n (2^s - 1) |x| < 2^52
+            _matrixChunkBits = chunkBits(bitsN + bitsX);
+            if (_maxA != 0 && _matrixChunkBits >= MinChunkBits) {
+                _matrixNumChunks = (bitsA + _matrixChunkBits - 1) / _matrixChunkBits;
+                feasible[index(Strategy::MatrixQadic)] = true;
+                costs[index(Strategy::MatrixQadic)] =
+                    _matrixNumChunks * (mn + _m * RecombineOverhead * (limbsA + limbsX)) + _n;
+            }
+
+            // VectorQadic: n |A| (2^s - 1) < 2^52
+            _vectorChunkBits = chunkBits(bitsN + bitsA);
+            if (_maxA != 0 && _vectorChunkBits >= MinChunkBits) {
+                _vectorNumChunks = std::max<size_t>(1, (bitsX + _vectorChunkBits - 1) / _vectorChunkBits);
+                feasible[index(Strategy::VectorQadic)] = true;
+                costs[index(Strategy::VectorQadic)] =
+                    _vectorNumChunks * (mn + _m * RecombineOverhead * (limbsA + limbsX) + 2 * _n);
+            }
+
+            // RNS: n (p_i - 1)^2 < 2^53, with a basis covering 2 n |A| |x|
+            std::vector<double> basis;
+            if (_maxA != 0 && _n > 0) {
+                Integer bound = _maxA * _maxX;
+                bound *= static_cast<uint64_t>(_n);
+                bound <<= 1;
+                bound += 1;
+                IntegerRNS::basis(basis, _n, bound);
+                if (!basis.empty()) {
+                    const double r = static_cast<double>(basis.size());
+                    feasible[index(Strategy::RNS)] = true;
+                    costs[index(Strategy::RNS)] = r * (mn + 2 * _n * limbsX + RecombineOverhead * _m * r);
+                }
+            }
+
+            if (forced != Strategy::Auto && feasible[index(forced)]) {
+                _strategy = forced;
+            }
+            else {
+                _strategy = Strategy::Classic;
+                for (Strategy s : {Strategy::MatrixQadic, Strategy::VectorQadic, Strategy::RNS}) {
+                    if (feasible[index(s)] && costs[index(s)] < costs[index(_strategy)]) _strategy = s;
+                }
+            }
+
+            switch (_strategy) {
+            case Strategy::MatrixQadic: setupMatrixQadic(); break;
+            case Strategy::VectorQadic: setupVectorQadic(); break;
+            case Strategy::RNS: setupRNS(basis); break;
+            default: break;
+            }
+
+            return _strategy;
+        }
+
+        Strategy strategy() const { return _strategy; }
+
+        /// y = A x
+        template <class OutVector, class InVector>
+        OutVector& apply(OutVector& y, const InVector& x) const
+        {
+            linbox_check(x.size() == _n);
+            linbox_check(y.size() == _m);
+
+            if (_strategy == Strategy::Classic) {
+                return _MD.vectorMul(y, _A, x);
+            }
+
+            gatherVector(x);
+            multiply(1);
+
+            if (_strategy == Strategy::RNS) {
+                for (size_t i = 0; i < _m; ++i) _ring.init(y[i], _out[i]);
+                return y;
+            }
+
+            _pool.parallelFor(0, _m, 0, [&](size_t i) {
+                Integer acc;
+                recombine(acc, i, 0, 1);
+                _ring.init(y[i], acc);
+            });
+
+            return y;
+        }
+
+        /// Y = A X
+        template <class OutMatrix, class InMatrix>
+        OutMatrix& applyM(OutMatrix& Y, const InMatrix& X) const
+        {
+            linbox_check(X.rowdim() == _n);
+            linbox_check(Y.rowdim() == _m);
+            linbox_check(Y.coldim() == X.coldim());
+
+            if (_strategy == Strategy::Classic) {
+                return _MD.mul(Y, _A, X);
+            }
+
+            const size_t c = X.coldim();
+            _in.resize(_n * c);
+            for (size_t j = 0; j < _n; ++j) {
+                for (size_t k = 0; k < c; ++k) {
+                    _ring.convert(_in[j * c + k], X.getEntry(j, k));
+                }
+            }
+            multiply(c);
+
+            _pool.parallelFor(0, _m, 0, [&](size_t i) {
+                Integer acc;
+                Element e;
+                for (size_t k = 0; k < c; ++k) {
+                    if (_strategy == Strategy::RNS) {
+                        _ring.init(e, _out[i * c + k]);
+                    }
+                    else {
+                        recombine(acc, i, k, c);
+                        _ring.init(e, acc);
+                    }
+                    Y.setEntry(i, k, e);
+                }
+            });
+
+            return Y;
+        }
+
+        /// y = A^T x, only used outside the lifting loop, hence not optimized.
+        template <class OutVector, class InVector>
+        OutVector& applyTranspose(OutVector& y, const InVector& x) const
+        {
+            TransposeMatrix<const IMatrix> B(_A);
+            return _MD.vectorMul(y, B, x);
+        }
+
+        /**
+         * \brief res = (res - A digit) / p, in place.
+         *
+         * The product A digit is never stored as an integer vector:
+         * each row is recombined and subtracted on the fly.
+         *
+         * \param checkDivision  Verify that p divides every updated residue.
+         * \returns false if checkDivision is set and a residue is not divisible by p.
+         */
+        template <class ResVector, class DigitVector>
+        bool residualUpdate(ResVector& res, const DigitVector& digit, const Element& p, bool checkDivision = false) const
+        {
+            linbox_check(digit.size() == _n);
+            linbox_check(res.size() == _m);
+
+            if (_strategy != Strategy::Classic) {
+                gatherVector(digit);
+                multiply(1);
+            }
+
+            std::atomic<bool> divisible(true);
+            _pool.parallelFor(0, _m, 0, [&](size_t i) {
+                Integer acc;
+                Element e;
+                switch (_strategy) {
+                case Strategy::Classic:
+                    for (size_t j = 0; j < _n; ++j) _ring.maxpyin(res[i], _A.getEntry(i, j), digit[j]);
+                    break;
+                case Strategy::RNS:
+                    _ring.init(e, _out[i]);
+                    _ring.subin(res[i], e);
+                    break;
+                default:
+                    recombine(acc, i, 0, 1);
+                    _ring.init(e, acc);
+                    _ring.subin(res[i], e);
+                    break;
+                }
+
+                if (checkDivision && !_ring.isDivisor(res[i], p)) {
+                    divisible = false;
+                }
+                _ring.divin(res[i], p);
+            });
+
+            return divisible;
+        }
+
+        /// Same as above, on limb storage: p must fit in a limb and nothing is allocated.
+        template <class DigitVector>
+        bool residualUpdate(FixedPrecisionVector& res, const DigitVector& digit, const Element& p,
+                            bool checkDivision = false) const
+        {
+            linbox_check(digit.size() == _n);
+            linbox_check(res.size() == _m);
+
+            Integer pInteger;
+            _ring.convert(pInteger, p);
+            const mp_limb_t pLimb = FixedPrecisionVector::toLimb(pInteger);
+
+            if (_strategy != Strategy::Classic) {
+                gatherVector(digit);
+                multiply(1);
+            }
+
+            const size_t bitsN = Integer(static_cast<uint64_t>(_n)).bitsize();
+            res.prepareSubtraction(_maxA.bitsize() + _maxX.bitsize() + bitsN);
+            const mp_limb_t shift = checkDivision ? res.powerOfBase(pLimb) : 0;
+
+            std::atomic<bool> divisible(true);
+            _pool.parallelFor(0, _m, 0, [&](size_t i) {
+                Integer acc;
+                Element e;
+                switch (_strategy) {
+                case Strategy::Classic:
+                    _ring.assign(e, _ring.zero);
+                    for (size_t j = 0; j < _n; ++j) _ring.axpyin(e, _A.getEntry(i, j), digit[j]);
+                    _ring.convert(acc, e);
+                    res.subin(i, acc);
+                    break;
+                case Strategy::RNS:
+                    res.subin(i, _out[i]);
+                    break;
+                default:
+                    recombine(acc, i, 0, 1);
+                    res.subin(i, acc);
+                    break;
+                }
+
+                if (checkDivision && res.mod(i, pLimb, shift) != 0) {
+                    divisible = false;
+                }
+                res.divin(i, pLimb);
+            });
+            res.completeDivision(pLimb);
+
+            return divisible;
+        }
+
+        // Interface of MatrixApplyDomain
+
+        Vector& applyV(Vector& y, Vector& x, Vector&) const { return apply(y, x); }
+
+        Vector& applyVTrans(Vector& y, Vector& x) const { return applyTranspose(y, x); }
+
+    private:
+        // Keep some margin below the 53 bits of mantissa of a double.
+        static constexpr size_t MantissaBits = 52;
+        static constexpr size_t MinChunkBits = 8;
+        static constexpr size_t MaxChunkBits = 32;
+        static constexpr size_t MinTileRows = 32;
+        static constexpr double ClassicOverhead = 20.0;
+        static constexpr double RecombineOverhead = 8.0;
+
+        static size_t index(Strategy s) { return static_cast<size_t>(s); }
+
+        static size_t chunkBits(size_t usedBits)
+        {
+            if (usedBits >= MantissaBits) return 0;
+            return (MantissaBits - usedBits < MaxChunkBits) ? MantissaBits - usedBits : size_t(MaxChunkBits);
+        }
+
+        /// Bits [offset, offset + len) of |z|, len <= 32.
+        static uint64_t bitSlice(mpz_srcptr z, size_t offset, size_t len)
+        {
+            const size_t numbBits = GMP_NUMB_BITS;
+            mp_size_t limb = static_cast<mp_size_t>(offset / numbBits);
+            const size_t shift = offset % numbBits;
+            uint64_t v = static_cast<uint64_t>(mpz_getlimbn(z, limb)) >> shift;
+            for (size_t got = numbBits - shift; got < len; got += numbBits) {
+                v |= static_cast<uint64_t>(mpz_getlimbn(z, ++limb)) << got;
+            }
+            return v & ((uint64_t(1) << len) - 1);
+        }
+
+        /// chunks[t * stride] = t-th signed s-bit chunk of a, for t < k.
+        static void split(double* chunks, size_t stride, const Integer& a, size_t s, size_t k)
+        {
+            mpz_srcptr z = a.get_mpz_const();
+            const double sign = (mpz_sgn(z) < 0) ? -1.0 : 1.0;
+            for (size_t t = 0; t < k; ++t) {
+                chunks[t * stride] = sign * static_cast<double>(bitSlice(z, t * s, s));
+            }
+        }
+
+        size_t tileCount(size_t rows) const
+        {
+            return std::max<size_t>(1, std::min(_pool.numThreads(), rows / MinTileRows));
+        }
+
+        /// C = A B (rows x cols, inner dimension inner) over F, split in row tiles.
+        template <class Field>
+        void tiledProduct(const Field& F, size_t rows, size_t cols, size_t inner, const double* A, const double* B,
+                          double* C) const
+        {
+            const size_t tiles = tileCount(rows);
+            const size_t step = (rows + tiles - 1) / tiles;
+            _pool.parallelFor(0, tiles, 1, [&](size_t t) {
+                const size_t begin = t * step;
+                const size_t end = std::min(rows, begin + step);
+                if (begin < end) product(F, end - begin, cols, inner, A + begin * inner, B, C + begin * cols);
+            });
+        }
+
+        template <class Field>
+        static void product(const Field& F, size_t rows, size_t cols, size_t inner, const double* A, const double* B,
+                            double* C)
+        {
+            if (cols == 1) {
+                FFLAS::fgemv(F, FFLAS::FflasNoTrans, rows, inner, F.one, A, inner, B, 1, F.zero, C, 1);
+            }
+            else {
+                FFLAS::fgemm(F, FFLAS::FflasNoTrans, FFLAS::FflasNoTrans, rows, cols, inner, F.one, A, inner, B, cols,
+                             F.zero, C, cols);
+            }
+        }
+
+        void setupMatrixQadic()
+        {
+            const size_t s = _matrixChunkBits;
+            const size_t k = _matrixNumChunks;
+            const size_t mn = _m * _n;
+            _chunks.resize(k * mn);
+
+            Integer a;
+            for (size_t i = 0; i < _m; ++i) {
+                for (size_t j = 0; j < _n; ++j) {
+                    _ring.convert(a, _A.getEntry(i, j));
+                    split(_chunks.data() + i * _n + j, mn, a, s, k);
+                }
+            }
+        }
+
+        void setupVectorQadic()
+        {
+            _chunks.resize(_m * _n);
+            for (size_t i = 0; i < _m; ++i) {
+                for (size_t j = 0; j < _n; ++j) {
+                    _ring.convert(_chunks[i * _n + j], _A.getEntry(i, j));
+                }
+            }
+        }
+
+        void setupRNS(const std::vector<double>& basis)
+        {
+            _rns.reset(new IntegerRNS(basis, _pool));
+
+            const size_t mn = _m * _n;
+            std::vector<Integer> entries(mn);
+            for (size_t i = 0; i < _m; ++i) {
+                for (size_t j = 0; j < _n; ++j) {
+                    _ring.convert(entries[i * _n + j], _A.getEntry(i, j));
+                }
+            }
+            _rnsA.resize(basis.size() * mn);
+            _rns->reduce(_rnsA.data(), entries.data(), _n, _m, _n, _maxA);
+        }
+
+        template <class InVector>
+        void gatherVector(const InVector& x) const
+        {
+            _in.resize(_n);
+            for (size_t j = 0; j < _n; ++j) _ring.convert(_in[j], x[j]);
+        }
+
+        /// Double (or RNS) images of A X for the c columns stored in _in.
+        void multiply(size_t c) const
+        {
+            Givaro::ZRing<double> D;
+
+            switch (_strategy) {
+            case Strategy::MatrixQadic: {
+                _xd.resize(_n * c);
+                for (size_t j = 0; j < _n * c; ++j) _xd[j] = static_cast<double>(_in[j]);
+                _w.resize(_matrixNumChunks * _m * c);
+                tiledProduct(D, _matrixNumChunks * _m, c, _n, _chunks.data(), _xd.data(), _w.data());
+            } break;
+
+            case Strategy::VectorQadic: {
+                const size_t k = _vectorNumChunks;
+                _xd.resize(_n * c * k);
+                for (size_t j = 0; j < _n * c; ++j) split(_xd.data() + j * k, 1, _in[j], _vectorChunkBits, k);
+                _w.resize(_m * c * k);
+                tiledProduct(D, _m, c * k, _n, _chunks.data(), _xd.data(), _w.data());
+            } break;
+
+            case Strategy::RNS: {
+                const size_t r = _rns->size();
+                const size_t nc = _n * c, mc = _m * c;
+                _rnsX.resize(r * nc);
+                _rns->reduce(_rnsX.data(), _in.data(), c, _n, c, _maxX);
+                _rnsW.resize(r * mc);
+
+                const size_t tiles = tileCount(_m);
+                const size_t step = (_m + tiles - 1) / tiles;
+                _pool.parallelFor(0, r * tiles, 1, [&](size_t task) {
+                    const size_t l = task / tiles;
+                    const size_t begin = (task % tiles) * step;
+                    const size_t end = std::min(_m, begin + step);
+                    if (begin >= end) return;
+                    Givaro::Modular<double> F(_rns->prime(l));
+                    product(F, end - begin, c, _n, _rnsA.data() + l * _m * _n + begin * _n, _rnsX.data() + l * nc,
+                            _rnsW.data() + l * mc + begin * c);
+                });
+
+                _out.resize(mc);
+                _rns->reconstruct(_out.data(), _rnsW.data(), _m, c);
+            } break;
+
+            default: break;
+            }
+        }
+
+        /// acc = entry (i, k) of A X from the chunked partial products, X having c columns.
+        void recombine(Integer& acc, size_t i, size_t k, size_t c) const
+        {
+            size_t s, numChunks, stride;
+            const double* w;
+            if (_strategy == Strategy::MatrixQadic) {
+                s = _matrixChunkBits;
+                numChunks = _matrixNumChunks;
+                stride = _m * c;
+                w = _w.data() + i * c + k;
+            }
+            else {
+                s = _vectorChunkBits;
+                numChunks = _vectorNumChunks;
+                stride = 1;
+                w = _w.data() + (i * c + k) * numChunks;
+            }
+
+            mpz_set_d(acc.get_mpz(), w[(numChunks - 1) * stride]);
+            for (size_t t = numChunks - 1; t-- > 0;) {
+                acc <<= static_cast<uint64_t>(s);
+                acc += static_cast<int64_t>(w[t * stride]);
+            }
+        }
+
+    private:
+        Ring _ring;
+        const IMatrix& _A;
+        MatrixDomain<Ring> _MD;
+        TaskPool& _pool;
+        size_t _m;
+        size_t _n;
+
+        Integer _maxA;
+        Integer _maxX;
+        Strategy _strategy = Strategy::Classic;
+
+        // Qadic data
+        size_t _matrixChunkBits = 0;
+        size_t _matrixNumChunks = 0;
+        size_t _vectorChunkBits = 0;
+        size_t _vectorNumChunks = 0;
+        std::vector<double> _chunks; //!< Stacked chunks of A (MatrixQadic) or A itself (VectorQadic).
+
+        // RNS data
+        std::unique_ptr<IntegerRNS> _rns;
+        std::vector<double> _rnsA;
+
+        // Scratch buffers, reused from one product to the next.
+        mutable std::vector<Integer> _in;
+        mutable std::vector<Integer> _out;
+        mutable std::vector<double> _xd;
+        mutable std::vector<double> _w;
+        mutable std::vector<double> _rnsX;
+        mutable std::vector<double> _rnsW;
+    };
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file algorithms/integer-rns.h
+ * @ingroup algorithms
+ * @brief Residues of integer matrices modulo word-size primes, and back by Chinese remaindering.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <givaro/givintprime.h>
+#include <givaro/modular.h>
+
+#include <fflas-ffpack/field/rns-double.h>
+
+#include "linbox/integer.h"
+#include "linbox/linbox-config.h"
+#include "linbox/util/task-pool.h"
+
+namespace LinBox {
+
+    /**
+     * \brief Conversions of integer matrices to and from a residue number system of
+     * word-size primes (FFPACK::rns_double), row by row on a TaskPool.
+     *
+     * The primes p satisfy k (p - 1)^2 < 2^53, so that the dot products of length k
+     * of their residues are exact in double precision: one fgemm (fgemv) per prime then
+     * gives the residues of a product with inner dimension k.
+     *
+     * The residues of a rows x cols matrix are stored prime by prime, each one row major:
+     * the residue of entry (i, j) modulo p_l is at l rows cols + i cols + j.
+     */
+    class IntegerRNS {
+    public:
+        IntegerRNS(const std::vector<double>& basis, TaskPool& pool = TaskPool::current())
+            : _rns(basis)
+            , _pool(pool)
+            , _halfModulus(_rns._M >> 1)
+        {
+#ifdef __LINBOX_HAVE_BIG_ENDIAN
+            // rns_double reads the GMP limbs as 16-bit words, CRT is done by hand.
+            _crtCoefficients.resize(basis.size());
+            for (size_t l = 0; l < basis.size(); ++l) {
+                Integer pl(static_cast<uint64_t>(basis[l])), Ml = _rns._M / pl, inv;
+                Givaro::inv(inv, Ml % pl, pl);
+                _crtCoefficients[l] = Ml * inv;
+            }
+#endif
+        }
+
+        /// Number of primes.
+        size_t size() const { return _rns._size; }
+
+        /// The l-th prime.
+        double prime(size_t l) const { return _rns._basis[l]; }
+
+        /// Largest prime candidate p with k (p - 1)^2 < 2^53, 0 if too small to be useful.
+        static uint64_t primeMax(size_t k)
+        {
+            const uint64_t p = std::min(uint64_t(std::sqrt(double(1ULL << 53) / double(std::max<size_t>(k, 1)))),
+                                        uint64_t(Givaro::Modular<double>::maxCardinality()));
+            return (p < (1u << 10)) ? 0 : p;
+        }
+
+        /// Largest primes below primeMax(k) whose product exceeds bound, none if primeMax(k) is 0.
+        static void basis(std::vector<double>& primes, size_t k, const Integer& bound)
+        {
+            primes.clear();
+            const uint64_t pMax = primeMax(k);
+            if (pMax == 0) return;
+            Givaro::IntPrimeDom IPD;
+            Integer q(pMax + 1), M(1);
+            while (M <= bound) {
+                IPD.prevprimein(q);
+                primes.push_back(static_cast<double>(q));
+                M *= q;
+            }
+        }
+
+        /// residues = X mod each prime, X rows x cols with leading dimension ldx and |X| <= maxX.
+        void reduce(double* residues, const Integer* X, size_t ldx, size_t rows, size_t cols, const Integer& maxX) const
+        {
+            const size_t N = rows * cols;
+            _pool.parallelFor(0, rows, 0, [&](size_t i) {
+#ifndef __LINBOX_HAVE_BIG_ENDIAN
+                _rns.init(1, cols, residues + i * cols, N, X + i * ldx, cols, maxX);
+#else
+                for (size_t l = 0; l < _rns._size; ++l) {
+                    Givaro::Modular<double> F(_rns._basis[l]);
+                    for (size_t j = 0; j < cols; ++j) F.init(residues[l * N + i * cols + j], X[i * ldx + j]);
+                }
+#endif
+            });
+        }
+
+        /// P = the rows x cols integers of residues, in the symmetric range, P row major.
+        void reconstruct(Integer* P, const double* residues, size_t rows, size_t cols) const
+        {
+            const size_t N = rows * cols;
+            const Integer& M = _rns._M;
+            _pool.parallelFor(0, rows, 0, [&](size_t i) {
+                Integer* row = P + i * cols;
+#ifndef __LINBOX_HAVE_BIG_ENDIAN
+                _rns.convert(1, cols, Integer(0), row, cols, residues + i * cols, N);
+#else
+                Integer tmp;
+                for (size_t j = 0; j < cols; ++j) {
+                    row[j] = 0;
+                    for (size_t l = 0; l < _rns._size; ++l) {
+                        tmp = _crtCoefficients[l];
+                        tmp *= static_cast<int64_t>(residues[l * N + i * cols + j]);
+                        row[j] += tmp;
+                    }
+                }
+#endif
+                for (size_t j = 0; j < cols; ++j) {
+                    Integer& p = row[j];
+                    p %= M;
+                    if (p < 0) p += M;
+                    if (p > _halfModulus) p -= M;
+                }
+            });
+        }
+
+    private:
+        const FFPACK::rns_double _rns;
+        TaskPool& _pool;
+        const Integer _halfModulus;
+        std::vector<Integer> _crtCoefficients;
+    };
+}
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
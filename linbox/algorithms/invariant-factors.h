@@ -25,7 +25,9 @@
 #ifndef __LINBOX_invariant_factors_H
 #define __LINBOX_invariant_factors_H
 
+#include <algorithm>
 #include <list>
+#include <type_traits>
 #include <vector>
 #include <math.h> 
 
@@ -34,12 +36,17 @@
 #include "linbox/matrix/random-matrix.h"
 
 #include "linbox/blackbox/block-compose.h"
+#include "linbox/blackbox/blockbb.h"
 #include "linbox/blackbox/fflas-csr.h"
 
 #include "linbox/algorithms/block-coppersmith-domain.h"
 #include "linbox/algorithms/block-massey-domain.h"
 #include "linbox/algorithms/blackbox-block-container.h"
 #include "linbox/algorithms/poly-smith-form.h"
+#include "linbox/matrix/polynomial-matrix.h"
+#include "linbox/util/commentator.h"
+#include "linbox/util/task-pool.h"
+#include "linbox/util/timer.h"
 
 namespace LinBox
 {
@@ -58,15 +65,48 @@ public:
 	typedef typename MatrixDomain<PolynomialRing>::OwnMatrix PolyMatrix;
 	
 	typedef PolySmithFormDomain<PolynomialRing> SmithFormDom;
+
+	typedef BlasMatrix<Field> Block;
+
+	/// Wall clock times, in seconds, of the phases of the last tunedLargestInvariantFactors.
+	struct PhaseTimings {
+		size_t blockSize = 0;
+		double tuning = 0.0;
+		double sequence = 0.0;  //!< U A^i V, with the blackbox applied to blocks.
+		double generator = 0.0; //!< Sigma basis by PM_Basis.
+		double smith = 0.0;     //!< Determinant and Smith form of the generator.
+	};
+
+	/// The block sequence U A^i V once computed, as read by BlockMasseyDomain.
+	class StoredBlockSequence {
+	public:
+		typedef Block Value;
+		typedef typename std::vector<Block>::const_iterator const_iterator;
+
+		StoredBlockSequence(const Field &F, const std::vector<Block> &seq) : _field(&F), _seq(&seq) {}
+
+		const Field &field() const { return *_field; }
+		size_t size() const { return _seq->size(); }
+		size_t rowdim() const { return _seq->front().rowdim(); }
+		size_t coldim() const { return _seq->front().coldim(); }
+		const_iterator begin() const { return _seq->begin(); }
+
+	private:
+		const Field *_field;
+		const std::vector<Block> *_seq;
+	};
 		
 protected:
 	Field _F;
 	PolynomialRing _R;
 	SmithFormDom _SFD;
+	mutable PhaseTimings _timings;
 	
 public:
 	InvariantFactors(const Field &F, const PolynomialRing &R) : _F(F), _R(R), _SFD(R) {}
 
+	const PhaseTimings &timings() const { return _timings; }
+
 public:
 	size_t min_block_size(size_t t, double p) const {
 		size_t q = _F.cardinality();
@@ -125,7 +165,159 @@ public:
 		coppersmith.left_minpoly(gen);
 	}
 	
-	void convert(PolyMatrix &G, const std::vector<Matrix> &minpoly) const {
+	/// Length of the block sequence for block size b, as in BlackboxBlockContainer.
+	size_t sequenceLength(size_t n, size_t b) const {
+		return 2 * std::max(n / b, size_t(1)) + __BW_EXTRA_STEPS;
+	}
+
+	// Y = M X. Block blackboxes use their own (possibly threaded) applyLeft,
+	// the others are applied to the columns of X in parallel.
+	template<class Blackbox>
+	typename std::enable_if<is_blockbb<Blackbox>::value>::type
+	applyBlock(Block &Y, const Blackbox &M, const Block &X) const {
+		M.applyLeft(Y, X);
+	}
+
+	template<class Blackbox>
+	typename std::enable_if<!is_blockbb<Blackbox>::value>::type
+	applyBlock(Block &Y, const Blackbox &M, const Block &X) const {
+		TaskPool::current().parallelFor(0, X.coldim(), 1, [&](size_t j) {
+			BlasVector<Field> x(_F, X.rowdim()), y(_F, Y.rowdim());
+			for (size_t i = 0; i < X.rowdim(); i++) {
+				_F.assign(x[i], X.getEntry(i, j));
+			}
+			M.apply(y, x);
+			for (size_t i = 0; i < Y.rowdim(); i++) {
+				Y.setEntry(i, j, y[i]);
+			}
+		});
+	}
+
+	/// seq[i] = U M^i V, for i < length.
+	template<class Blackbox>
+	void computeSequence(
+		std::vector<Block> &seq,
+		const Blackbox &M,
+		const Block &U,
+		const Block &V,
+		size_t length) const
+	{
+		BlasMatrixDomain<Field> BMD(_F);
+		std::vector<Block> krylov(2, V);
+		size_t current = 0;
+
+		seq.assign(length, Block(_F, U.rowdim(), V.coldim()));
+		for (size_t i = 0; i < length; i++) {
+			if (i > 0) {
+				applyBlock(krylov[1 - current], M, krylov[current]);
+				current = 1 - current;
+			}
+			BMD.mul(seq[i], U, krylov[current]);
+		}
+	}
+
+	/// Left generator of the sequence, by the FFT based sigma basis of BlockMasseyDomain.
+	void generatorFromSequence(std::vector<Block> &gen, const std::vector<Block> &seq) const {
+		StoredBlockSequence S(_F, seq);
+		BlockMasseyDomain<Field, StoredBlockSequence> BMD(&S);
+		BMD.left_minpoly_rec(gen);
+	}
+
+	/// Estimated time of the sequence for block size b, from one timed step.
+	template<class Blackbox>
+	double sequenceCost(const Blackbox &M, size_t b) const {
+		RandIter RI(_F);
+		RandomDenseMatrix<RandIter, Field> RDM(_F, RI);
+		BlasMatrixDomain<Field> BMD(_F);
+
+		size_t n = M.rowdim();
+		Block U(_F, b, n), X(_F, n, b), Y(_F, n, b), S(_F, b, b);
+		RDM.random(U);
+		RDM.random(X);
+
+		Timer chrono;
+		chrono.clear();
+		chrono.start();
+		applyBlock(Y, M, X);
+		BMD.mul(S, U, Y);
+		chrono.stop();
+
+		return chrono.realtime() * sequenceLength(n, b);
+	}
+
+	/**
+	 * Estimated time of PM_Basis on a 2b x b series of the given length.
+	 * A short series is timed, then extrapolated as length log^2(length),
+	 * the cost of the FFT based sigma basis.
+	 */
+	double generatorCost(size_t b, size_t length) const {
+		typedef PolynomialMatrix<PMType::polfirst, PMStorage::plain, Field> PMatrix;
+		const size_t sampleLength = std::min(length, size_t(32));
+
+		RandIter RI(_F);
+		PMatrix serie(_F, 2 * b, b, sampleLength), sigma(_F, 2 * b, 2 * b, sampleLength);
+		for (size_t k = 0; k < sampleLength; k++) {
+			for (size_t i = 0; i < b; i++) {
+				for (size_t j = 0; j < b; j++) {
+					RI.random(serie.ref(i, j, k));
+				}
+			}
+		}
+		for (size_t j = 0; j < b; j++) {
+			_F.assign(serie.ref(b + j, j, 0), _F.one);
+		}
+		std::vector<size_t> shift(2 * b, 0);
+		std::fill(shift.begin() + b, shift.end(), 1);
+
+		OrderBasis<Field> SB(_F);
+		Timer chrono;
+		chrono.clear();
+		chrono.start();
+		SB.PM_Basis(sigma, serie, sampleLength, shift);
+		chrono.stop();
+
+		double ratio = std::max(log2((double)length), 1.0) / std::max(log2((double)sampleLength), 1.0);
+		return chrono.realtime() * length / sampleLength * ratio * ratio;
+	}
+
+	/**
+	 * Block size in [bmin, bmax] minimizing the estimated sequence and generator times.
+	 * Larger blocks shorten the sequence and keep more threads busy in the applies,
+	 * but the generator costs about b^3 times the length.
+	 * The candidates are bmin, 2 bmin, ..., bmax; bmax = 0 stands for 4 times the number of threads.
+	 * bmin is never lowered (but to the dimension of M): bmax is raised to bmin if needed.
+	 */
+	template<class Blackbox>
+	size_t tuneBlockSize(const Blackbox &M, size_t bmin, size_t bmax = 0) const {
+		size_t n = M.rowdim();
+		if (bmax == 0) {
+			bmax = 4 * TaskPool::current().numThreads();
+		}
+		bmin = std::min(std::max(bmin, size_t(1)), std::max(n, size_t(1)));
+		bmax = std::max(std::min(bmax, n), bmin);
+
+		size_t best = bmin;
+		double bestCost = -1.0;
+		for (size_t b = bmin;; b = std::min(2 * b, bmax)) {
+			double seqCost = sequenceCost(M, b);
+			double genCost = generatorCost(b, sequenceLength(n, b));
+			commentator().report(Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
+				<< "block size " << b << ": sequence " << seqCost << "s, generator " << genCost << "s (estimated)" << std::endl;
+
+			if (bestCost < 0 || seqCost + genCost < bestCost) {
+				best = b;
+				bestCost = seqCost + genCost;
+			}
+			if (b == bmax) {
+				break;
+			}
+		}
+
+		return best;
+	}
+
+	template<class Coefficient>
+	void convert(PolyMatrix &G, const std::vector<Coefficient> &minpoly) const {
 		size_t b = G.rowdim();
 		for (size_t i = 0; i < b; i++) {
 			for (size_t j = 0; j < b; j++) {
@@ -228,6 +420,69 @@ public:
 		return lifs;
 	}
 	
+	/**
+	 * Largest invariant factors with the block size chosen by tuneBlockSize(A, bmin, bmax),
+	 * e.g. with bmin = min_block_size(t, p).
+	 * The sequence is computed beforehand with the blackbox applied to whole blocks,
+	 * and its generator by PM_Basis. The time of each phase is kept in timings().
+	 */
+	template<class Blackbox>
+	std::vector<Polynomial> &tunedLargestInvariantFactors(
+		std::vector<Polynomial> &lifs,
+		const Blackbox &A,
+		size_t bmin,
+		size_t bmax = 0) const
+	{
+		Timer chrono;
+		_timings = PhaseTimings();
+
+		chrono.clear();
+		chrono.start();
+		size_t b = tuneBlockSize(A, bmin, bmax);
+		chrono.stop();
+		_timings.blockSize = b;
+		_timings.tuning = chrono.realtime();
+
+		RandIter RI(_F);
+		RandomDenseMatrix<RandIter, Field> RDM(_F, RI);
+		size_t n = A.rowdim();
+		Block U(_F, b, n);
+		Block V(_F, n, b);
+		RDM.random(U);
+		RDM.random(V);
+
+		std::vector<Block> seq;
+		chrono.clear();
+		chrono.start();
+		computeSequence(seq, A, U, V, sequenceLength(n, b));
+		chrono.stop();
+		_timings.sequence = chrono.realtime();
+
+		std::vector<Block> minpoly;
+		chrono.clear();
+		chrono.start();
+		generatorFromSequence(minpoly, seq);
+		chrono.stop();
+		_timings.generator = chrono.realtime();
+
+		chrono.clear();
+		chrono.start();
+		PolyMatrix G(_R, b, b);
+		convert(G, minpoly);
+
+		Polynomial det;
+		_SFD.detLocalX(det, G);
+		_SFD.solve(lifs, G, det);
+		chrono.stop();
+		_timings.smith = chrono.realtime();
+
+		commentator().report(Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
+			<< "block size " << b << ": tuning " << _timings.tuning << "s, sequence " << _timings.sequence
+			<< "s, generator " << _timings.generator << "s, smith form " << _timings.smith << "s" << std::endl;
+
+		return lifs;
+	}
+
 	template<class Blackbox>
 	std::vector<Polynomial> &lifsit(
 		std::vector<Polynomial> &lifs,
@@ -52,6 +52,9 @@
 #include "linbox/matrix/transpose-matrix.h"
 #include "linbox/blackbox/transpose.h"
 #include "linbox/solutions/hadamard-bound.h"
+#include "linbox/util/serialization.h"
+#include "linbox/util/tracer.h"
+#include "linbox/vector/fixed-precision-vector.h"
 //#include "linbox/algorithms/vector-hom.h"
 
 namespace LinBox
@@ -79,7 +82,35 @@ namespace LinBox
 
 	};
 
-	template< class _Ring, class _IMatrix>
+	/// res_p = residu mod p, for the residual representations of LiftingContainerBase.
+	template <class Field, class FVector, class Ring>
+	FVector& reduceResidue(const Field& F, FVector& res_p, const BlasVector<Ring>& residu)
+	{
+		Hom<Ring, Field> hom(residu.field(), F);
+		for (size_t i = 0; i < residu.size(); ++i)
+			hom.image(res_p[i], residu[i]);
+		return res_p;
+	}
+
+	template <class Field, class FVector>
+	FVector& reduceResidue(const Field& F, FVector& res_p, const FixedPrecisionVector& residu)
+	{
+		integer p;
+		mp_limb_t q = FixedPrecisionVector::toLimb(F.characteristic(p));
+		const mp_limb_t shift = residu.powerOfBase(q);
+		for (size_t i = 0; i < residu.size(); ++i)
+			F.init(res_p[i], uint64_t(residu.mod(i, q, shift)));
+		return res_p;
+	}
+
+	/** \brief Common part of the p-adic lifting containers.
+	 *
+	 * The residual (b - A x) / p^i is kept in a _Residue:
+	 * either a BlasVector over the ring, or a FixedPrecisionVector
+	 * whose limb storage avoids any allocation during the lifting
+	 * (the prime must then fit in a machine word).
+	 */
+	template< class _Ring, class _IMatrix, class _Residue = BlasVector<_Ring> >
 	class LiftingContainerBase : public LiftingContainer< _Ring> {
 
 	public:
@@ -87,6 +118,7 @@ namespace LinBox
 		typedef _Ring                        Ring;
 		typedef typename _Ring::Element   Integer_t;
 		typedef BlasVector<_Ring>      IVector;
+		typedef _Residue               Residue;
 #ifdef RSTIMING
 		mutable Timer ttSetup, tRingApply, tRingOther, ttRingOther, ttRingApply;
 #endif
@@ -185,11 +217,11 @@ namespace LinBox
 #endif
 		}
 
-		virtual IVector& nextdigit (IVector& , const IVector&) const = 0;
+		virtual IVector& nextdigit (IVector& , const Residue&) const = 0;
 
 		class const_iterator {
 		private:
-			BlasVector<Ring>              _res;
+			Residue                       _res;
 			const LiftingContainerBase    &_lc;
 			size_t                   _position;
 		public:
@@ -208,6 +240,7 @@ namespace LinBox
 				linbox_check (digit.size() == _lc._matA.coldim());
 #endif
 				// compute next p-adic digit
+				LINBOX_TRACE_COUNT (LiftingDigits, 1);
 				_lc.nextdigit(digit,_res);
 #ifdef RSTIMING
 				_lc.tRingApply.start();
@@ -222,42 +255,22 @@ namespace LinBox
 					std::cout<<digit[i]<<",";
 				std::cout<<"\n";
 #endif
-				/*  prepare for updating residu */
-
-				// compute v2 = _matA * digit
-				IVector v2 (_lc.ring(),_lc._matA.rowdim());
-				_lc._MAD.applyV(v2,digit, _res);
-
-#ifdef DEBUG_LC
-
-				//_matA.write(std::cout<<"\n _matA :\n");
-				std::cout<<"\n A * digit "<<_position<<": ";
-				for (size_t i=0;i<v2.size();++i)
-					std::cout<<v2[i]<<",";
-
+				// update _res = (_res - _matA * digit) / p, without temporary vector
+#ifdef LC_CHECK_DIVISION
+				if (! _lc._MAD.residualUpdate(_res, digit, _lc._p, true)) {
+					std::cout<<"residue not divisible by modulus "<<_lc._p<<std::endl;
+					return false;
+				}
+#else
+				_lc._MAD.residualUpdate(_res, digit, _lc._p);
 #endif
+
 #ifdef RSTIMING
 				_lc.tRingApply.stop();
 				_lc.ttRingApply += _lc.tRingApply;
 				_lc.tRingOther.start();
 #endif
 
-				// update _res -= v2
-				_lc._VDR.subin (_res, v2);
-				typename BlasVector<Ring>::iterator p0;
-				// update _res = _res / p
-				int index=0;
-				for ( p0 = _res.begin(); p0 != _res.end(); ++ p0, ++index){
-#ifdef LC_CHECK_DIVISION
-					if (! _lc._intRing.isDivisor(*p0,_lc._p)) {
-						std::cout<<"residue "<<*p0<<" not divisible by modulus "<<_lc._p<<std::endl;
-						std::cout<<"residue "<<*p0<<" not divisible by modulus "<<_lc._p<<std::endl;
-						return false;
-					}
-#endif
-					_lc._intRing.divin(*p0, _lc._p);
-				}
-
 				// increase position of the iterator
 				++_position;
 #ifdef RSTIMING
@@ -267,6 +280,38 @@ namespace LinBox
 				return true;
 			}
 
+			/// Number of digits computed so far.
+			size_t position() const
+			{
+				return _position;
+			}
+
+			/**
+			 * Appends the position and the residue to bytes, for a Checkpoint.
+			 */
+			uint64_t serialize(std::vector<uint8_t>& bytes) const
+			{
+				IVector residue(_lc._intRing, _res.size());
+				copyResidue(residue, _res);
+				uint64_t bytesWritten = LinBox::serialize(bytes, static_cast<uint64_t>(_position));
+				return bytesWritten + LinBox::serialize(bytes, residue);
+			}
+
+			/**
+			 * Restores the state saved by serialize(),
+			 * the next digit will be the one following the saved ones.
+			 */
+			uint64_t unserialize(const std::vector<uint8_t>& bytes, uint64_t offset = 0u)
+			{
+				uint64_t position;
+				IVector residue(_lc._intRing);
+				uint64_t bytesRead = LinBox::unserialize(position, bytes, offset);
+				bytesRead += LinBox::unserialize(residue, bytes, offset + bytesRead);
+				_position = position;
+				loadResidue(_res, residue);
+				return bytesRead;
+			}
+
 			bool operator != (const const_iterator& iterator) const
 			{
 				if ( &_lc != &iterator._lc) {
@@ -283,6 +328,11 @@ namespace LinBox
 				return _position == iterator._position;
 			}
 
+		private:
+			void copyResidue(IVector& v, const IVector& r) const { v = r; }
+			void copyResidue(IVector& v, const FixedPrecisionVector& r) const { r.store(_lc._intRing, v); }
+			void loadResidue(IVector& r, const IVector& v) const { r = v; }
+			void loadResidue(FixedPrecisionVector& r, const IVector& v) const { r.load(_lc._intRing, v); }
 		};
 
 		/*- @brief Bit manipulation function for possible use in optimization.
@@ -373,8 +423,8 @@ namespace LinBox
 	};
 
 	/// Dixon Lifting Container
-	template <class _Ring, class _Field, class _IMatrix, class _FMatrix>
-	class DixonLiftingContainer : public LiftingContainerBase< _Ring, _IMatrix> {
+	template <class _Ring, class _Field, class _IMatrix, class _FMatrix, class _Residue = BlasVector<_Ring> >
+	class DixonLiftingContainer : public LiftingContainerBase< _Ring, _IMatrix, _Residue> {
 
 	public:
 		typedef _Field                               Field;
@@ -385,6 +435,8 @@ namespace LinBox
 		typedef typename IMatrix::Element        Integer_t;
 		typedef BlasVector<Ring>                   IVector;
 		typedef BlasVector<Field>                  FVector;
+		typedef _Residue                           Residue;
+		typedef LiftingContainerBase<Ring,IMatrix,Residue> Base;
 
 	protected:
 
@@ -407,7 +459,7 @@ namespace LinBox
 				       const FMatrix&   Ap,
 				       const VectorIn&   b,
 				       const Prime_Type& p) :
-			LiftingContainerBase<Ring,IMatrix> (R,A,b,p), _Ap(Ap), _field(&F), _VDF(F),
+			Base (R,A,b,p), _Ap(Ap), _field(&F), _VDF(F),
 			_res_p(F,b.size()), _digit_p(F,A.coldim()), _BA(F)
 		{
 
@@ -430,7 +482,7 @@ namespace LinBox
 			Ap.write(std::cout << "Matrixmodp:=", Tag::FileFormat::Maple)
                                << ';' << std::endl;
 
-			LiftingContainerBase<Ring,IMatrix>::_matA.write(
+			Base::_matA.write(
                 std::cout << "MatrixLCBASE:=", Tag::FileFormat::Maple)
                           << ';' << std::endl;
 #endif
@@ -448,27 +500,14 @@ namespace LinBox
 
 	protected:
 
-		virtual IVector& nextdigit(IVector& digit, const IVector& residu) const
+		virtual IVector& nextdigit(IVector& digit, const Residue& residu) const
 		{
 			linbox_check(digit.size()==residu.size());
 #ifdef RSTIMING
 			tGetDigitConvert.start();
 #endif
-			LinBox::integer tmp;
-
-			Hom<Ring, Field> hom(this->_intRing, field());
 			// res_p =  residu mod p
-			//VectorHom::map (_res_p, residu, field(), this->_intRing);
-			{
-				// std::cout << digit.size() << std::endl;
-				typename FVector::iterator     iter_p = _res_p.begin();
-				typename IVector::const_iterator iter = residu.begin();
-				for ( ;iter != residu. end(); ++iter, ++iter_p) {
-					//field(). init (*iter_p, this->_intRing.convert(tmp,*iter));
-					hom.image(*iter_p, *iter);
-					// std::cout<<*iter_p<<"= "<< *iter<<" mod "<<this->_p<<"\n";
-				}
-			}
+			reduceResidue(field(), _res_p, residu);
 #ifdef RSTIMING
 			tGetDigitConvert.stop();
 			ttGetDigitConvert += tGetDigitConvert;
@@ -488,10 +527,10 @@ namespace LinBox
 			{
 				typename FVector::const_iterator iter_p = _digit_p.begin();
 				typename IVector::iterator iter = digit.begin();
+				integer tmp;
 
 				for ( ; iter_p!= _digit_p.end(); ++iter_p, ++iter)
-					//this->_intRing.init(*iter, field().convert(tmp,*iter_p));
-					hom.preimage(*iter, *iter_p);
+					this->_intRing.init(*iter, field().convert(tmp,*iter_p));
 			}
 
 #ifdef RSTIMING
@@ -504,8 +543,8 @@ namespace LinBox
 	}; // end of class DixonLiftingContainerBase
 
 	/// Wiedemann LiftingContianer.
-	template <class _Ring, class _Field, class _IMatrix, class _FMatrix, class _FPolynomial>
-	class WiedemannLiftingContainer : public LiftingContainerBase<_Ring, _IMatrix> {
+	template <class _Ring, class _Field, class _IMatrix, class _FMatrix, class _FPolynomial, class _Residue = BlasVector<_Ring> >
+	class WiedemannLiftingContainer : public LiftingContainerBase<_Ring, _IMatrix, _Residue> {
 
 	public:
 		typedef _Field                                     Field;
@@ -514,8 +553,9 @@ namespace LinBox
 		typedef _FMatrix                                 FMatrix;
 		typedef typename Field::Element                  Element;
 		typedef typename Ring::Element                   Integer_t;
-		typedef std::vector<Integer_t>                     IVector;
+		typedef BlasVector<Ring>                         IVector;
 		typedef std::vector<Element>                     FVector;
+		typedef _Residue                                 Residue;
 		typedef _FPolynomial                         FPolynomial;
 		typedef typename FPolynomial::iterator     FPolyIterator;
 
@@ -542,7 +582,7 @@ namespace LinBox
 					   const FPolynomial& MinPoly,
 					   const VectorIn& b,
 					   const Prime_Type& p) :
-			LiftingContainerBase<Ring,IMatrix> (R,A,b,p), _Ap(Ap), _MinPoly(MinPoly), _field(&F), _VDF(F), _res_p(b.size()), _digit_p(A.coldim()), _rand(F)
+			LiftingContainerBase<Ring,IMatrix,Residue> (R,A,b,p), _Ap(Ap), _MinPoly(MinPoly), _field(&F), _VDF(F), _res_p(b.size()), _digit_p(A.coldim()), _rand(F)
 		{
 
 			// Normalize the minimal polynomial as f(x)=1- a1/a0 x - a2/a0 x^2 - ...
@@ -567,7 +607,7 @@ namespace LinBox
 
 	protected:
 
-		virtual IVector& nextdigit(IVector& digit,const IVector& residu) const
+		virtual IVector& nextdigit(IVector& digit,const Residue& residu) const
 		{
 
 			LinBox::integer tmp;
@@ -575,12 +615,7 @@ namespace LinBox
 			tGetDigitConvert.start();
 #endif
 			// res_p =  residu mod p
-			{
-				typename FVector::iterator iter_p = _res_p.begin();
-				typename IVector::const_iterator iter = residu.begin();
-				for ( ;iter != residu. end(); ++iter, ++iter_p)
-					field(). init (*iter_p, this->_intRing.convert(tmp,*iter));
-			}
+			reduceResidue(field(), _res_p, residu);
 #ifdef RSTIMING
 			tGetDigitConvert.stop();
 			ttGetDigitConvert+=tGetDigitConvert;
@@ -47,12 +47,21 @@
 // Time-stamp: <27 Aug 01 18:18:12 Jean-Guillaume.Dumas@imag.fr>
 // =======================================================================
 
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#include <givaro/givpoly1.h>
+
+#include "linbox/algorithms/polynomial-matrix/order-basis.h"
 #include "linbox/solutions/methods.h"
 #include "linbox/util/commentator.h"
 #include "linbox/vector/reverse.h"
 #include "linbox/vector/subvector.h"
 #include "linbox/vector/vector-domain.h"
+#include "linbox/util/task-pool.h"
 #include "linbox/util/timer.h"
+#include "linbox/util/tracer.h"
 
 namespace LinBox
 {
@@ -63,10 +72,24 @@ namespace LinBox
 
 #ifndef DEFAULT_ADDITIONAL_ITERATION
 #define DEFAULT_ADDITIONAL_ITERATION 2
+#endif
+
+// Sequences of at least this many terms use the fast Berlekamp/Massey, when available
+#ifndef LINBOX_MASSEY_FAST_THRESHOLD
+#define LINBOX_MASSEY_FAST_THRESHOLD 1024
 #endif
 
 	const long _DEGINFTY_ = -1;
 
+	/** Whether OrderBasis can compute generators over Field,
+	 * i.e. polynomial matrices over Field are multiplied by FFT.
+	 */
+	template<class Field>
+	struct MasseyHasFastGenerator : std::false_type {};
+
+	template<class T1, class T2>
+	struct MasseyHasFastGenerator<Givaro::Modular<T1, T2> > : std::true_type {};
+
 	/** \brief Berlekamp/Massey algorithm.
 
 	  Domain Massey
@@ -76,6 +99,9 @@ namespace LinBox
 	  2 additional iterations are needed to compute it
 	  (parameter DEFAULT_ADDITIONAL_ITERATION), but those
 	  iterations are not needed for the rank
+	  - Above LINBOX_MASSEY_FAST_THRESHOLD terms, over word-size prime fields,
+	  the generator is computed by a fast Pade approximation (OrderBasis::PM_Basis)
+	  on chunks of the sequence of increasing length, instead of term by term
 	  */
 	template<class Field, class Sequence>
 	class MasseyDomain {
@@ -84,6 +110,8 @@ namespace LinBox
 		const Field                *_field;
 		VectorDomain<Field>  _VD;
 		size_t         EARLY_TERM_THRESHOLD;
+		size_t               _fastThreshold = LINBOX_MASSEY_FAST_THRESHOLD;
+		bool                     _reporting = true;
 
 #ifdef INCLUDE_TIMING
 		// Timings
@@ -139,6 +167,12 @@ namespace LinBox
 		const Field &getField    () const { return *_field; } // deprecated
 		Sequence    *getSequence () const { return _container; }
 
+		/// Sequences of at least threshold terms use the fast algorithm (when available).
+		void setFastThreshold (size_t threshold) { _fastThreshold = threshold; }
+
+		/// Whether massey() reports to the commentator, which is not thread safe.
+		void setReporting (bool reporting) { _reporting = reporting; }
+
 #ifdef INCLUDE_TIMING
 		double       discrepencyTime () const { return _discrepencyTime; }
 		double       fixTime         () const { return _fixTime; }
@@ -193,15 +227,145 @@ namespace LinBox
 			return _DEGINFTY_ ;
 		}
 
+		template<class Polynomial>
+		long massey (Polynomial &C, bool full_poly = false)
+		{
+			const size_t END = _container->size () + (full_poly ? DEFAULT_ADDITIONAL_ITERATION:0);
+			if (END >= _fastThreshold)
+				return fast_massey (C, full_poly, typename MasseyHasFastGenerator<Field>::type ());
+			return classic_massey (C, full_poly);
+		}
+
+		// -------------------------------------------------------------------
+		// Fast Berlekamp/Massey
+		// The sequence S is read in chunks of doubling length N.
+		// The generator of the N first terms comes from a minimal approximant basis
+		// of [S, 1] at order N, the row with the lowest degree gives C and L.
+		// It is then checked on the following terms, one discrepancy each,
+		// until EARLY_TERM_THRESHOLD of them vanish or a new chunk is needed.
+		// -------------------------------------------------------------------
+
+		template<class Polynomial>
+		long fast_massey (Polynomial &C, bool full_poly, std::false_type)
+		{
+			return classic_massey (C, full_poly);
+		}
+
+		template<class Polynomial>
+		long fast_massey (Polynomial &C, bool full_poly, std::true_type)
+		{
+			LINBOX_TRACE_SPAN ("fast massey");
+			const size_t END = _container->size () + (full_poly ? DEFAULT_ADDITIONAL_ITERATION:0);
+
+			if (_reporting) commentator().start ("Fast Massey", "fmasseyd", (unsigned int)END);
+
+			typename Sequence::const_iterator _iter (_container->begin ());
+			std::vector<Element> S;
+			S.reserve (END);
+			auto readTerm = [&]() {
+				if (!S.empty ()) ++_iter;
+				S.push_back (*_iter);
+			};
+
+			size_t N = std::min (END, (size_t)(2 * EARLY_TERM_THRESHOLD + MBASIS_THRESHOLD));
+			long L;
+			while (true) {
+				while (S.size () < N) readTerm ();
+				if (_reporting) commentator().progress ((long)N);
+
+				L = generator (C, S, N);
+				if (N == END) break;
+
+				// Terms after the 2L first ones already checked by the approximation
+				size_t verified = (N > 2 * (size_t)L) ? N - 2 * (size_t)L : 0;
+				bool stable = true;
+				while (verified < EARLY_TERM_THRESHOLD && S.size () < END) {
+					readTerm ();
+					if (!field().isZero (discrepancy (C, S, S.size () - 1))) {
+						stable = false;
+						break;
+					}
+					++verified;
+				}
+				if (stable) break;
+
+				// The linear complexity is now at least S.size() - L,
+				// and the chunks grow geometrically to keep the total cost quasi-linear
+				N = std::max (N + N / 2, 2 * (S.size () - (size_t)L) + EARLY_TERM_THRESHOLD);
+				N = std::min (END, std::max (N, S.size ()));
+			}
+
+			if (_reporting) commentator().stop ("done", NULL, "fmasseyd");
+
+			return L;
+		}
+
+		// Connection polynomial C (C[0] = 1) and linear complexity of the N first terms of S
+		template<class Polynomial>
+		long generator (Polynomial &C, const std::vector<Element> &S, size_t N)
+		{
+			typedef PolynomialMatrix<PMType::polfirst,PMStorage::plain,Field> PMatrix;
+
+			PMatrix serie (field(), 2, 1, N);
+			for (size_t k = 0; k < N; ++k)
+				field().assign (serie.ref (0, 0, k), S[k]);
+			field().assign (serie.ref (1, 0, 0), field().one);
+
+			std::vector<size_t> shift {0, 1};
+			PMatrix sigma (field(), 2, 2, N + 1);
+			OrderBasis<Field> SB (field());
+			SB.PM_Basis (sigma, serie, N, shift);
+
+			// Row [a, b] with a*S + b = 0 mod x^N, a(0) != 0,
+			// minimizing L = max(deg a, deg b + 1)
+			auto degree = [&](size_t i, size_t j) {
+				long d = (long)sigma.size () - 1;
+				while (d >= 0 && field().isZero (sigma.get (i, j, (size_t)d))) --d;
+				return d;
+			};
+			long L = -1;
+			size_t row = 0;
+			for (size_t i = 0; i < 2; ++i) {
+				if (field().isZero (sigma.get (i, 0, 0))) continue;
+				long l = std::max (degree (i, 0), degree (i, 1) + 1);
+				if (L < 0 || l < L) {
+					L = l;
+					row = i;
+				}
+			}
+			linbox_check (L >= 0);
+
+			const long c_deg = degree (row, 0);
+			Element a0;
+			field().inv (a0, sigma.get (row, 0, 0));
+			C.resize ((size_t)c_deg + 1);
+			for (long k = 0; k <= c_deg; ++k)
+				field().mul (C[(size_t)k], sigma.get (row, 0, (size_t)k), a0);
+
+			return L;
+		}
+
+		// sum_k C[k] S[j-k]
+		template<class Polynomial>
+		Element discrepancy (const Polynomial &C, const std::vector<Element> &S, size_t j)
+		{
+			Element d;
+			field().assign (d, field().zero);
+			for (size_t k = 0; k < C.size () && k <= j; ++k)
+				field().axpyin (d, C[k], S[j - k]);
+			return d;
+		}
+
 		// -------------------------------------------------------------------
 		// Berlekamp/Massey algorithm with Massey's Sequence generation
 		// -------------------------------------------------------------------
 
 		template<class Polynomial>
-		long massey (Polynomial &C, bool full_poly = false)
+		long classic_massey (Polynomial &C, bool full_poly = false)
 		{
 			//              const long ni = _container->n_row (), nj = _container->n_col ();
 			//              const long n = MIN(ni,nj);
+			LINBOX_TRACE_SPAN ("massey");
 			const long END = _container->size () + (full_poly ? DEFAULT_ADDITIONAL_ITERATION:0);
 			const long n = END >> 1;
 
@@ -213,7 +377,7 @@ namespace LinBox
 
 			integer card;
 
-			commentator().start ("Massey", "masseyd", (unsigned int)END);
+			if (_reporting) commentator().start ("Massey", "masseyd", (unsigned int)END);
 
 			// ====================================================
 			// Sequence and iterator initialization
@@ -242,7 +406,7 @@ namespace LinBox
 
 			for (long NN = 0; NN < END && x < (long) EARLY_TERM_THRESHOLD; ++NN, ++_iter) {
 
-				if (!(NN % COMMOD))
+				if (_reporting && !(NN % COMMOD))
 					commentator().progress (NN);
 
 				// ====================================================
@@ -346,7 +510,7 @@ namespace LinBox
 #endif // INCLUDE_TIMING
 			}
 
-			commentator().stop ("done", NULL, "masseyd");
+			if (_reporting) commentator().stop ("done", NULL, "masseyd");
 			//		commentator().stop ("Done", "Done", "LinBox::MasseyDomain::massey");
 
 			return L;
@@ -409,6 +573,148 @@ namespace LinBox
 
 	};
 
+	/** \brief Berlekamp/Massey on several projections of one Krylov sequence.
+
+	  The sequences u_j^T A^i v of a BlackboxMultiContainer share their applies.
+	  The terms are computed on a growing number of terms, and each generator
+	  is updated in parallel with the new terms only, from the state left by the
+	  previous ones (connection polynomials, discrepancy and linear complexity),
+	  until each of them terminates early as in MasseyDomain.
+	  The minimal polynomial is their LCM.
+	  */
+	template<class Field, class MultiSequence>
+	class MultiMasseyDomain {
+	private:
+		MultiSequence         *_container;
+		const Field               *_field;
+		size_t         EARLY_TERM_THRESHOLD;
+
+	public:
+		typedef typename Field::Element Element;
+
+	private:
+		// Berlekamp/Massey on the terms of one projection, fed as they are computed
+		struct Generator {
+			std::vector<Element> C;   // connection polynomial, C[0] = 1
+			std::vector<Element> B;   // C before the last change of L
+			Element b;                // discrepancy of that change
+			size_t L = 0;             // linear complexity
+			size_t x = 1;             // terms since that change, the early termination counter
+			size_t read = 0;          // terms processed
+			bool terminated = false;
+
+			Generator (const Field &F) : C (1, F.one), B (1, F.one), b (F.one) {}
+
+			// Processes the terms read..N-1 of projection j, stops when x reaches the threshold.
+			void feed (const Field &F, const MultiSequence &S, size_t j, size_t N, size_t threshold)
+			{
+				Element d, Ds;
+				for (; read < N && x < threshold; ++read) {
+					F.assign (d, F.zero);
+					for (size_t i = 0; i < C.size () && i <= read; ++i)
+						F.axpyin (d, C[i], S.term (j, read - i));
+
+					if (F.isZero (d)) {
+						++x;
+						continue;
+					}
+
+					// C = C - d/b X^x B
+					F.divin (F.neg (Ds, d), b);
+					const bool lengthChanges = (2 * L <= read);
+					std::vector<Element> T;
+					if (lengthChanges) T = C;
+					if (C.size () < B.size () + x) C.resize (B.size () + x, F.zero);
+					for (size_t i = 0; i < B.size (); ++i)
+						F.axpyin (C[i + x], Ds, B[i]);
+
+					if (lengthChanges) {
+						L = read + 1 - L;
+						B.swap (T);
+						F.assign (b, d);
+						x = 1;
+					}
+					else {
+						++x;
+					}
+				}
+				terminated = (x >= threshold);
+			}
+
+			// Monic generator of degree L, the reverse of C
+			void polynomial (const Field &F, BlasVector<Field> &g) const
+			{
+				g.resize (L + 1);
+				for (size_t i = 0; i <= L; ++i)
+					F.assign (g[i], (L - i < C.size ()) ? C[L - i] : F.zero);
+			}
+		};
+
+	public:
+		MultiMasseyDomain (MultiSequence *D, size_t ett_default = LINBOX_DEFAULT_EARLY_TERMINATION_THRESHOLD) :
+			_container           (D),
+			_field                   (&(D->field ())),
+			EARLY_TERM_THRESHOLD (ett_default)
+		{}
+
+		const Field &field    () const { return *_field; }
+		MultiSequence *getSequence () const { return _container; }
+
+		template<class Polynomial>
+		void minpoly (Polynomial &phi, size_t &rank, bool full_poly = true)
+		{
+			const size_t k = _container->numProjections ();
+			const size_t END = (size_t)_container->size () + (full_poly ? DEFAULT_ADDITIONAL_ITERATION:0);
+
+			commentator().start ("Multi-projection Massey", "mmasseyd", (unsigned int)END);
+
+			std::vector<Generator> states (k, Generator (field()));
+			size_t N = std::min (END, (size_t)(2 * EARLY_TERM_THRESHOLD + MBASIS_THRESHOLD));
+			while (true) {
+				// The applies are done here, the generators only read the terms
+				_container->extend (N);
+				commentator().progress ((long)N);
+
+				TaskPool::current().parallelFor (0, k, 1, [&](size_t j) {
+					if (!states[j].terminated)
+						states[j].feed (field(), *_container, j, N, EARLY_TERM_THRESHOLD);
+				});
+
+				if (N == END || std::all_of (states.begin (), states.end (), [](const Generator &g) { return g.terminated; }))
+					break;
+				N = std::min (END, 2 * N);
+			}
+
+			std::vector<BlasVector<Field> > generators (k, BlasVector<Field> (field()));
+			for (size_t j = 0; j < k; ++j) states[j].polynomial (field(), generators[j]);
+
+			// LCM of the monic generators
+			typedef Givaro::Poly1Dom<Field, Givaro::Dense> PolyDom;
+			PolyDom PD (field());
+			typename PolyDom::Element lcm, g, tmp;
+			PD.assign (lcm, PD.one);
+			for (size_t j = 0; j < k; ++j) {
+				g.resize (generators[j].size ());
+				std::copy (generators[j].begin (), generators[j].end (), g.begin ());
+				PD.lcm (tmp, lcm, g);
+				PD.assign (lcm, tmp);
+			}
+			while (lcm.size () > 1 && field().isZero (lcm.back ())) lcm.pop_back ();
+
+			Element lc;
+			field().inv (lc, lcm.back ());
+			phi.resize (lcm.size ());
+			for (size_t i = 0; i < lcm.size (); ++i)
+				field().mul (phi[i], lcm[i], lc);
+
+			size_t val = 0;
+			while (val + 1 < phi.size () && field().isZero (phi[val])) ++val;
+			rank = phi.size () - 1 - val;
+
+			commentator().stop ("done", NULL, "mmasseyd");
+		}
+	};
+
 }
 
 #endif // __LINBOX_massey_domain_H
@@ -0,0 +1,442 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file algorithms/matrix-blas3/mul-integer.h
+ * @ingroup blas3
+ * @brief Multiplication of integer matrices: classic, q-adic (Kronecker) splitting,
+ * multi-modular (RNS) or FLINT, chosen according to the sizes of the entries.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <givaro/modular.h>
+#include <givaro/zring.h>
+
+#include <fflas-ffpack/fflas/fflas.h>
+
+#include "linbox/algorithms/integer-rns.h"
+#include "linbox/integer.h"
+#include "linbox/linbox-config.h"
+#include "linbox/util/debug.h"
+#include "linbox/util/task-pool.h"
+#include "linbox/util/tracer.h"
+
+#ifdef __LINBOX_HAVE_FLINT
+namespace FLINT {
+    extern "C" {
+#define __GMP_BITS_PER_MP_LIMB GMP_LIMB_BITS
+#include "flint/flint.h"
+#include "flint/fmpz_mat.h"
+    }
+}
+#endif
+
+namespace LinBox {
+    namespace BLAS3 {
+
+        /**
+         * \brief C = beta C + alpha op(A) op(B) over the integers, with the interface of FFLAS::fgemm.
+         *
+         * The product op(A) op(B) is computed by one of:
+         * - Classic: GMP multiply-accumulate, for tiny inner dimensions or huge entries;
+         * - QAdic: A and B are split in chunks of sA and sB bits with k 2^(sA + sB) < 2^53,
+         *   the cA cB products of chunks are exact double fgemm and are recombined by shifts;
+         * - RNS: A and B are reduced modulo word-size primes p with k (p - 1)^2 < 2^53
+         *   (IntegerRNS), one fgemm per prime, then Chinese remaindering;
+         * - FLINT: fmpz_mat_mul, when LinBox is built with FLINT, instead of RNS when the
+         *   basis has more primes than the inner dimension: its remaindering is subquadratic.
+         *
+         * Strategy::Auto picks the cheapest one from the bit sizes of the entries and the
+         * dimensions, see cost(). The fgemm are split in row tiles, and primes or pairs of
+         * chunks, which run on a TaskPool, as do the reductions and recombinations.
+         *
+         * Every integer matrix product of BlasMatrixDomain< Givaro::ZRing<Integer> > goes here.
+         */
+        class IntegerMulDomain {
+        public:
+            enum class Strategy { Auto, Classic, QAdic, RNS, FLINT };
+
+            explicit IntegerMulDomain(TaskPool& pool = TaskPool::current())
+                : _pool(pool)
+            {
+            }
+
+            /// C = beta C + alpha op(A) op(B), op(A) m x k, op(B) k x n, row major; C may alias A or B.
+            Integer* fgemm(FFLAS::FFLAS_TRANSPOSE ta, FFLAS::FFLAS_TRANSPOSE tb, size_t m, size_t n, size_t k,
+                           const Integer& alpha, const Integer* A, size_t lda, const Integer* B, size_t ldb,
+                           const Integer& beta, Integer* C, size_t ldc, Strategy forced = Strategy::Auto)
+            {
+                if (m == 0 || n == 0) return C;
+                LINBOX_TRACE_SPAN("integer matmul");
+
+                const Operand opA(A, lda, ta == FFLAS::FflasTrans, m, k);
+                const Operand opB(B, ldb, tb == FFLAS::FflasTrans, k, n);
+                std::vector<Integer> P(m * n);
+
+                if (k > 0 && !isZero(alpha)) {
+                    const size_t bitsA = maxBits(opA), bitsB = maxBits(opB);
+                    _strategy = (forced == Strategy::Auto) ? choose(m, n, k, bitsA, bitsB) : forced;
+#ifndef __LINBOX_HAVE_FLINT
+                    if (_strategy == Strategy::FLINT) _strategy = Strategy::RNS;
+#endif
+                    if (_strategy == Strategy::QAdic && !qadicSplit(k, bitsA, bitsB).feasible())
+                        _strategy = Strategy::RNS;
+                    if (_strategy == Strategy::RNS && IntegerRNS::primeMax(k) == 0) _strategy = Strategy::Classic;
+
+                    switch (_strategy) {
+                    case Strategy::QAdic: qadic(P, opA, opB, m, n, k, bitsA, bitsB); break;
+                    case Strategy::RNS: rns(P, opA, opB, m, n, k, bitsA, bitsB); break;
+#ifdef __LINBOX_HAVE_FLINT
+                    case Strategy::FLINT: flint(P, opA, opB, m, n, k); break;
+#endif
+                    default: classic(P, opA, opB, m, n, k); break;
+                    }
+                }
+
+                // C = beta C + alpha P
+                _pool.parallelFor(0, m, 0, [&](size_t i) {
+                    for (size_t j = 0; j < n; ++j) {
+                        mpz_ptr c = C[i * ldc + j].get_mpz();
+                        mpz_ptr p = P[i * n + j].get_mpz();
+                        if (isZero(beta)) {
+                            if (isOne(alpha))
+                                mpz_swap(c, p);
+                            else
+                                mpz_mul(c, p, alpha.get_mpz_const());
+                        }
+                        else {
+                            if (!isOne(beta)) mpz_mul(c, c, beta.get_mpz_const());
+                            mpz_addmul(c, p, alpha.get_mpz_const());
+                        }
+                    }
+                });
+                return C;
+            }
+
+            /// Strategy of the last product.
+            Strategy strategy() const { return _strategy; }
+
+            /// Cheapest strategy for a product m x k by k x n, entries of at most bitsA and bitsB bits.
+            static Strategy choose(size_t m, size_t n, size_t k, size_t bitsA, size_t bitsB)
+            {
+                Strategy best = Strategy::Classic;
+                double bestCost = cost(Strategy::Classic, m, n, k, bitsA, bitsB);
+                for (Strategy s : {Strategy::QAdic, Strategy::RNS}) {
+                    const double c = cost(s, m, n, k, bitsA, bitsB);
+                    if (c < bestCost) {
+                        best = s;
+                        bestCost = c;
+                    }
+                }
+#ifdef __LINBOX_HAVE_FLINT
+                if (best == Strategy::RNS && numPrimes(k, bitsA, bitsB) > k) best = Strategy::FLINT;
+#endif
+                return best;
+            }
+
+            /**
+             * \brief Estimated cost, in double multiply-adds; infinite if the strategy does not apply.
+             * A GMP operation on l limbs costs about l of them, ClassicOverhead for a product.
+             */
+            static double cost(Strategy s, size_t m, size_t n, size_t k, size_t bitsA, size_t bitsB)
+            {
+                const double mnk = double(m) * double(n) * double(k);
+                const double limbsA = double(limbs(bitsA)), limbsB = double(limbs(bitsB));
+                const double limbsC = double(limbs(bitsA + bitsB + bitSize(k)));
+                switch (s) {
+                case Strategy::Classic: return ClassicOverhead * mnk * limbsA * limbsB;
+                case Strategy::QAdic: {
+                    const Split split = qadicSplit(k, bitsA, bitsB);
+                    if (!split.feasible()) return std::numeric_limits<double>::infinity();
+                    const double pairs = double(split.chunksA * split.chunksB);
+                    return pairs * (mnk + RecombineOverhead * double(m * n) * limbsC);
+                }
+                case Strategy::RNS: {
+                    if (IntegerRNS::primeMax(k) == 0) return std::numeric_limits<double>::infinity();
+                    const double r = double(numPrimes(k, bitsA, bitsB));
+                    return r * (mnk + RecombineOverhead * (double(m * k) * limbsA + double(k * n) * limbsB
+                                                           + double(m * n) * r));
+                }
+                default: return std::numeric_limits<double>::infinity();
+                }
+            }
+
+        private:
+            // Keep some margin below the 53 bits of mantissa of a double.
+            static constexpr size_t MantissaBits = 52;
+            static constexpr size_t MinTileRows = 32;
+            static constexpr double ClassicOverhead = 20.0;
+            static constexpr double RecombineOverhead = 8.0;
+
+            /// op(X), rows x cols, read from X with leading dimension ld.
+            struct Operand {
+                const Integer* data;
+                size_t ld;
+                bool trans;
+                size_t rows, cols;
+
+                Operand(const Integer* X, size_t ldX, bool t, size_t r, size_t c)
+                    : data(X), ld(ldX), trans(t), rows(r), cols(c)
+                {
+                }
+
+                /// Dimensions of X as stored.
+                size_t storedRows() const { return trans ? cols : rows; }
+                size_t storedCols() const { return trans ? rows : cols; }
+                const Integer& stored(size_t i, size_t j) const { return data[i * ld + j]; }
+                const Integer& operator()(size_t i, size_t j) const { return trans ? stored(j, i) : stored(i, j); }
+            };
+
+            /// Chunk sizes of the q-adic splitting.
+            struct Split {
+                size_t bitsA = 0, bitsB = 0;
+                size_t chunksA = 0, chunksB = 0;
+                bool feasible() const { return chunksA > 0; }
+            };
+
+            static bool isZero(const Integer& a) { return mpz_sgn(a.get_mpz_const()) == 0; }
+            static bool isOne(const Integer& a) { return mpz_cmp_ui(a.get_mpz_const(), 1) == 0; }
+
+            static size_t bitSize(size_t k)
+            {
+                size_t b = 0;
+                for (; k > 0; k >>= 1) ++b;
+                return b;
+            }
+
+            static size_t limbs(size_t bits) { return std::max<size_t>(1, (bits + 63) / 64); }
+
+            size_t maxBits(const Operand& X) const
+            {
+                const size_t rows = X.storedRows(), cols = X.storedCols();
+                std::vector<size_t> bits(rows, 0);
+                _pool.parallelFor(0, rows, 0, [&](size_t i) {
+                    for (size_t j = 0; j < cols; ++j) {
+                        mpz_srcptr z = X.stored(i, j).get_mpz_const();
+                        if (mpz_sgn(z) != 0) bits[i] = std::max(bits[i], mpz_sizeinbase(z, 2));
+                    }
+                });
+                return rows ? *std::max_element(bits.begin(), bits.end()) : 0;
+            }
+
+            /// sA + sB = 52 - bits(k), minimizing the number of pairs of chunks.
+            static Split qadicSplit(size_t k, size_t bitsA, size_t bitsB)
+            {
+                Split best;
+                const size_t bitsK = bitSize(k);
+                if (bitsK + 2 > MantissaBits) return best;
+                const size_t total = MantissaBits - bitsK;
+                for (size_t sA = 1; sA < total; ++sA) {
+                    const size_t sB = total - sA;
+                    const size_t cA = std::max<size_t>(1, (bitsA + sA - 1) / sA);
+                    const size_t cB = std::max<size_t>(1, (bitsB + sB - 1) / sB);
+                    if (!best.feasible() || cA * cB < best.chunksA * best.chunksB) {
+                        best.bitsA = std::min(sA, std::max<size_t>(bitsA, 1));
+                        best.bitsB = std::min(sB, std::max<size_t>(bitsB, 1));
+                        best.chunksA = cA;
+                        best.chunksB = cB;
+                    }
+                }
+                return best;
+            }
+
+            /// Primes of bits(primeMax) - 1 bits at least, whose product exceeds 2 k 2^bitsA 2^bitsB.
+            static size_t numPrimes(size_t k, size_t bitsA, size_t bitsB)
+            {
+                const size_t bitsP = bitSize(IntegerRNS::primeMax(k)) - 1;
+                return (bitsA + bitsB + bitSize(k) + 1) / bitsP + 1;
+            }
+
+            /// Row tiles of op(A), so that the fgemm of each prime or pair of chunks can be split.
+            size_t tileCount(size_t rows) const
+            {
+                return std::max<size_t>(1, std::min(_pool.numThreads(), rows / MinTileRows));
+            }
+
+            /// W = op(A) op(B) over F, rows [begin, end) of op(A), X and Y stored as A and B.
+            template <class Field>
+            static void product(const Field& F, const Operand& opA, const Operand& opB, size_t n, size_t k,
+                                const double* X, const double* Y, double* W, size_t begin, size_t end)
+            {
+                const size_t ldx = opA.storedCols(), ldy = opB.storedCols();
+                const double* Xb = opA.trans ? X + begin : X + begin * ldx;
+                FFLAS::fgemm(F, opA.trans ? FFLAS::FflasTrans : FFLAS::FflasNoTrans,
+                             opB.trans ? FFLAS::FflasTrans : FFLAS::FflasNoTrans, end - begin, n, k, F.one, Xb, ldx, Y,
+                             ldy, F.zero, W + begin * n, n);
+            }
+
+            /// Bits [offset, offset + len) of |z|, len < 64.
+            static uint64_t bitSlice(mpz_srcptr z, size_t offset, size_t len)
+            {
+                const size_t numbBits = GMP_NUMB_BITS;
+                mp_size_t limb = static_cast<mp_size_t>(offset / numbBits);
+                const size_t shift = offset % numbBits;
+                uint64_t v = static_cast<uint64_t>(mpz_getlimbn(z, limb)) >> shift;
+                for (size_t got = numbBits - shift; got < len; got += numbBits) {
+                    v |= static_cast<uint64_t>(mpz_getlimbn(z, ++limb)) << got;
+                }
+                return v & ((uint64_t(1) << len) - 1);
+            }
+
+            /// chunks[t * stride] = t-th signed s-bit chunk of X, stored, for t < c.
+            void split(std::vector<double>& chunks, const Operand& X, size_t s, size_t c) const
+            {
+                const size_t rows = X.storedRows(), cols = X.storedCols(), stride = rows * cols;
+                chunks.resize(c * stride);
+                _pool.parallelFor(0, rows, 0, [&](size_t i) {
+                    for (size_t j = 0; j < cols; ++j) {
+                        mpz_srcptr z = X.stored(i, j).get_mpz_const();
+                        const double sign = (mpz_sgn(z) < 0) ? -1.0 : 1.0;
+                        for (size_t t = 0; t < c; ++t)
+                            chunks[t * stride + i * cols + j] = sign * static_cast<double>(bitSlice(z, t * s, s));
+                    }
+                });
+            }
+
+            void classic(std::vector<Integer>& P, const Operand& opA, const Operand& opB, size_t m, size_t n,
+                         size_t k) const
+            {
+                _pool.parallelFor(0, m, 0, [&](size_t i) {
+                    for (size_t j = 0; j < n; ++j) {
+                        mpz_ptr p = P[i * n + j].get_mpz();
+                        for (size_t l = 0; l < k; ++l) mpz_addmul(p, opA(i, l).get_mpz_const(), opB(l, j).get_mpz_const());
+                    }
+                });
+            }
+
+            void qadic(std::vector<Integer>& P, const Operand& opA, const Operand& opB, size_t m, size_t n, size_t k,
+                       size_t bitsA, size_t bitsB) const
+            {
+                const Split sp = qadicSplit(k, bitsA, bitsB);
+                const size_t cA = sp.chunksA, cB = sp.chunksB;
+                std::vector<double> X, Y;
+                split(X, opA, sp.bitsA, cA);
+                split(Y, opB, sp.bitsB, cB);
+
+                // W[a cB + b] = A_a B_b, exact: |entries| < k 2^(sA + sB) <= 2^52
+                const size_t tiles = tileCount(m), step = (m + tiles - 1) / tiles;
+                std::vector<double> W(cA * cB * m * n);
+                Givaro::ZRing<double> D;
+                _pool.parallelFor(0, cA * cB * tiles, 1, [&](size_t task) {
+                    const size_t pair = task / tiles, a = pair / cB, b = pair % cB;
+                    const size_t begin = (task % tiles) * step, end = std::min(m, begin + step);
+                    if (begin < end)
+                        product(D, opA, opB, n, k, X.data() + a * m * k, Y.data() + b * k * n,
+                                W.data() + pair * m * n, begin, end);
+                });
+
+                // P = sum_a 2^(a sA) sum_b 2^(b sB) W[a cB + b], by Horner
+                _pool.parallelFor(0, m, 0, [&](size_t i) {
+                    Integer inner;
+                    for (size_t j = 0; j < n; ++j) {
+                        Integer& p = P[i * n + j];
+                        const double* w = W.data() + i * n + j;
+                        for (size_t a = cA; a-- > 0;) {
+                            mpz_set_d(inner.get_mpz(), w[(a * cB + cB - 1) * m * n]);
+                            for (size_t b = cB - 1; b-- > 0;) {
+                                inner <<= static_cast<uint64_t>(sp.bitsB);
+                                inner += static_cast<int64_t>(w[(a * cB + b) * m * n]);
+                            }
+                            p <<= static_cast<uint64_t>(sp.bitsA);
+                            p += inner;
+                        }
+                    }
+                });
+            }
+
+            void rns(std::vector<Integer>& P, const Operand& opA, const Operand& opB, size_t m, size_t n, size_t k,
+                     size_t bitsA, size_t bitsB) const
+            {
+                std::vector<double> basis;
+                Integer bound(1);
+                bound <<= static_cast<uint64_t>(bitsA + bitsB + bitSize(k) + 1);
+                IntegerRNS::basis(basis, k, bound);
+                const IntegerRNS RNS(basis, _pool);
+                const size_t r = basis.size();
+                LINBOX_TRACE_COUNT(Primes, r);
+
+                std::vector<double> X, Y, W(r * m * n);
+                reduce(X, RNS, opA, bitsA);
+                reduce(Y, RNS, opB, bitsB);
+
+                const size_t tiles = tileCount(m), step = (m + tiles - 1) / tiles;
+                _pool.parallelFor(0, r * tiles, 1, [&](size_t task) {
+                    const size_t l = task / tiles;
+                    const size_t begin = (task % tiles) * step, end = std::min(m, begin + step);
+                    if (begin < end) {
+                        Givaro::Modular<double> F(basis[l]);
+                        product(F, opA, opB, n, k, X.data() + l * m * k, Y.data() + l * k * n, W.data() + l * m * n,
+                                begin, end);
+                    }
+                });
+
+                RNS.reconstruct(P.data(), W.data(), m, n);
+            }
+
+            /// Residues of X, stored, prime by prime.
+            static void reduce(std::vector<double>& residues, const IntegerRNS& RNS, const Operand& X, size_t bits)
+            {
+                const size_t rows = X.storedRows(), cols = X.storedCols();
+                residues.resize(RNS.size() * rows * cols);
+                Integer maxX(1);
+                maxX <<= static_cast<uint64_t>(bits);
+                RNS.reduce(residues.data(), X.data, X.ld, rows, cols, maxX);
+            }
+
+#ifdef __LINBOX_HAVE_FLINT
+            void flint(std::vector<Integer>& P, const Operand& opA, const Operand& opB, size_t m, size_t n,
+                       size_t k) const
+            {
+                FLINT::fmpz_mat_t Af, Bf, Cf;
+                FLINT::fmpz_mat_init(Af, m, k);
+                FLINT::fmpz_mat_init(Bf, k, n);
+                FLINT::fmpz_mat_init(Cf, m, n);
+                for (size_t i = 0; i < m; ++i)
+                    for (size_t l = 0; l < k; ++l) FLINT::fmpz_set_mpz(fmpz_mat_entry(Af, i, l), opA(i, l).get_mpz_const());
+                for (size_t l = 0; l < k; ++l)
+                    for (size_t j = 0; j < n; ++j) FLINT::fmpz_set_mpz(fmpz_mat_entry(Bf, l, j), opB(l, j).get_mpz_const());
+                FLINT::fmpz_mat_mul(Cf, Af, Bf);
+                for (size_t i = 0; i < m; ++i)
+                    for (size_t j = 0; j < n; ++j) FLINT::fmpz_get_mpz(P[i * n + j].get_mpz(), fmpz_mat_entry(Cf, i, j));
+                FLINT::fmpz_mat_clear(Af);
+                FLINT::fmpz_mat_clear(Bf);
+                FLINT::fmpz_mat_clear(Cf);
+            }
+#endif
+
+            TaskPool& _pool;
+            Strategy _strategy = Strategy::Classic;
+        };
+    }
+}
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
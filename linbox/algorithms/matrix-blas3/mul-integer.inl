@@ -0,0 +1,89 @@
+/*  Copyright (C) 2018 the members of the LinBox group
+ *
+ * This file is part of the LinBox library.
+ *
+ * ========LICENCE========
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * LinBox is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ *
+ */
+
+#ifndef __LINBOX_matrix_blas3_mul_integer_INL
+#define __LINBOX_matrix_blas3_mul_integer_INL
+
+#include "linbox/algorithms/matrix-blas3/mul-integer.h"
+
+namespace LinBox { namespace BLAS3 { namespace Protected {
+
+	template<class DenseIntMat>
+	DenseIntMat & integerMul (DenseIntMat& C,
+				  const DenseIntMat& A,
+				  const DenseIntMat& B,
+				  IntegerMulDomain::Strategy strategy)
+	{
+		linbox_check(A.coldim() == B.rowdim());
+		linbox_check(C.rowdim() == A.rowdim() && C.coldim() == B.coldim());
+		IntegerMulDomain().fgemm(FFLAS::FflasNoTrans, FFLAS::FflasNoTrans,
+					 C.rowdim(), C.coldim(), A.coldim(),
+					 C.field().one, A.getPointer(), A.getStride(), B.getPointer(), B.getStride(),
+					 C.field().zero, C.getPointer(), C.getStride(), strategy);
+		return C;
+	}
+
+} // Protected
+} // BLAS3
+} // LinBox
+
+namespace LinBox { namespace BLAS3 {
+
+	template<class DenseIntMat>
+	DenseIntMat & mul (DenseIntMat& C,
+			   const DenseIntMat& A,
+			   const DenseIntMat& B,
+			   const mulMethod::Auto &)
+	{
+		return Protected::integerMul(C, A, B, IntegerMulDomain::Strategy::Auto);
+	}
+
+	template<class DenseIntMat>
+	DenseIntMat & mul (DenseIntMat& C,
+			   const DenseIntMat& A,
+			   const DenseIntMat& B,
+			   const mulMethod::QAdic &)
+	{
+		return Protected::integerMul(C, A, B, IntegerMulDomain::Strategy::QAdic);
+	}
+
+	template<class DenseIntMat>
+	DenseIntMat & mul (DenseIntMat& C,
+			   const DenseIntMat& A,
+			   const DenseIntMat& B,
+			   const mulMethod::RNS &)
+	{
+		return Protected::integerMul(C, A, B, IntegerMulDomain::Strategy::RNS);
+	}
+
+} // BLAS3
+} // LinBox
+
+#endif // __LINBOX_matrix_blas3_mul_integer_INL
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -59,6 +59,12 @@ namespace LinBox {
 			struct FLINT {};
 
 			struct CRA {} ;
+
+			//! Integer matrices: classic, q-adic or RNS, forced (see IntegerMulDomain).
+			struct QAdic {};
+			struct RNS {};
+			//! Integer matrices: the cheapest of classic, q-adic, RNS or FLINT.
+			struct Auto {};
 		}
 	}
 }
@@ -190,6 +196,40 @@ namespace LinBox {
 }
 #include "linbox/algorithms/matrix-blas3/mul-cra.inl"
 
+// integers: q-adic, RNS, FLINT
+namespace LinBox {
+	namespace BLAS3 {
+		/** @brief Multiplication of integer matrices, by IntegerMulDomain.
+		 * @param [out] C result
+		 * @param A matrix
+		 * @param B matrix
+		 * @return C=AB
+		 */
+		template<class DenseIntMat>
+		DenseIntMat &
+		mul (DenseIntMat& C,
+			 const DenseIntMat& A,
+			 const DenseIntMat& B,
+			 const mulMethod::Auto & );
+
+		template<class DenseIntMat>
+		DenseIntMat &
+		mul (DenseIntMat& C,
+			 const DenseIntMat& A,
+			 const DenseIntMat& B,
+			 const mulMethod::QAdic & );
+
+		template<class DenseIntMat>
+		DenseIntMat &
+		mul (DenseIntMat& C,
+			 const DenseIntMat& A,
+			 const DenseIntMat& B,
+			 const mulMethod::RNS & );
+
+	}
+}
+#include "linbox/algorithms/matrix-blas3/mul-integer.inl"
+
 // <+other algo+>
 namespace LinBox {
 	namespace BLAS3 {
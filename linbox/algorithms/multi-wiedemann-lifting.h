@@ -0,0 +1,322 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file algorithms/multi-wiedemann-lifting.h
+ * @ingroup algorithms
+ * @brief p-adic lifting of several right-hand sides at once with a precomputed minimal polynomial.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "linbox/integer.h"
+#include "linbox/matrix/dense-matrix.h"
+#include "linbox/matrix/sparse-matrix.h"
+#include "linbox/solutions/hadamard-bound.h"
+#include "linbox/util/debug.h"
+#include "linbox/util/error.h"
+#include "linbox/vector/blas-vector.h"
+
+namespace LinBox {
+    namespace Protected {
+        /// Y = A X, one blackbox apply per column of X.
+        template <class Blackbox, class Matrix1, class Matrix2>
+        Matrix1& blockApply(Matrix1& Y, const Blackbox& A, const Matrix2& X)
+        {
+            using Element = typename Matrix1::Element;
+            std::vector<Element> x(A.coldim()), y(A.rowdim());
+            for (size_t j = 0; j < X.coldim(); ++j) {
+                for (size_t i = 0; i < X.rowdim(); ++i) x[i] = X.getEntry(i, j);
+                A.apply(y, x);
+                for (size_t i = 0; i < Y.rowdim(); ++i) Y.setEntry(i, j, y[i]);
+            }
+            return Y;
+        }
+
+        /// Y = A X, the triples are traversed once for all the columns of X.
+        template <class Field, class Matrix1, class Matrix2>
+        Matrix1& blockApply(Matrix1& Y, const SparseMatrix<Field, SparseMatrixFormat::TPL>& A, const Matrix2& X)
+        {
+            return A.applyLeft(Y, X);
+        }
+
+#ifdef _OPENMP
+        /// Y = A X, with the multithreaded row chunks kernel.
+        template <class Field, class Matrix1, class Matrix2>
+        Matrix1& blockApply(Matrix1& Y, const SparseMatrix<Field, SparseMatrixFormat::TPL_omp>& A, const Matrix2& X)
+        {
+            return A.applyLeft(Y, X);
+        }
+#endif
+    }
+
+    /**
+     * \brief Wiedemann p-adic lifting of a block of right-hand sides.
+     *
+     * Solves A X = B for the s columns of B, with A nonsingular,
+     * given the minimal polynomial of A mod p.
+     * The p-adic digits of a single system depend on each other,
+     * so the digits are computed for all the columns at once instead:
+     * each step of the Horner scheme on the minimal polynomial is one
+     * block product Ap D, where D is a m x s matrix,
+     * so that the sparse matrix is traversed once for s digits.
+     *
+     * Block products use applyLeft of the sparse matrix when its format is
+     * SparseMatrixFormat::TPL or SparseMatrixFormat::TPL_omp (multithreaded),
+     * and one apply per column for any other blackbox.
+     * This holds both for Ap over the field and for A over the integers
+     * (residual update).
+     *
+     * The minimal polynomial must annihilate Ap: next() fails otherwise.
+     *
+     * The rational solvers (RationalSolver, solve with Method::Wiedemann) take a single
+     * right-hand side and reconstruct it through RationalReconstruction, which iterates
+     * the digits of one vector: there is no entry point solving for a block of
+     * right-hand sides that could use this container, so none does yet.
+     * lift() gives the block of p-adic solutions, to be reconstructed column by column.
+     */
+    template <class _Ring, class _Field, class _IMatrix, class _FMatrix, class _FPolynomial>
+    class MultiWiedemannLiftingContainer {
+    public:
+        using Ring = _Ring;
+        using Field = _Field;
+        using IMatrix = _IMatrix;
+        using FMatrix = _FMatrix;
+        using FPolynomial = _FPolynomial;
+        using Integer_t = typename Ring::Element;
+        using Element = typename Field::Element;
+        using IBlock = BlasMatrix<Ring>;
+        using FBlock = BlasMatrix<Field>;
+
+        /// B is a m x s integer matrix, its columns are the right-hand sides.
+        template <class IBlockIn>
+        MultiWiedemannLiftingContainer(const Ring& R, const Field& F, const IMatrix& A, const FMatrix& Ap,
+                                       const FPolynomial& minPoly, const IBlockIn& B, const Integer& p)
+            : _ring(R)
+            , _field(F)
+            , _A(A)
+            , _Ap(Ap)
+            , _minPoly(minPoly)
+            , _res(R, B.rowdim(), B.coldim())
+            , _resP(F, B.rowdim(), B.coldim())
+            , _digitP(F, A.coldim(), B.coldim())
+            , _z(F, Ap.rowdim(), B.coldim())
+            , _y(R, A.rowdim(), B.coldim())
+            , _position(0)
+        {
+            linbox_check(A.rowdim() == B.rowdim());
+            _ring.init(_p, p);
+
+            if (_minPoly.size() < 2 || _field.isZero(_minPoly.front())) {
+                throw PreconditionFailed(__func__, __LINE__, "the minimal polynomial must have a nonzero constant term.");
+            }
+
+            // Normalize the minimal polynomial as f(x) = 1 - a1/a0 x - a2/a0 x^2 - ...
+            for (size_t i = 1; i < _minPoly.size(); ++i) {
+                _field.divin(_minPoly[i], _minPoly.front());
+                _field.negin(_minPoly[i]);
+            }
+
+            // The length is the one of the worst column.
+            double numLogBound = 0.0, denLogBound = 0.0;
+            BlasVector<Ring> b(R, B.rowdim());
+            for (size_t j = 0; j < B.coldim(); ++j) {
+                for (size_t i = 0; i < B.rowdim(); ++i) {
+                    _ring.init(_res.refEntry(i, j), B.getEntry(i, j));
+                    b[i] = _res.getEntry(i, j);
+                }
+                auto hb = RationalSolveHadamardBound(A, b);
+                numLogBound = std::max(numLogBound, hb.numLogBound);
+                denLogBound = std::max(denLogBound, hb.denLogBound);
+            }
+
+            _length = std::ceil((1 + numLogBound + denLogBound) / Givaro::logtwo(p));
+            _ring.init(_numbound, Integer(1) << static_cast<uint64_t>(std::ceil(numLogBound)));
+            _ring.init(_denbound, Integer(1) << static_cast<uint64_t>(std::ceil(denLogBound)));
+        }
+
+        /// Number of digits needed for the rational reconstruction of every column.
+        size_t length() const { return _length; }
+
+        /// Size of one solution.
+        size_t size() const { return _A.coldim(); }
+
+        /// Number of right-hand sides.
+        size_t blocksize() const { return _res.coldim(); }
+
+        /// Number of digits already computed.
+        size_t position() const { return _position; }
+
+        const Ring& ring() const { return _ring; }
+
+        const Field& field() const { return _field; }
+
+        const Integer_t& prime() const { return _p; }
+
+        const Integer_t& numbound() const { return _numbound; }
+
+        const Integer_t& denbound() const { return _denbound; }
+
+        /**
+         * \brief Next p-adic digit of every column.
+         * digits is a n x s integer matrix.
+         * @returns False if the digits cannot be computed
+         * (the minimal polynomial is wrong or the modulus is bad).
+         */
+        bool next(IBlock& digits)
+        {
+            linbox_check(digits.rowdim() == size() && digits.coldim() == blocksize());
+            const size_t m = _res.rowdim();
+            const size_t s = _res.coldim();
+
+            // resP = res mod p
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+            for (size_t i = 0; i < m; ++i) {
+                Integer tmp;
+                for (size_t j = 0; j < s; ++j) {
+                    _field.init(_resP.refEntry(i, j), _ring.convert(tmp, _res.getEntry(i, j)));
+                }
+            }
+
+            // Block Horner scheme: digitP = f(Ap) resP
+            scale(_digitP, _minPoly.back(), _resP);
+            for (size_t k = _minPoly.size() - 1; --k;) {
+                Protected::blockApply(_z, _Ap, _digitP);
+                axpy(_digitP, _minPoly[k], _resP, _z);
+            }
+
+            // Ap digitP = resP
+            Protected::blockApply(_z, _Ap, _digitP);
+            bool solved = true;
+            for (size_t i = 0; solved && i < m; ++i) {
+                for (size_t j = 0; solved && j < s; ++j) {
+                    solved = _field.areEqual(_z.getEntry(i, j), _resP.getEntry(i, j));
+                }
+            }
+            if (!solved) return false;
+
+            {
+                Integer tmp;
+                for (size_t i = 0; i < digits.rowdim(); ++i) {
+                    for (size_t j = 0; j < s; ++j) {
+                        _ring.init(digits.refEntry(i, j), _field.convert(tmp, _digitP.getEntry(i, j)));
+                    }
+                }
+            }
+
+            // res = (res - A digits) / p
+            Protected::blockApply(_y, _A, digits);
+            bool divisible = true;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) reduction(&& : divisible)
+#endif
+            for (size_t i = 0; i < m; ++i) {
+                for (size_t j = 0; j < s; ++j) {
+                    Integer_t& r = _res.refEntry(i, j);
+                    _ring.subin(r, _y.getEntry(i, j));
+                    divisible = divisible && _ring.isDivisor(r, _p);
+                    _ring.divin(r, _p);
+                }
+            }
+
+            ++_position;
+            return divisible;
+        }
+
+        /**
+         * \brief Computes length() digits and accumulates them.
+         * On return, A X = B mod modulus, where modulus = p^length().
+         * @returns False if a step failed, see next().
+         */
+        bool lift(IBlock& X, Integer_t& modulus)
+        {
+            linbox_check(X.rowdim() == size() && X.coldim() == blocksize());
+            IBlock digits(_ring, size(), blocksize());
+
+            for (size_t i = 0; i < X.rowdim(); ++i) {
+                for (size_t j = 0; j < X.coldim(); ++j) _ring.assign(X.refEntry(i, j), _ring.zero);
+            }
+            _ring.assign(modulus, _ring.one);
+
+            while (_position < _length) {
+                if (!next(digits)) return false;
+                for (size_t i = 0; i < X.rowdim(); ++i) {
+                    for (size_t j = 0; j < X.coldim(); ++j) {
+                        _ring.axpyin(X.refEntry(i, j), digits.getEntry(i, j), modulus);
+                    }
+                }
+                _ring.mulin(modulus, _p);
+            }
+
+            return true;
+        }
+
+    private:
+        // D = a X
+        void scale(FBlock& D, const Element& a, const FBlock& X) const
+        {
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+            for (size_t i = 0; i < D.rowdim(); ++i) {
+                for (size_t j = 0; j < D.coldim(); ++j) {
+                    _field.mul(D.refEntry(i, j), a, X.getEntry(i, j));
+                }
+            }
+        }
+
+        // D = a X + Y
+        void axpy(FBlock& D, const Element& a, const FBlock& X, const FBlock& Y) const
+        {
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+            for (size_t i = 0; i < D.rowdim(); ++i) {
+                for (size_t j = 0; j < D.coldim(); ++j) {
+                    _field.axpy(D.refEntry(i, j), a, X.getEntry(i, j), Y.getEntry(i, j));
+                }
+            }
+        }
+
+        Ring _ring;
+        Field _field;
+        const IMatrix& _A;
+        const FMatrix& _Ap;
+        FPolynomial _minPoly;
+        Integer_t _p;
+        Integer_t _numbound;
+        Integer_t _denbound;
+        size_t _length;
+
+        IBlock _res;
+        FBlock _resP;
+        FBlock _digitP;
+        FBlock _z;
+        IBlock _y;
+        size_t _position;
+    };
+}
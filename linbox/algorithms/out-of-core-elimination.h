@@ -0,0 +1,297 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file algorithms/out-of-core-elimination.h
+ * @ingroup algorithms
+ * @brief Rank and row echelon form of a dense matrix stored in a file.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <future>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include <fflas-ffpack/fflas/fflas.h>
+
+#include "linbox/matrix/densematrix/out-of-core-matrix.h"
+#include "linbox/util/debug.h"
+#include "linbox/util/error.h"
+#include "linbox/util/task-pool.h"
+#include "linbox/util/tracer.h"
+
+namespace LinBox {
+
+    /**
+     * \brief Left-looking LU elimination of an OutOfCoreMatrix, panel by panel.
+     *
+     * Panel k of the matrix (all rows, a few columns) is loaded, updated by the factors
+     * of the panels j < k, streamed one after the other from the file: a triangular solve
+     * on its pivot rows (ftrsm) and an fgemm on the rows below. It is then eliminated in
+     * memory with row pivoting, and written back: L below the pivots, U on the pivot rows.
+     * Only the row permutation and the pivot columns stay in memory.
+     *
+     * I/O runs on a thread of its own: panel j + 1 is read while panel j updates panel k,
+     * and panel k is written while panel k + 1 is read, so that I/O overlaps the fgemm
+     * even with a single computing thread. The fgemm are split in row tiles on the TaskPool.
+     *
+     * At most 5 m w elements are in memory for panels of w columns: panelWidth() gives the
+     * largest w for a memory budget.
+     *
+     * The field must be a word-size prime field (the elements are written to files and
+     * multiplied by FFLAS::fgemm).
+     */
+    template <class _Field>
+    class OutOfCoreElimination {
+    public:
+        typedef _Field Field;
+        typedef typename Field::Element Element;
+        typedef OutOfCoreMatrix<Field> Matrix;
+
+        OutOfCoreElimination(const Field& F, size_t memoryBudget, TaskPool& pool = TaskPool::current())
+            : _field(F)
+            , _memoryBudget(memoryBudget)
+            , _pool(pool)
+        {
+        }
+
+        /// Widest panels of an m-row matrix that the elimination can hold within memoryBudget bytes, 0 if none.
+        static size_t panelWidth(size_t m, size_t memoryBudget)
+        {
+            const size_t column = ResidentPanels * std::max<size_t>(m, 1) * sizeof(Element);
+            return memoryBudget / column;
+        }
+
+        /// Whether A can be eliminated in place within the memory budget.
+        bool fits(const Matrix& A) const { return A.panelWidth() <= panelWidth(A.rowdim(), _memoryBudget); }
+
+        /**
+         * \brief Factorization of W in place, W must fit().
+         * If A is given, the panels of W are first read from A (of the same dimensions), which is left unchanged.
+         * @return the rank.
+         */
+        size_t factorize(Matrix& W, const Matrix* A = nullptr)
+        {
+            LINBOX_TRACE_SPAN("out-of-core elimination");
+            if (!fits(W)) throw LinboxError("LinBox ERROR: out-of-core elimination: memory budget too small");
+            linbox_check(A == nullptr || (A->rowdim() == W.rowdim() && A->coldim() == W.coldim()));
+
+            const size_t m = W.rowdim(), panels = W.panelCount();
+            _m = m;
+            _w = W.panelWidth();
+            _perm.resize(m);
+            std::iota(_perm.begin(), _perm.end(), 0);
+            _pivots.assign(panels, std::vector<size_t>());
+            _rankBefore.assign(panels + 1, 0);
+
+            const size_t w = W.panelWidth();
+            std::vector<Element> target(m * w), stage(m * w), compact(m * w);
+            std::vector<Element> source[2] = {std::vector<Element>(m * w), std::vector<Element>(m * w)};
+
+            // Stage: reads of the targets and write-backs; sources: reads of the factored panels.
+            std::future<void> staging, sourcing;
+            auto loadTarget = [&, A](size_t k) {
+                if (A)
+                    A->readBlock(0, m, W.panelBegin(k), W.panelEnd(k), stage.data());
+                else
+                    W.readBlock(0, m, W.panelBegin(k), W.panelEnd(k), stage.data());
+            };
+            auto loadSource = [&](size_t j, size_t b) {
+                W.readBlock(0, m, W.panelBegin(j), W.panelEnd(j), source[b].data());
+            };
+            if (panels > 0) staging = std::async(std::launch::async, loadTarget, 0);
+
+            size_t next = 0; // buffer of the next source
+            for (size_t k = 0; k < panels; ++k) {
+                const size_t wk = W.panelCols(k);
+                staging.get();
+                permute(target.data(), stage.data(), wk, false);
+
+                for (size_t j = 0; j < k; ++j) {
+                    const size_t b = next;
+                    next = 1 - next;
+                    sourcing.get();
+                    if (j + 1 < k) sourcing = std::async(std::launch::async, loadSource, j + 1, next);
+                    update(target.data(), wk, source[b].data(), W.panelCols(j), j, compact.data());
+                }
+
+                _rankBefore[k + 1] = eliminate(target.data(), wk, _rankBefore[k], W.panelBegin(k), _pivots[k]);
+
+                // stage is free: write panel k, then read panel k + 1, and the first source of k + 1
+                permute(stage.data(), target.data(), wk, true);
+                staging = std::async(std::launch::async, [&, k]() {
+                    W.writeBlock(0, m, W.panelBegin(k), W.panelEnd(k), stage.data());
+                    if (k + 1 < panels) loadTarget(k + 1);
+                });
+                if (k + 1 < panels) {
+                    // panel 0 must be written before it is read
+                    if (k == 0) staging.wait();
+                    sourcing = std::async(std::launch::async, loadSource, 0, next);
+                }
+            }
+            if (staging.valid()) staging.get();
+            return rank();
+        }
+
+        size_t rank() const { return _rankBefore.empty() ? 0 : _rankBefore.back(); }
+
+        /// Physical row of the i-th row of the factorization: the first rank() ones are the pivot rows.
+        const std::vector<size_t>& rowPermutation() const { return _perm; }
+
+        /**
+         * \brief E = the row echelon form of the matrix factorized in W.
+         * Its first rank() rows are U, the other ones zero; the pivots are not normalized.
+         * E may be W itself, or any matrix of the same dimensions.
+         */
+        void echelonForm(Matrix& E, const Matrix& W) const
+        {
+            LINBOX_TRACE_SPAN("out-of-core echelon form");
+            linbox_check(E.rowdim() == W.rowdim() && E.coldim() == W.coldim());
+            const size_t m = W.rowdim(), r = rank();
+
+            // Pivot panel and column of each of the first r rows
+            std::vector<size_t> pivotPanel(r), pivotCol(r);
+            for (size_t j = 0; j < _pivots.size(); ++j)
+                for (size_t s = 0; s < _pivots[j].size(); ++s) {
+                    pivotPanel[_rankBefore[j] + s] = j;
+                    pivotCol[_rankBefore[j] + s] = _pivots[j][s];
+                }
+
+            const size_t w = W.panelWidth();
+            std::vector<Element> raw(m * w), form(m * w);
+            for (size_t j = 0; j < W.panelCount(); ++j) {
+                const size_t c0 = W.panelBegin(j), wj = W.panelCols(j);
+                W.readBlock(0, m, c0, W.panelEnd(j), raw.data());
+                _pool.parallelFor(0, m, 0, [&](size_t t) {
+                    Element* e = form.data() + t * wj;
+                    const Element* a = raw.data() + _perm[t] * wj;
+                    for (size_t c = 0; c < wj; ++c) {
+                        const bool upper = t < r && (pivotPanel[t] < j || (pivotPanel[t] == j && c0 + c >= pivotCol[t]));
+                        _field.assign(e[c], upper ? a[c] : _field.zero);
+                    }
+                });
+                E.writeBlock(0, m, c0, W.panelEnd(j), form.data());
+            }
+        }
+
+    private:
+        // target, stage, two sources and the compact factor of a source
+        static constexpr size_t ResidentPanels = 5;
+        static constexpr size_t MinTileRows = 256;
+
+        /// to = from, rows from physical to logical order, or back.
+        void permute(Element* to, const Element* from, size_t w, bool back) const
+        {
+            _pool.parallelFor(0, _m, 0, [&](size_t t) {
+                const Element* src = back ? from + t * w : from + _perm[t] * w;
+                Element* dst = back ? to + _perm[t] * w : to + t * w;
+                std::copy(src, src + w, dst);
+            });
+        }
+
+        /**
+         * \brief Panel T (logical order, w columns) updated by the factors of panel j (raw, wj columns):
+         * X = L_jj^{-1} X on the pivot rows of panel j, then the rows below -= L_j X.
+         */
+        void update(Element* T, size_t w, const Element* raw, size_t wj, size_t j, Element* L) const
+        {
+            const std::vector<size_t>& piv = _pivots[j];
+            const size_t rj = piv.size(), R = _rankBefore[j];
+            if (rj == 0) return;
+            const size_t c0 = j * _w;
+
+            // L = rows [R, m) of panel j, pivot columns only
+            const size_t rows = _m - R;
+            _pool.parallelFor(0, rows, 0, [&](size_t t) {
+                const Element* a = raw + _perm[R + t] * wj;
+                for (size_t s = 0; s < rj; ++s) L[t * rj + s] = a[piv[s] - c0];
+            });
+
+            Element* X = T + R * w;
+            FFLAS::ftrsm(_field, FFLAS::FflasLeft, FFLAS::FflasLower, FFLAS::FflasNoTrans, FFLAS::FflasUnit, rj, w,
+                         _field.one, L, rj, X, w);
+
+            const size_t below = rows - rj;
+            const size_t tiles = std::max<size_t>(1, std::min(_pool.numThreads(), below / MinTileRows));
+            const size_t step = (below + tiles - 1) / tiles;
+            _pool.parallelFor(0, tiles, 1, [&](size_t tile) {
+                const size_t begin = tile * step, end = std::min(below, begin + step);
+                if (begin < end)
+                    FFLAS::fgemm(_field, FFLAS::FflasNoTrans, FFLAS::FflasNoTrans, end - begin, w, rj, _field.mOne,
+                                 L + (rj + begin) * rj, rj, X, w, _field.one, X + (rj + begin) * w, w);
+            });
+        }
+
+        /**
+         * \brief Gaussian elimination of panel T (logical order, w columns) from row R on, with row pivoting.
+         * The multipliers replace the eliminated entries. Appends the pivot columns (c0 + index) to piv.
+         * @return the rank of rows [0, R) and of the panel below.
+         */
+        size_t eliminate(Element* T, size_t w, size_t R, size_t c0, std::vector<size_t>& piv)
+        {
+            size_t cur = R;
+            Element inv;
+            for (size_t c = 0; c < w && cur < _m; ++c) {
+                size_t p = cur;
+                while (p < _m && _field.isZero(T[p * w + c])) ++p;
+                if (p == _m) continue;
+                if (p != cur) {
+                    std::swap_ranges(T + p * w, T + (p + 1) * w, T + cur * w);
+                    std::swap(_perm[p], _perm[cur]);
+                }
+                const Element* u = T + cur * w;
+                _field.inv(inv, u[c]);
+                _pool.parallelFor(cur + 1, _m, 0, [&, c](size_t i) {
+                    Element* a = T + i * w;
+                    if (_field.isZero(a[c])) return;
+                    Element li;
+                    _field.mul(li, a[c], inv);
+                    a[c] = li;
+                    for (size_t cc = c + 1; cc < w; ++cc) _field.maxpyin(a[cc], li, u[cc]);
+                });
+                piv.push_back(c0 + c);
+                ++cur;
+            }
+            return cur;
+        }
+
+        const Field& _field;
+        size_t _memoryBudget;
+        TaskPool& _pool;
+
+        size_t _m = 0;
+        size_t _w = 0;                            //!< Panel width of the factorized matrix.
+        std::vector<size_t> _perm;                //!< Logical row -> physical row.
+        std::vector<std::vector<size_t>> _pivots; //!< Pivot columns of each panel.
+        std::vector<size_t> _rankBefore;          //!< Rank of the panels before each one.
+    };
+}
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -3,97 +3,256 @@
 /* by Alex Stachnik
 */
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include <givaro/extension.h>
 #include <linbox/algorithms/poly-interpolation.h>
+#include <linbox/matrix/dense-matrix.h>
+#include <linbox/matrix/matrixdomain/blas-matrix-domain.h>
+#include <linbox/solutions/constants.h>
 #include <linbox/solutions/det.h>
+#include <linbox/util/error.h>
+#include <linbox/util/task-pool.h>
 
 namespace LinBox {
-/*  
-Matrix is a polynomial matrix.  
-result is set to its determinant and returned (a polynomial).
-d is the number of evaluation points.
 
-The method is to compute dets at each evaluation point and interpolate.
- (note by bds)
+/*
+Bound on the degree of the determinant of the polynomial matrix A:
+the smaller of the sums of the row and of the column maximal degrees.
+Returns -1 when A has a zero row or column, i.e. when its determinant is zero.
+ */
+template <class PolyMatrix>
+long polyDetDegreeBound(const PolyMatrix& A)
+{
+	const auto& PD=A.field();
+	const size_t m=A.rowdim(),n=A.coldim();
+	std::vector<long> rowMax(m,-1),colMax(n,-1);
+	for (size_t i=0;i<m;++i) {
+		for (size_t j=0;j<n;++j) {
+			const auto& p=A.getEntry(i,j);
+			if (PD.isZero(p)) continue;
+			long t=PD.degree(p).value();
+			rowMax[i]=std::max(rowMax[i],t);
+			colMax[j]=std::max(colMax[j],t);
+		}
+	}
+	long rowBound=0,colBound=0;
+	for (long t : rowMax) {
+		if (t<0) return -1;
+		rowBound += t;
+	}
+	for (long t : colMax) {
+		if (t<0) return -1;
+		colBound += t;
+	}
+	return std::min(rowBound,colBound);
+}
+
+/*
+Evaluation of a whole polynomial matrix at several points at once.
+The coefficients of the m x n entries are stored once as the rows of a
+(deg+1) x mn matrix C, so that the evaluations at the points x_1..x_b
+are the rows of the product of the Vandermonde matrix [x_r^k] by C:
+one matrix product instead of mn separate multipoint evaluations.
+Each row of the result is the row major m x n evaluated matrix.
+ */
+template <class Field>
+class PolyMatrixEvaluator {
+public:
+	typedef typename Field::Element Element;
+
+	template <class PolyMatrix>
+	PolyMatrixEvaluator(const Field& F, const PolyMatrix& A)
+		: _field(&F), _rowdim(A.rowdim()), _coldim(A.coldim()), _degree(0)
+	{
+		const auto& PD=A.field();
+		for (size_t i=0;i<_rowdim;++i)
+			for (size_t j=0;j<_coldim;++j)
+				if (!PD.isZero(A.getEntry(i,j)))
+					_degree=std::max(_degree,(size_t)PD.degree(A.getEntry(i,j)).value());
+
+		_coeffs.reset(new BlasMatrix<Field>(F,_degree+1,_rowdim*_coldim));
+		for (size_t i=0;i<_rowdim;++i) {
+			for (size_t j=0;j<_coldim;++j) {
+				const auto& p=A.getEntry(i,j);
+				if (PD.isZero(p)) continue;
+				size_t d=PD.degree(p).value();
+				for (size_t k=0;k<=d;++k)
+					_coeffs->setEntry(k,i*_coldim+j,p[k]);
+			}
+		}
+	}
+
+	size_t degree() const { return _degree; }
+
+	// Row r of E is A(pts[r]), row major.
+	void evaluate(BlasMatrix<Field>& E, const std::vector<Element>& pts) const
+	{
+		const Field& F=*_field;
+		BlasMatrix<Field> V(F,pts.size(),_degree+1);
+		for (size_t r=0;r<pts.size();++r) {
+			Element x;
+			F.assign(x,F.one);
+			for (size_t k=0;k<=_degree;++k) {
+				V.setEntry(r,k,x);
+				F.mulin(x,pts[r]);
+			}
+		}
+		BlasMatrixDomain<Field>(F).mul(E,V,*_coeffs);
+	}
+
+private:
+	const Field* _field;
+	size_t _rowdim,_coldim,_degree;
+	std::unique_ptr<BlasMatrix<Field> > _coeffs;
+};
+
+/*
+Determinant of the polynomial matrix A by evaluation/interpolation.
+
+The points are distinct random elements of the coefficient field,
+processed in batches of one point per thread of TaskPool::current():
+the batch is evaluated with a single PolyMatrixEvaluator product, then
+the determinants of the evaluated matrices run concurrently,
+one FFPACK::Det each, and are added to a Newton interpolant.
+
+At most maxPoints points are used. With earlyTermination > 0, the
+interpolation stops once that many consecutive Newton coefficients are
+zero: the interpolant then has the degree of the determinant with high
+probability. Without early termination, maxPoints must exceed the degree
+of the determinant, as for any interpolation.
  */
 template <class Field>
 typename Givaro::Poly1Dom<Field,Givaro::Dense>::Element&
 computePolyDet(typename Givaro::Poly1Dom<Field,Givaro::Dense>::Element& result,
-				DenseMatrix<Givaro::Poly1Dom<Field,Givaro::Dense> >& A, 
-               int d)
+               DenseMatrix<Givaro::Poly1Dom<Field,Givaro::Dense> >& A,
+               size_t maxPoints,
+               size_t earlyTermination)
 {
 	typedef Givaro::Poly1Dom<Field,Givaro::Dense> PolyDom;
-	typedef typename PolyDom::Element PolyElt;
 	typedef typename Field::Element FieldElt;
-	//typedef MatrixDomain<Field> FieldMatDom;
-	typedef DenseMatrix<Field> FieldMat;
 
-	int n=A.coldim(),m=A.rowdim();
+	const PolyDom& BR=A.field();
+	const Field& F=BR.subDomain();
+	const size_t n=A.coldim();
 
-	PolyDom BR=A.field();
-	Field F(BR.subDomain()); // coeff field
-
-	std::vector<FieldMat> mats;
-	std::vector<FieldElt> pts(d);
-	FieldElt fieldElt;
-	F.assign(fieldElt,F.zero);
-	for (int i=0;i<d;++i) {
-		mats.push_back(FieldMat(F,m,n));
-		F.init(pts[i],int64_t(i));
+	if (A.rowdim()!=n) {
+		BR.assign(result,BR.zero);
+		return result;
 	}
 
-	commentator().report(Commentator::LEVEL_IMPORTANT,PROGRESS_REPORT)
-		<< "Initialized mats" << std::endl;
+	integer card;
+	F.cardinality(card);
+	if (card>0 && card<integer(maxPoints))
+		throw LinboxError("LinBox ERROR: computePolyDet needs more evaluation points than the field has, use computePolyDetExtension");
 
+	PolyMatrixEvaluator<Field> evaluator(F,A);
+	typename Field::RandIter g(F);
+	TaskPool& pool=TaskPool::current();
+	const size_t batchSize=std::max<size_t>(1,std::min(pool.numThreads(),maxPoints));
 
-	PolyInterpolation<Field,PolyDom> PI(pts,F,BR);
-#pragma omp parallel for shared(mats,A,PI,BR,F)
-	for (int i=0;i<m;++i) {
-		for (int j=0;j<n;++j) {
-			PolyElt p;
-			A.getEntry(p,i,j);
-			std::vector<FieldElt> vals;
-			PI.evaluate(vals,p,BR,F);
-			for (int k=0;k<d;++k) {
-				mats[k].setEntry(i,j,vals[k]);
+	// Newton form: sum_k c_k prod_{j<k} (x - x_j)
+	std::vector<FieldElt> pts,coeffs;
+	size_t zeroStreak=0;
+	while (pts.size()<maxPoints && (earlyTermination==0 || zeroStreak<earlyTermination)) {
+		std::vector<FieldElt> batch;
+		const size_t b=std::min(batchSize,maxPoints-pts.size());
+		while (batch.size()<b) {
+			FieldElt x;
+			g.random(x);
+			bool fresh=true;
+			for (const auto& y : pts) fresh=fresh&&!F.areEqual(x,y);
+			for (const auto& y : batch) fresh=fresh&&!F.areEqual(x,y);
+			if (fresh) batch.push_back(x);
+		}
+
+		BlasMatrix<Field> E(F,b,n*n);
+		evaluator.evaluate(E,batch);
+		std::vector<FieldElt> dets(b);
+		pool.parallelFor(0,b,1,[&](size_t r) {
+			FFPACK::Det(F,dets[r],n,E.getPointer()+r*n*n,n);
+		});
+
+		for (size_t r=0;r<b;++r) {
+			// c = (v - N(x)) / prod_j (x - x_j)
+			FieldElt v,q,t;
+			F.assign(v,F.zero);
+			for (size_t k=coeffs.size();k-->0;) {
+				F.sub(t,batch[r],pts[k]);
+				F.mulin(v,t);
+				F.addin(v,coeffs[k]);
+			}
+			F.sub(v,dets[r],v);
+			F.assign(q,F.one);
+			for (const auto& y : pts) {
+				F.sub(t,batch[r],y);
+				F.mulin(q,t);
 			}
+			F.divin(v,q);
+			zeroStreak=F.isZero(v)?zeroStreak+1:0;
+			coeffs.push_back(v);
+			pts.push_back(batch[r]);
+			if (earlyTermination>0 && zeroStreak>=earlyTermination) break;
 		}
 	}
 
 	commentator().report(Commentator::LEVEL_IMPORTANT,PROGRESS_REPORT)
-		<< "Finished evaluations" << std::endl;
+		<< "Interpolated the determinant from " << pts.size() << " points" << std::endl;
 
-	std::vector<FieldElt> dets(d);
-#pragma omp parallel for shared(dets,mats)
-	for (int k=0;k<d;++k) {
-		det(dets[k],mats[k],Method::Elimination());
+	// Back to the monomial basis, by Horner on the Newton form.
+	size_t deg=coeffs.size();
+	while (deg>0 && F.isZero(coeffs[deg-1])) --deg;
+	if (deg==0) {
+		BR.assign(result,BR.zero);
+		return result;
 	}
-
-	PI.interpolate(result,pts,dets,BR,F);
+	std::vector<FieldElt> p(1,coeffs[deg-1]);
+	for (size_t k=deg-1;k-->0;) {
+		p.insert(p.begin(),F.zero);
+		for (size_t i=0;i+1<p.size();++i)
+			F.maxpyin(p[i],pts[k],p[i+1]);
+		F.addin(p[0],coeffs[k]);
+	}
+	BR.init(result,Givaro::Degree((long)deg-1));
+	for (size_t i=0;i<deg;++i)
+		F.assign(result[i],p[i]);
 	return result;
 }
 
-int roundUpPowerOfTwo(unsigned int n)
+/*
+Determinant of the polynomial matrix A, from at most d evaluation points.
+d must exceed the degree of the determinant.
+Throws a LinboxError if the field has fewer than d elements: the points
+0..d-1 used to repeat there, giving a wrong determinant without notice.
+Use computePolyDetExtension over small fields.
+ */
+template <class Field>
+typename Givaro::Poly1Dom<Field,Givaro::Dense>::Element&
+computePolyDet(typename Givaro::Poly1Dom<Field,Givaro::Dense>::Element& result,
+               DenseMatrix<Givaro::Poly1Dom<Field,Givaro::Dense> >& A,
+               int d)
 {
-	if (n==0) {
-		return 0;
-	} else if (n==1) {
-		return 1;
-	}
-	
-	int bits=0;
-	int loopN=n;
-	while (loopN>0) {
-		loopN = loopN >> 1;
-		++bits;
-	}
-	
-	unsigned int mask=(1<<(bits-1))-1;
-	if ((mask&n)!=0) {
-		return 1<<bits;
-	} else {
-		return 1<<(bits-1);
+	return computePolyDet<Field>(result,A,(size_t)d,0);
+}
+
+/*
+Determinant of the polynomial matrix A: the number of points is sized from
+polyDetDegreeBound, and the interpolation terminates early when the
+determinant has a smaller degree.
+ */
+template <class Field>
+typename Givaro::Poly1Dom<Field,Givaro::Dense>::Element&
+computePolyDet(typename Givaro::Poly1Dom<Field,Givaro::Dense>::Element& result,
+               DenseMatrix<Givaro::Poly1Dom<Field,Givaro::Dense> >& A)
+{
+	long bound=polyDetDegreeBound(A);
+	if (bound<0 || A.rowdim()!=A.coldim()) {
+		A.field().assign(result,A.field().zero);
+		return result;
 	}
+	return computePolyDet<Field>(result,A,(size_t)bound+1,LINBOX_DEFAULT_EARLY_TERMINATION_THRESHOLD);
 }
 
 template <class Field,class Matrix>
@@ -112,18 +271,14 @@ computePolyDetExtension(typename Givaro::Poly1Dom<Field,Givaro::Dense>::Element&
 	commentator().report(Commentator::LEVEL_IMPORTANT,PROGRESS_REPORT)
 		<< "Computing d" << std::endl;
 
-	int d=0;
-	BasePolyElt p;
-	for (int i=0;i<m;++i) {
-		int rowMaxD=0;
-		for (int j=0;j<n;++j) {
-			A.getEntry(p,i,j);
-			int t=BR.degree(p).value();
-			rowMaxD=(rowMaxD<t)?t:rowMaxD;
-		}
-		d += rowMaxD;
+	long bound=polyDetDegreeBound(A);
+	if (bound<0 || m!=n) {
+		BR.assign(result,BR.zero);
+		return result;
 	}
-	d=roundUpPowerOfTwo(d+1);
+	// Twice as many elements as points, so that random points are cheap to draw
+	// and rarely fool the early termination.
+	int d=2*(bound+1);
 
 	commentator().report(Commentator::LEVEL_IMPORTANT,PROGRESS_REPORT)
 		<< "Found d" << std::endl;
@@ -172,7 +327,7 @@ computePolyDetExtension(typename Givaro::Poly1Dom<Field,Givaro::Dense>::Element&
 		<< "Converted matrix" << std::endl;
 
 	ExtPoly ep;
-	computePolyDet<ExtField>(ep,Ap,d);
+	computePolyDet<ExtField>(ep,Ap);
 	//computePolyDet(ep,EF,Ap,d);
 
 	commentator().report(Commentator::LEVEL_IMPORTANT,PROGRESS_REPORT)
@@ -306,7 +306,7 @@ namespace LinBox
   // class PolynomialMatrixFFTMulDomain<Givaro::Modular<integer> > ;           // Mul in Zp[x] with p multiprecision
 
   // get the maximum prime for fft with modular<double> (matrix dim =k, nbr point = pts)
-  uint64_t maxFFTPrimeValue(uint64_t k, uint64_t pts) {
+  inline uint64_t maxFFTPrimeValue(uint64_t k, uint64_t pts) {
     uint64_t prime_max=std::sqrt( (1ULL<<53) /k)+1;
     size_t c=1;
     const int fct=24;
@@ -326,7 +326,7 @@ namespace LinBox
     return std::min(prime_max, uint64_t(Givaro::Modular<double>::maxCardinality()));
   }
 
-  void getFFTPrime(uint64_t prime_max, size_t lpts, integer bound, std::vector<integer> &bas, size_t k, size_t d){
+  inline void getFFTPrime(uint64_t prime_max, size_t lpts, integer bound, std::vector<integer> &bas, size_t k, size_t d){
 	size_t nbp=0;
 	bool b = RandomFFTPrime::generatePrimes (bas, prime_max, bound, lpts);
 	if (!b){ /* not enough FFT prime found */
@@ -34,7 +34,9 @@
 #define __LINBOX_reconstruction_H
 
 #include "linbox/linbox-config.h"
+#include "linbox/util/checkpoint.h"
 #include "linbox/util/debug.h"
+#include "linbox/util/tracer.h"
 
 
 #include "linbox/algorithms/rational-reconstruction-base.h"
@@ -97,6 +99,9 @@ namespace LinBox
 		// store early termination threshold.
 		int _threshold;
 
+		// where the lifting state is saved, if any
+		Checkpoint* _checkpoint = nullptr;
+
 	public:
 		RatRecon RR;
 
@@ -120,6 +125,18 @@ namespace LinBox
 			return _lcontainer;
 		}
 
+		/** \brief Saves the lifting state to checkpoint every checkpoint->period() seconds.
+		 *
+		 * The state is the residue and the p-adic digits computed so far
+		 * (getRational1() and getRational3()).
+		 * If the checkpoint file exists, the next reconstruction resumes from it,
+		 * provided the lifting container uses the same prime.
+		 */
+		void setCheckpoint(Checkpoint* checkpoint)
+		{
+			_checkpoint = checkpoint;
+		}
+
 		/** Handler to switch between different rational
 		 * reconstruction strategy.
 		 *  Allow  early termination and direct fast method Switch is
@@ -132,6 +149,7 @@ namespace LinBox
 		template <class Vector>
 		bool getRational(Vector& num, Integer& den, int switcher) const
 		{
+			LINBOX_TRACE_SPAN ("dixon");
 			if ( switcher == 0)
 				return getRational3 (num, den);
 			//{getRational1(num,den); print (num); std::cout << "Denominator: " << den << "\n";
@@ -150,6 +168,7 @@ namespace LinBox
 		template <class Vector>
 		bool getRational(Vector& num, Integer& den) const
 		{
+			LINBOX_TRACE_SPAN ("dixon");
 			if ( _threshold == 0)
 				return getRational3 (num, den);
 			//{getRational1(num,den); print (num); std::cout << "Denominator: " << den << "\n";
@@ -189,6 +208,65 @@ namespace LinBox
 		}
 #endif
 
+		/* Saves the lifting iterator, the digits it computed
+		 * and the state of the reconstruction, if a checkpoint is due.
+		 * saveState() returns the state, it is only called when saving.
+		 */
+		template <class Iterator, class Digits, class SaveState>
+		void saveLifting(const Iterator& iter, const Digits& digits, const SaveState& saveState, bool force) const
+		{
+			if (_checkpoint == nullptr || ! (force || _checkpoint->due())) return;
+
+			const std::vector<Integer> state = saveState();
+			std::vector<uint8_t> bytes;
+			Integer prime = _lcontainer.prime();
+			serialize(bytes, prime);
+			serialize(bytes, static_cast<uint64_t>(_lcontainer.length()));
+			iter.serialize(bytes);
+			for (size_t i = 0; i < iter.position(); ++i) {
+				serialize(bytes, digits[i]);
+			}
+			serialize(bytes, static_cast<uint64_t>(state.size()));
+			for (const auto& x : state) {
+				serialize(bytes, x);
+			}
+			_checkpoint->save(bytes);
+		}
+
+		/* Restores what saveLifting() saved.
+		 * Returns false if there is no checkpoint, or if it is for another prime.
+		 */
+		template <class Iterator, class Digits>
+		bool restoreLifting(Iterator& iter, Digits& digits, std::vector<Integer>& state) const
+		{
+			std::vector<uint8_t> bytes;
+			if (_checkpoint == nullptr || ! _checkpoint->load(bytes)) return false;
+
+			Integer savedPrime, prime = _lcontainer.prime();
+			uint64_t length, size;
+			uint64_t offset = unserialize(savedPrime, bytes);
+			offset += unserialize(length, bytes, offset);
+			if (savedPrime != prime || length != _lcontainer.length()) {
+				commentator().report(Commentator::LEVEL_IMPORTANT, INTERNAL_WARNING)
+					<< _checkpoint->path() << " is the checkpoint of another lifting, ignored." << std::endl;
+				return false;
+			}
+
+			offset += iter.unserialize(bytes, offset);
+			for (size_t i = 0; i < iter.position(); ++i) {
+				offset += unserialize(digits[i], bytes, offset);
+			}
+			offset += unserialize(size, bytes, offset);
+			state.resize(size);
+			for (auto& x : state) {
+				offset += unserialize(x, bytes, offset);
+			}
+
+			commentator().report(Commentator::LEVEL_IMPORTANT, INTERNAL_DESCRIPTION)
+				<< "Resuming from " << _checkpoint->path() << " after " << iter.position() << " digits" << std::endl;
+			return true;
+		}
+
 		/** Reconstruct a vector of rational numbers
 		 *  from p-adic digit vector sequence.
 		 *  An early termination technique is used.
@@ -249,6 +327,23 @@ namespace LinBox
 			//std::cout << "threshold is: "<< _threshold<<std::endl;
 			typename LVector::iterator digits_p = digits. begin();
 
+			// everything but the digits, for the checkpoints
+			auto saveState = [&]() {
+				std::vector<Integer> values = {modulus, denbound, numbound, c1, c1_num, c1_den, c2, c2_num, c2_den};
+				values.insert(values.end(), r1.begin(), r1.end());
+				values.insert(values.end(), r2.begin(), r2.end());
+				return values;
+			};
+			std::vector<Integer> state;
+			if (restoreLifting(iter, digits, state)) {
+				step = (int)iter.position();
+				digits_p = digits.begin() + step;
+				modulus = state[0]; denbound = state[1]; numbound = state[2];
+				c1 = state[3]; c1_num = state[4]; c1_den = state[5];
+				c2 = state[6]; c2_num = state[7]; c2_den = state[8];
+				std::copy(state.begin() + 9, state.begin() + 9 + n, r1.begin());
+				std::copy(state.begin() + 9 + n, state.begin() + 9 + 2 * n, r2.begin());
+			}
 
 #ifdef RSTIMING
 			tRecon.stop();
@@ -316,7 +411,11 @@ namespace LinBox
 						}
 					}
 				}
+
+				saveLifting(iter, digits, saveState, false);
 			}
+			saveLifting(iter, digits, saveState, true);
+
 			IVector res (_r,(size_t)n);
 			typename LVector::const_iterator digit_begin = digits. begin();
 			PolEval (res, digit_begin, (size_t)step, prime);
@@ -787,7 +886,14 @@ namespace LinBox
 #endif
 			// Compute all the approximation using liftingcontainer
 			typename LiftingContainer::const_iterator iter = _lcontainer.begin();
-			for (size_t i=0 ; iter != _lcontainer.end() && iter.next(digit_approximation[(size_t)i]);++i) {
+			size_t first = 0;
+			auto saveState = [&]() { return std::vector<Integer>{modulus}; };
+			std::vector<Integer> state;
+			if (restoreLifting(iter, digit_approximation, state)) {
+				first = iter.position();
+				_r.assign(modulus, state[0]);
+			}
+			for (size_t i=first ; iter != _lcontainer.end() && iter.next(digit_approximation[(size_t)i]);++i) {
 
 #ifdef LIFTING_PROGRESS
 				commentator().progress(i);
@@ -800,7 +906,9 @@ namespace LinBox
 				eval_horner+=eval_horn;
 #endif
 				_r.mulin(modulus,prime);
+				saveLifting(iter, digit_approximation, saveState, false);
 			}
+			saveLifting(iter, digit_approximation, saveState, true);
 
 #ifdef LIFTING_PROGRESS
 			commentator().stop ("Done", "Done", "LinBox::LinBox::LiftingContainer");
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file algorithms/sliced-block-container.h
+ * @ingroup algorithms
+ * @brief Block Wiedemann sequence over GF(3) with the Krylov blocks kept sliced.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+
+#include "linbox/algorithms/blackbox-block-container-base.h"
+#include "linbox/matrix/dense-matrix.h"
+#include "linbox/matrix/sliced3.h"
+#include "linbox/util/debug.h"
+#include "linbox/util/tracer.h"
+
+namespace LinBox {
+
+    /**
+     * \brief Sequence U A^i V over GF(3), for BlockCoppersmithDomain, with A^i V as a Sliced matrix.
+     *
+     * BlackboxBlockContainer keeps A^i V as a BlasMatrix of one element per word.
+     * Here A^i V is row packed, 64 entries in two words, and the blackbox applies to it directly:
+     * SlicedSparse, or PascalBlackbox, whose applyLeft has a Sliced version.
+     * The projection U (A^i V) is a Sliced::mul, made of rows of A^i V added or subtracted,
+     * and only the small b x b result is unpacked into the Value.
+     * Field is the scalar field of GF(3), e.g. Givaro::Modular<int64_t>(3).
+     *
+     * Together with BlockCoppersmithDomain, this gives sliced block Wiedemann:
+     * @code
+     * SlicedBlockContainer<Field, SlicedSparse<Domain>> sequence(&A, F, b, b);
+     * BlockCoppersmithDomain<MatrixDomain<Field>, decltype(sequence)> coppersmith(MD, &sequence, 10);
+     * coppersmith.right_minpoly(generator);
+     * @endcode
+     */
+    template <class _Field, class _Blackbox, class _Word = uint64_t>
+    class SlicedBlockContainer {
+    public:
+        typedef _Field Field;
+        typedef _Blackbox Blackbox;
+        typedef typename Field::Element Element;
+        typedef MatrixDomain<SlicedField<Field, _Word>> SlicedDomain;
+        typedef typename SlicedDomain::Matrix Block;
+        typedef BlasMatrix<Field> Value;
+
+        class const_iterator {
+        public:
+            const_iterator(SlicedBlockContainer& c)
+                : _c(&c)
+            {
+            }
+
+            const_iterator& operator++()
+            {
+                _c->next();
+                return *this;
+            }
+
+            const Value& operator*() const { return _c->_value; }
+
+        private:
+            SlicedBlockContainer* _c;
+        };
+
+        /// Projections given as dense matrices of 0, 1, 2: U is m x n, V is n x b for A n x n.
+        SlicedBlockContainer(const Blackbox* BB, const Field& F, const BlasMatrix<Field>& U, const BlasMatrix<Field>& V)
+            : _field(&F)
+            , _BB(BB)
+            , _U(U)
+            , _X0(_domain, BB->coldim(), V.coldim())
+            , _X1(_domain, BB->rowdim(), V.coldim())
+            , _S(_domain, U.rowdim(), V.coldim())
+            , _value(F, U.rowdim(), V.coldim())
+        {
+            linbox_check(U.coldim() == BB->rowdim() && V.rowdim() == BB->coldim());
+            _X0.zero();
+            for (size_t i = 0; i < V.rowdim(); ++i)
+                for (size_t j = 0; j < V.coldim(); ++j) _X0.setEntry(i, j, V.getEntry(i, j));
+            project();
+        }
+
+        /// Random m x n projection U and n x b block V.
+        SlicedBlockContainer(const Blackbox* BB, const Field& F, size_t m, size_t b, size_t seed = (size_t)time(NULL))
+            : _field(&F)
+            , _BB(BB)
+            , _U(F, m, BB->rowdim())
+            , _X0(_domain, BB->coldim(), b)
+            , _X1(_domain, BB->rowdim(), b)
+            , _S(_domain, m, b)
+            , _value(F, m, b)
+        {
+            typename Field::RandIter G(F, 0, seed);
+            for (size_t i = 0; i < m; ++i)
+                for (size_t j = 0; j < _U.coldim(); ++j) G.random(_U.refEntry(i, j));
+            // Sliced::random is not uniform, the entries of V are drawn one by one.
+            _X0.zero();
+            Element x;
+            for (size_t i = 0; i < _X0.rowdim(); ++i)
+                for (size_t j = 0; j < b; ++j) _X0.setEntry(i, j, G.random(x));
+            project();
+        }
+
+        SlicedBlockContainer(const SlicedBlockContainer&) = delete;
+        SlicedBlockContainer& operator=(const SlicedBlockContainer&) = delete;
+
+        /// The first term U V, each ++ computes the next one.
+        const_iterator begin() { return const_iterator(*this); }
+
+        /// Expected length of the sequence, as for BlackboxBlockContainer.
+        size_t size() const
+        {
+            return std::max(_BB->rowdim() / rowdim(), size_t(1)) + std::max(_BB->coldim() / coldim(), size_t(1))
+                   + __BW_EXTRA_STEPS;
+        }
+
+        const Field& field() const { return *_field; }
+        const Blackbox* getBB() const { return _BB; }
+        size_t rowdim() const { return _value.rowdim(); }
+        size_t coldim() const { return _value.coldim(); }
+
+        /// The current Krylov block A^i V.
+        Block& krylovBlock() { return _odd ? _X1 : _X0; }
+
+    private:
+        void next()
+        {
+            LINBOX_TRACE_COUNT(SpMV, _X0.coldim());
+            if (_odd)
+                _BB->applyLeft(_X0, _X1);
+            else
+                _BB->applyLeft(_X1, _X0);
+            _odd = !_odd;
+            project();
+        }
+
+        void project()
+        {
+            _S.mul(_U, krylovBlock());
+            Element x;
+            for (size_t i = 0; i < _S.rowdim(); ++i)
+                for (size_t j = 0; j < _S.coldim(); ++j) _value.setEntry(i, j, _S.getEntry(x, i, j));
+        }
+
+        SlicedDomain _domain;
+        const Field* _field;
+        const Blackbox* _BB;
+        BlasMatrix<Field> _U;
+        Block _X0, _X1; //!< A^i V alternates between them.
+        bool _odd = false;
+        Block _S;
+        Value _value;
+    };
+}
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -25,7 +25,12 @@
 #ifndef __LINBOX_smith_form_iliopoulos_H
 #define __LINBOX_smith_form_iliopoulos_H
 
+#include <algorithm>
+#include <vector>
+
+#include "linbox/field/field-traits.h"
 #include "linbox/util/debug.h"
+#include "linbox/util/task-pool.h"
 #include "linbox/vector/vector-domain.h"
 #include "linbox/blackbox/submatrix-traits.h"
 
@@ -47,163 +52,165 @@ namespace LinBox
 
 
 	protected:
-		/** \brief eliminationRow will make the first row (*, 0, ..., 0)
-		 *  by col operations.
-		 *  It is the implementation of Iliopoulos algorithm.
-		 *  A Ring has basic ring functions 
-		 *  plus gcd, xgcd, isDivisor, isUnit, normalIn
+		/** \brief The column (resp. row) operations of one elimination step.
+		 *
+		 *  They only depend on the first row (resp. column) v of the matrix,
+		 *  so they are computed once from v, then applied to each row
+		 *  (resp. column) of the matrix independently, in parallel.
 		 */
-		template<class Matrix, class Ring>
-		static Matrix& eliminationRow (Matrix& A, const Ring& r)
-		{
-
-			if (A. coldim() <= 1) return A;
-
+		template<class Ring>
+		struct EliminationStep {
 			typedef typename Ring::Element Element;
 
-			VectorDomain<Ring> vd (r);
-
-			// some tempory variable
-			typename Matrix::RowIterator cur_r, tmp_r;
-
-			typename Matrix::ColIterator cur_c, tmp_c;
-			typename Matrix::Row::iterator row_p1, row_p2;
-			//typename Matrix::Col::iterator col_p1, col_p2;
-
-			cur_c = A. colBegin();
-
-			cur_r = A. rowBegin();
-
-			row_p1 = cur_r -> begin();
-
-			// if A[0][0] is coprime to d
-			if (r. isUnit( *row_p1)) {
-
-				if (! r. isOne (* row_p1)) {
-
-					Element s;
-
-					r. inv (s, *row_p1);
-
-					vd. mulin(*cur_c, s);
-
+			bool unit;		// v[0] is a unit, scaled to 1
+			Element scale;
+			bool twoByTwo;		// v[0] is made 0 by a 2x2 transformation of v[0], v[1]
+			Element y1, y2, s, t;
+			bool reduce;		// then v[0] += q v[1]
+			Element q;
+			bool pivot;		// v[0] = combination . v is the gcd of v
+			std::vector<Element> combination;
+			std::vector<Element> multipliers;	// v[j] += multipliers[j] v[0], for j > 0
+
+			EliminationStep (const Ring& r, std::vector<Element> v) :
+				unit (false), twoByTwo (false), reduce (false), pivot (true),
+				multipliers (v.size(), r.zero)
+			{
+				auto at = [&v](size_t j) -> Element& { return v[j]; };
+				if (r. isUnit (v[0])) {
+					unit = true;
+					r. inv (scale, v[0]);
+					r. assign (v[0], r.one);
 				}
+				else {
+					// make v[0] = 0
+					if (!r. isZero (v[0])) {
+						Element g;
+						twoByTwo = true;
+						r. xgcd (g, s, t, v[0], v[1]);
+						r. div (y2, v[0], g);
+						r. div (y1, v[1], g);
+						r. negin (y1);
+						transform (r, at);
+
+						if (!r. isZero (v[0])) {
+							reduce = true;
+							r. div (q, v[0], g);
+							r. negin (q);
+							r. axpyin (v[0], q, v[1]);
+						}
+					}
 
-			}
-
-			// A[0][0] is not a unit
-			else {
-
-				// make A[0][0] = 0
-				if ( !r.isZero(*row_p1)) {
-
-					row_p2 = row_p1 + 1;
-
-					Element y1, y2;
-
-					Element g, s, t;
-
-					//r. dxgcd (g, s, t, y2, y1, *row_p1, *row_p2);
-					r. xgcd (g, s, t, *row_p1, *row_p2);
-					r.div(y2, *row_p1, g);
-					r.div(y1, *row_p2, g);
-
-					r. negin (y1);
-
-					tmp_c = cur_c + 1;
-
-					std::vector<Element> tmp1 (A.rowdim()), tmp2 (A.rowdim());
-
-					vd. mul (tmp1, *cur_c, y1);
-
-					vd. axpyin (tmp1, y2, *tmp_c);
-
-					vd. mul (tmp2, *cur_c, s);
-
-					vd. axpyin (tmp2, t, *tmp_c);
-
-					vd. copy (*cur_c,  tmp1);
-
-					vd. copy (*tmp_c, tmp2);
-
-					if (!r.isZero (*(cur_c -> begin()))) {
-
-						Element q;
+					// matrix index is 0-based
+					combination. resize (v.size());
+					r. assign (combination[0], r.one);
+					r. assign (combination[1], r.one);
+					Element g, c;
+					r. assign (g, v[1]);
+					for (size_t j = 2; j < v.size(); ++ j) {
+						r. xgcd (g, c, combination[j], g, v[j]);
+						if (!r. isOne (c))
+							for (size_t k = 1; k < j; ++ k)
+								r. mulin (combination[k], c);
+					}
 
-						r. div (q, *(cur_c -> begin()), g);
+					// no pivot found
+					if (r. isZero (g)) {
+						pivot = false;
+						return;
+					}
 
-						r. negin (q);
+					combine (r, at, v.size());
+				}
 
-						vd. axpyin (*cur_c, q, *tmp_c);
+				// after finding the pivot, make v[j] = 0 for j > 0
+				for (size_t j = 1; j < v.size(); ++ j) {
+					if (!r. isZero (v[j])) {
+						r. div (multipliers[j], v[j], v[0]);
+						r. negin (multipliers[j]);
 					}
 				}
+			}
 
-				// matrix index is 0-based
-				std::vector<Element> tmp_v(A.coldim());
-
-				typename std::vector<Element>::iterator p1, p2;
-
-				r. assign(tmp_v[0], r.one);
-
-				p1 = tmp_v.begin() + 1;
-				p2 = tmp_v.begin() + 1;
-
-				row_p2 = row_p1 + 1;
-
-				Element g, s;
-
-				r.assign(g, *row_p2); ++ row_p2;
-
-				r.assign(*p1, r.one); ++ p1;
-
-				for (; row_p2 != cur_r -> end(); ++ row_p2, ++ p1) {
-
-					r.xgcd(g, s, *p1, g, *row_p2);
-
-					if (!r.isOne(s))
-
-						for (p2 = tmp_v.begin() + 1; p2 != p1; ++ p2)
-
-							r. mulin (*p2, s);
-
+			// x(j) is a reference to the entry j of the row (resp. column).
+			template<class Entries>
+			void transform (const Ring& r, Entries x) const
+			{
+				Element tmp1, tmp2;
+				r. mul (tmp1, x(0), y1);
+				r. axpyin (tmp1, y2, x(1));
+				r. mul (tmp2, x(0), s);
+				r. axpyin (tmp2, t, x(1));
+				r. assign (x(0), tmp1);
+				r. assign (x(1), tmp2);
+			}
 
+			template<class Entries>
+			void combine (const Ring& r, Entries x, size_t n) const
+			{
+				Element acc;
+				r. assign (acc, r.zero);
+				for (size_t j = 0; j < n; ++ j)
+					r. axpyin (acc, combination[j], x(j));
+				r. assign (x(0), acc);
+			}
 
+			/// Applies the whole step, in place, to a row (resp. column) of n entries of the matrix.
+			template<class Entries>
+			void apply (const Ring& r, Entries x, size_t n) const
+			{
+				if (unit) {
+					r. mulin (x(0), scale);
+				}
+				else {
+					if (twoByTwo) {
+						transform (r, x);
+						if (reduce) r. axpyin (x(0), q, x(1));
+					}
+					if (!pivot) return;
+					combine (r, x, n);
 				}
 
-				// no pivot found
-				if (r.isZero(g)) return A;
-
-
-				for (tmp_r = cur_r; tmp_r != A.rowEnd(); ++ tmp_r)
-
-					vd. dot (*(tmp_r -> begin()), *tmp_r, tmp_v);
-
-
+				for (size_t j = 1; j < n; ++ j)
+					if (!r. isZero (multipliers[j]))
+						r. axpyin (x(j), multipliers[j], x(0));
 			}
+		};
 
+		// Rows (resp. columns) of n entries per task.
+		static size_t panelGrain (size_t n)
+		{
+			return std::max<size_t> (1, 4096 / std::max<size_t> (1, n));
+		}
 
-			// after finding the pivot
-			// column operation to make A[p][(size_t)j] = 0, where k < j
-
-
-			Element g, tmp;
-
-			r. assign (g, *(cur_c -> begin()));
-
-			for (tmp_c = cur_c + 1; tmp_c != A.colEnd(); ++ tmp_c) {
-
-				// test if needing to update
-				if (!r. isZero (*(tmp_c -> begin()))) {
-
-					r.div (tmp, *(tmp_c -> begin()), g);
+		/** \brief eliminationRow will make the first row (*, 0, ..., 0)
+		 *  by col operations.
+		 *  It is the implementation of Iliopoulos algorithm.
+		 *  A Ring has basic ring functions
+		 *  plus gcd, xgcd, isDivisor, isUnit, normalIn
+		 *
+		 *  The col operations are computed from the first row,
+		 *  then applied to blocks of rows in parallel.
+		 */
+		template<class Matrix, class Ring>
+		static Matrix& eliminationRow (Matrix& A, const Ring& r)
+		{
 
-					r.negin(tmp);
+			if (A. coldim() <= 1) return A;
 
-					vd. axpyin (*tmp_c, tmp, *cur_c);
+			typedef typename Ring::Element Element;
 
-				}
-			}
+			const size_t n = A. coldim();
+			std::vector<Element> v (n);
+			for (size_t j = 0; j < n; ++ j)
+				r. assign (v[j], A. refEntry (0, j));
+			const EliminationStep<Ring> step (r, v);
 
+			const ThreadContext<Ring> context (r);
+			TaskPool::current(). parallelFor (0, A. rowdim(), panelGrain (n), [&](size_t i) {
+				context. restore();
+				step. apply (r, [&A, i](size_t j) -> Element& { return A. refEntry (i, j); }, n);
+			});
 
 			return A;
 		}
@@ -213,152 +220,29 @@ namespace LinBox
 		/** \brief eliminationCol will make the first col (*, 0, ..., 0)
 		 *  by elementary row operation.
 		 *  It is the implementation of Iliopoulos algorithm
+		 *
+		 *  The row operations are computed from the first col,
+		 *  then applied to blocks of cols in parallel.
 		 */
 		template<class Matrix, class Ring>
 		static Matrix& eliminationCol (Matrix& A, const Ring& r)
 		{
 
-			if((A.rowdim() <= 1) || (A.rowdim() == 0)) return A;
+			if (A.rowdim() <= 1) return A;
 
-			//typedef typename Matrix::Field Field;
 			typedef typename Ring::Element Element;
 
-			//Field r (A.field());
-
-			VectorDomain<Ring> vd(r);
-
-			typename Matrix::ColIterator cur_c, tmp_c;
-			typename Matrix::RowIterator cur_r, tmp_r;
-
-			//typename Matrix::Row::iterator row_p1, row_p2;
-			typename Matrix::Col::iterator col_p1, col_p2;
-
-
-			cur_c = A.colBegin();
-			cur_r = A.rowBegin();
-
-			col_p1 = cur_c -> begin();
-
-
-			// If A[0][0] is a unit
-			if (r.isUnit (*col_p1) ) {
-
-				if (! r. isOne ( *col_p1)) {
-
-
-					Element s;
-
-					r. inv (s, *col_p1);
-
-					vd. mulin (*cur_r, s);
-
-				}
-
-			}
-			else {
-				// Make A[0][0] = 0;
-				if (!r.isZero(*col_p1)) {
-
-					Element g, s, t, y1, y2;
-
-					std::vector<Element> tmp1(A.coldim()), tmp2(A.coldim());
-
-					col_p2 = col_p1 + 1;
-
-					//r.dxgcd(g, s, t, y2, y1, *col_p1, *col_p2);
-					r. xgcd (g, s, t, *col_p1, *col_p2);
-					r.div(y2, *col_p1, g);
-					r.div(y1, *col_p2, g);
-
-					r. negin (y1);
-
-
-					tmp_r = cur_r + 1;
-
-					vd. mul (tmp1, *cur_r, y1);
-
-					vd. axpyin (tmp1, y2, *tmp_r);
-
-					vd. mul (tmp2, *cur_r, s);
-
-					vd. axpyin (tmp2, t, *tmp_r);
-
-					vd. copy (*cur_r, tmp1);
-
-					vd. copy (*tmp_r, tmp2);
-
-					if ( !r. isZero (* (cur_r ->begin() ) ) ) {
-
-						Element q;
-
-						r. div (q, *(cur_r -> begin() ), g);
-
-						r. negin (q);
-
-						vd. axpyin (*cur_r, q, *tmp_r);
-					}
-
-				}
-
-
-				// matrix index is 0-based
-				std::vector<Element> tmp_v (A.rowdim());
-
-				typename std::vector<Element>::iterator p1, p2;
-
-				Element g, s;
-
-				col_p2 = col_p1 + 1;
-
-				r.assign (g, *col_p2); ++ col_p2;
-
-				r. assign(tmp_v[0], r.one);
-
-				p1 = tmp_v.begin() + 1;
-
-				r.assign(*p1,r.one); ++ p1;
-
-				for(; col_p2 != cur_c -> end(); ++ col_p2, ++ p1) {
-
-					r.xgcd (g, s, *p1, g, *col_p2);
-
-					if (! r.isOne(s))
-						for (p2 = tmp_v.begin() + 1; p2 != p1; ++ p2)
-
-							r. mulin (*p2, s);
-
-
-				}
-
-				if (r.isZero(g))  return A;
-
-				// no pivot found
-				for (tmp_c = cur_c; tmp_c != A.colEnd(); ++ tmp_c)
-
-					vd. dot ( *(tmp_c -> begin()), *tmp_c, tmp_v);
-
-			}
-
-
-			// A pivot is found
-
-			Element g, tmp;
-
-			r. assign (g, *( cur_r -> begin()));
-
-			for (tmp_r = cur_r + 1; tmp_r != A.rowEnd(); ++ tmp_r) {
-
-				if (! r.isZero(*(tmp_r -> begin() ) ) ) {
-
-					r.div (tmp, *(tmp_r -> begin()), g);
-
-					r.negin (tmp);
-
-					vd. axpyin (*tmp_r, tmp, *cur_r);
-
-				}
-			}
-
+			const size_t m = A. rowdim();
+			std::vector<Element> v (m);
+			for (size_t i = 0; i < m; ++ i)
+				r. assign (v[i], A. refEntry (i, 0));
+			const EliminationStep<Ring> step (r, v);
+
+			const ThreadContext<Ring> context (r);
+			TaskPool::current(). parallelFor (0, A. coldim(), panelGrain (m), [&](size_t j) {
+				context. restore();
+				step. apply (r, [&A, j](size_t i) -> Element& { return A. refEntry (i, j); }, m);
+			});
 
 			return A;
 
@@ -23,9 +23,13 @@
  *.
  */
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
+#include "linbox/field/field-traits.h"
 #include "linbox/matrix/densematrix/blas-matrix.h"
 #include "linbox/matrix/matrixdomain/matrix-domain.h"
+#include "linbox/util/task-pool.h"
 
 #ifndef __LINBOX_smith_form_kannan_bachem_domain_H
 #define __LINBOX_smith_form_kannan_bachem_domain_H
@@ -118,39 +122,68 @@ namespace LinBox
 			return false;
 		}
 		
-		template<class Matrix>
-		void eliminateRow1(Matrix &A, size_t idx) {
-			Element pivot, other;
-			
-			A.getEntry(other, 0, idx);
-			
-			if (_F.isZero(other)) {
-				return;
-			}
-			
-			A.getEntry(pivot, 0, 0);
-			
+		// 2x2 transformation (pivot, other) <- (s pivot + t other, u other + v pivot)
+		// of the pivot with the entry idx of the first row (resp. col).
+		struct Transformation {
+			size_t idx;
 			Element s, t, u, v;
-			dxgcd(s,t,u,v,pivot,other);
-			_F.negin(v);
-			
-			SubMatrix pivotCol(A, 0, 0, A.rowdim(), 1);
-			SubMatrix otherCol(A, 0, idx, A.rowdim(), 1);
-			
-			OwnMatrix pivotCopy(pivotCol);
-			
-			_MD.mulin(pivotCol, s);
-			_MD.saxpyin(pivotCol, t, otherCol);
-			
-			_MD.mulin(otherCol, u);
-			_MD.saxpyin(otherCol, v, pivotCopy);
+		};
+		
+		// The transformations eliminating x[1], x[2], ... one after the other
+		// with the pivot x[0]. They only depend on x: the first row (resp. col)
+		// gives all of them, then they are applied to the other rows (resp. cols).
+		std::vector<Transformation> eliminationChain(std::vector<Element> &x) const {
+			std::vector<Transformation> chain;
+			for (size_t idx = 1; idx < x.size(); idx++) {
+				if (_F.isZero(x[idx])) {
+					continue;
+				}
+				
+				Transformation T;
+				T.idx = idx;
+				dxgcd(T.s, T.t, T.u, T.v, x[0], x[idx]);
+				_F.negin(T.v);
+				apply(T, x[0], x[idx]);
+				chain.push_back(T);
+			}
+			return chain;
 		}
 		
+		void apply(const Transformation &T, Element &pivot, Element &other) const {
+			Element tmp;
+			_F.mul(tmp, T.s, pivot);
+			_F.axpyin(tmp, T.t, other);
+			_F.mulin(other, T.u);
+			_F.axpyin(other, T.v, pivot);
+			_F.assign(pivot, tmp);
+		}
+		
+		// Rows (resp. cols) of n entries per task.
+		static size_t panelGrain(size_t n) {
+			return std::max<size_t>(1, 4096 / std::max<size_t>(1, n));
+		}
+		
+		// Col operations, computed from the first row, applied by blocks of rows in parallel.
 		template<class Matrix>
 		void eliminateRow(Matrix &A) {
-			for (size_t i = 1; i < A.coldim(); i++) {
-				eliminateRow1(A, i);
+			if (A.coldim() <= 1) {
+				return;
+			}
+			
+			std::vector<Element> x(A.coldim());
+			for (size_t j = 0; j < A.coldim(); j++) {
+				_F.assign(x[j], A.getEntry(0, j));
 			}
+			const std::vector<Transformation> chain = eliminationChain(x);
+			
+			const ThreadContext<Field> context(_F);
+			TaskPool::current().parallelFor(0, A.rowdim(), panelGrain(A.coldim()), [&](size_t i) {
+				context.restore();
+				Element &pivot = A.refEntry(i, 0);
+				for (const Transformation &T : chain) {
+					apply(T, pivot, A.refEntry(i, T.idx));
+				}
+			});
 		}
 		
 		template<class Matrix>
@@ -160,39 +193,30 @@ namespace LinBox
 			}
 		}
 		
+		// Row operations, computed from the first col, applied by blocks of cols in parallel.
 		template<class Matrix>
-		void eliminateCol1(Matrix &A, size_t idx) {
-			Element pivot, other;
-			
-			A.getEntry(other, idx, 0);
-			
-			if (_F.isZero(other)) {
+		void eliminateCol(Matrix &A) {
+			if (A.rowdim() <= 1) {
 				return;
 			}
 			
-			A.getEntry(pivot, 0, 0);
-			
-			Element s, t, u, v;
-			dxgcd(s,t,u,v,pivot,other);
-			_F.negin(v);
-			
-			SubMatrix pivotRow(A, 0, 0, 1, A.coldim());
-			SubMatrix otherRow(A, idx, 0, 1, A.coldim());
-			
-			OwnMatrix pivotCopy(pivotRow);
-			
-			_MD.mulin(pivotRow, s);
-			_MD.saxpyin(pivotRow, t, otherRow);
-			
-			_MD.mulin(otherRow, u);
-			_MD.saxpyin(otherRow, v, pivotCopy);
-		}
-		
-		template<class Matrix>
-		void eliminateCol(Matrix &A) {
-			for (size_t i = 1; i < A.rowdim(); i++) {
-				eliminateCol1(A, i);
+			std::vector<Element> x(A.rowdim());
+			for (size_t i = 0; i < A.rowdim(); i++) {
+				_F.assign(x[i], A.getEntry(i, 0));
 			}
+			const std::vector<Transformation> chain = eliminationChain(x);
+			
+			const size_t n = A.coldim(), block = panelGrain(A.rowdim());
+			const ThreadContext<Field> context(_F);
+			TaskPool::current().parallelFor(0, (n + block - 1) / block, 1, [&](size_t b) {
+				context.restore();
+				const size_t first = b * block, last = std::min(n, first + block);
+				for (const Transformation &T : chain) {
+					for (size_t j = first; j < last; j++) {
+						apply(T, A.refEntry(0, j), A.refEntry(T.idx, j));
+					}
+				}
+			});
 		}
 		
 		template<class Matrix>
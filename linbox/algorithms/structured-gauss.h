@@ -0,0 +1,497 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file algorithms/structured-gauss.h
+ * @ingroup algorithms
+ * @brief Structured Gaussian elimination: pruning of a sparse matrix before rank, det, solve or nullspace.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "linbox/algorithms/gauss/gauss-ordering.h"
+#include "linbox/algorithms/matrix-hom.h"
+#include "linbox/matrix/sparse-matrix.h"
+#include "linbox/util/error.h"
+#include "linbox/util/task-pool.h"
+#include "linbox/util/tracer.h"
+#include "linbox/vector/blas-vector.h"
+
+namespace LinBox {
+
+    /**
+     * \brief Structured Gaussian elimination of a sparse matrix A: the pivots which cost no
+     * or little fill-in are taken first, leaving a smaller matrix, reduced().
+     *
+     * Until none is left:
+     * - empty rows and columns are dropped,
+     * - a column with one entry is a pivot; its row is removed,
+     * - a row with one entry is a pivot; its column is removed from the other rows,
+     * - a column with two entries is a pivot in the shorter of its rows,
+     *   which is added to the other one; the number of entries does not grow,
+     * - a row which is a multiple of another one is dropped; the rows are
+     *   hashed by their columns on the TaskPool, then compared by their values normalized to a leading one.
+     *
+     * Each pass costs O(entries), up to the merges of the rows of the two entry columns.
+     * With P the pivots and S = reduced(), the Schur complement of the pivots, in the order of the rows
+     * and columns of A:
+     * - rank(A) = |P| + rank(S), see rank(),
+     * - det(A) = +-product(P) det(S), or zero if a row or column was dropped, see det(),
+     * - a solution of Ax = b, or a basis of the nullspace of A, follow from those of S
+     *   by back substitution on the pivot rows, see solve() and nullspace().
+     *
+     * @bib
+     * - B. A. LaMacchia and A. M. Odlyzko, <i>Solving large sparse linear systems over finite fields</i>.
+     * In CRYPTO'90, LNCS 537, pages 109--133.
+     */
+    template <class _Field>
+    class StructuredGauss {
+    public:
+        typedef _Field Field;
+        typedef typename Field::Element Element;
+        typedef SparseMatrix<Field, SparseMatrixFormat::SparseSeq> Matrix;
+        typedef typename Matrix::Row Row;
+
+        StructuredGauss(const Field& F)
+            : _field(&F)
+            , _reduced(F)
+        {
+        }
+
+        const Field& field() const { return *_field; }
+
+        /// Prunes a copy of A, of any sparse or blackbox format which MatrixHom maps.
+        template <class _Matrix>
+        void reduce(const _Matrix& A, TaskPool& pool = TaskPool::current())
+        {
+            Matrix copyA(field(), A.rowdim(), A.coldim());
+            MatrixHom::map(copyA, A);
+            reduceInPlace(copyA, pool);
+        }
+
+        /// Prunes A, whose rows are moved away.
+        void reduceInPlace(Matrix& A, TaskPool& pool = TaskPool::current());
+
+        size_t rowdim() const { return _rowdim; }
+        size_t coldim() const { return _coldim; }
+
+        /// The matrix left once the pivots are eliminated; its rows and columns are
+        /// those of A given by rowIndex() and colIndex().
+        const Matrix& reduced() const { return _reduced; }
+        Matrix& reduced() { return _reduced; }
+        size_t rowIndex(size_t i) const { return _rowIndex[i]; }
+        size_t colIndex(size_t j) const { return _colIndex[j]; }
+
+        size_t pivots() const { return _pivots.size(); }
+        size_t droppedRows() const { return _droppedRows.size(); }
+        size_t droppedColumns() const { return _droppedColumns.size(); }
+
+        /// Whether reduced() is at most 9/10 of A, in rows plus columns.
+        bool paysOff() const { return 10 * (_reduced.rowdim() + _reduced.coldim()) <= 9 * (_rowdim + _coldim); }
+
+        /**
+         * Whether reduce(A) may pay off, from the numbers of entries of the rows and columns of A,
+         * before A is copied: each row with at most one entry and each column with at most two
+         * removes at most a row and a column in the first pass, which must reach 1/10 of A.
+         */
+        template <class _Matrix>
+        static bool mayPayOff(const _Matrix& A)
+        {
+            std::vector<size_t> rowCount(A.rowdim(), 0), colCount(A.coldim(), 0);
+            for (typename _Matrix::ConstIndexedIterator it = A.IndexedBegin(); it != A.IndexedEnd(); ++it) {
+                ++rowCount[it.rowIndex()];
+                ++colCount[it.colIndex()];
+            }
+            size_t candidates = 0;
+            for (size_t c : rowCount)
+                if (c <= 1) ++candidates;
+            for (size_t c : colCount)
+                if (c <= 2) ++candidates;
+            return 20 * candidates >= A.rowdim() + A.coldim();
+        }
+
+        /// Whether det(A) is zero from the pruning alone: A is not square, or a row or column was dropped.
+        bool singular() const { return _rowdim != _coldim || !_droppedRows.empty() || !_droppedColumns.empty(); }
+
+        /// Rank of A from the rank of reduced().
+        size_t rank(size_t reducedRank) const { return _pivots.size() + reducedRank; }
+
+        /// Determinant of A from the determinant of reduced(), one if reduced() is empty.
+        Element& det(Element& d, const Element& reducedDet) const
+        {
+            if (singular()) return field().assign(d, field().zero);
+            return field().mul(d, _detFactor, reducedDet);
+        }
+
+        /**
+         * \brief x = a solution of Ax = b, from solveReduced(y, c),
+         * a solution of reduced() y = c on BlasVector<Field>s, called if reduced() is not empty.
+         * The dropped columns are zero.
+         * @throws LinboxMathInconsistentSystem if a dropped row shows that Ax = b has no solution.
+         */
+        template <class Vector1, class Vector2, class Solver>
+        Vector1& solve(Vector1& x, const Vector2& b, Solver&& solveReduced) const;
+
+        /**
+         * \brief N = a basis of the nullspace of A, from NS, a basis of the nullspace of reduced(),
+         * one vector per column. N is coldim() x (NS.coldim() + droppedColumns()).
+         */
+        template <class Block1, class Block2>
+        Block1& nullspace(Block1& N, const Block2& NS) const;
+
+    private:
+        struct Pivot {
+            size_t row, col;
+            Row entries; //!< The pivot row, when its pivot is taken.
+        };
+        struct RowOperation {
+            size_t target, source;
+            Element factor; //!< row target += factor * row source
+        };
+
+        // The values of the pivot columns, from those of the other columns, for right hand side c.
+        void backSubstitute(std::vector<Element>& x, const std::vector<Element>& c) const;
+
+        const Field* _field;
+        size_t _rowdim = 0, _coldim = 0;
+        Matrix _reduced;
+        std::vector<size_t> _rowIndex, _colIndex;
+        std::vector<Pivot> _pivots;
+        std::vector<RowOperation> _operations;
+        std::vector<size_t> _droppedRows, _droppedColumns;
+        Element _detFactor;
+    };
+
+    template <class _Field>
+    void StructuredGauss<_Field>::reduceInPlace(Matrix& A, TaskPool& pool)
+    {
+        typedef typename Row::value_type E;
+        const Field& F = field();
+        LINBOX_TRACE_SPAN("structured gauss");
+
+        const size_t Ni = _rowdim = A.rowdim(), Nj = _coldim = A.coldim();
+        _pivots.clear();
+        _operations.clear();
+        _droppedRows.clear();
+        _droppedColumns.clear();
+
+        std::vector<bool> rowAlive(Ni, true), colAlive(Nj, true);
+        std::vector<size_t> colCount(Nj, 0);
+        std::vector<std::vector<size_t>> colRows(Nj);
+        for (size_t i = 0; i < Ni; ++i)
+            for (const E& e : A[i]) {
+                ++colCount[e.first];
+                colRows[e.first].push_back(i);
+            }
+
+        // Rows and columns which may have become small enough for a pivot or a drop
+        std::vector<size_t> rowWork, colWork;
+        for (size_t i = 0; i < Ni; ++i)
+            if (A[i].size() <= 1) rowWork.push_back(i);
+        for (size_t j = 0; j < Nj; ++j)
+            if (colCount[j] <= 2) colWork.push_back(j);
+
+        auto find = [&A](size_t i, size_t j) {
+            const Row& row = A[i];
+            auto it = std::lower_bound(row.begin(), row.end(), j, [](const E& e, size_t c) { return e.first < c; });
+            return (it != row.end() && it->first == j) ? (size_t)(it - row.begin()) : row.size();
+        };
+
+        // The live rows with an entry in column j, once each: the list of the column is cleaned.
+        std::vector<size_t> stamp(Ni, (size_t)-1);
+        size_t tag = 0;
+        auto liveRows = [&](size_t j) -> const std::vector<size_t>& {
+            std::vector<size_t>& l = colRows[j];
+            size_t n = 0;
+            ++tag;
+            for (size_t i : l)
+                if (stamp[i] != tag && rowAlive[i] && find(i, j) < A[i].size()) {
+                    stamp[i] = tag;
+                    l[n++] = i;
+                }
+            l.resize(n);
+            return l;
+        };
+
+        // Row i leaves the matrix, as a pivot row or dropped.
+        auto removeRow = [&](size_t i) {
+            rowAlive[i] = false;
+            for (const E& e : A[i])
+                if (--colCount[e.first] <= 2 && colAlive[e.first]) colWork.push_back(e.first);
+        };
+        auto addPivot = [&](size_t i, size_t j) {
+            _pivots.push_back(Pivot{i, j, A[i]});
+            colAlive[j] = false;
+            removeRow(i);
+            std::vector<size_t>().swap(colRows[j]);
+        };
+
+        Row merged;
+        Element factor, tmp;
+        bool changed = true;
+        while (changed) {
+            while (!rowWork.empty() || !colWork.empty()) {
+                if (!rowWork.empty()) {
+                    const size_t i = rowWork.back();
+                    rowWork.pop_back();
+                    if (!rowAlive[i] || A[i].size() > 1) continue;
+                    if (A[i].empty()) {
+                        rowAlive[i] = false;
+                        _droppedRows.push_back(i);
+                        continue;
+                    }
+
+                    // Row singleton: column j is removed from the other rows.
+                    const size_t j = A[i][0].first;
+                    for (size_t l : liveRows(j)) {
+                        if (l == i) continue;
+                        const size_t t = find(l, j);
+                        F.divin(F.neg(factor, A[l][t].second), A[i][0].second);
+                        _operations.push_back(RowOperation{l, i, factor});
+                        A[l].erase(A[l].begin() + (ptrdiff_t)t);
+                        if (A[l].size() <= 1) rowWork.push_back(l);
+                    }
+                    colCount[j] = 1;
+                    addPivot(i, j);
+                    continue;
+                }
+
+                const size_t j = colWork.back();
+                colWork.pop_back();
+                if (!colAlive[j] || colCount[j] > 2) continue;
+                if (colCount[j] == 0) {
+                    colAlive[j] = false;
+                    _droppedColumns.push_back(j);
+                    continue;
+                }
+                const std::vector<size_t>& rows = liveRows(j);
+                if (colCount[j] == 1) {
+                    // Column singleton: its row goes, nothing else changes.
+                    addPivot(rows[0], j);
+                    continue;
+                }
+
+                // Two entries: the shorter row p is the pivot, added to the other one, l.
+                size_t p = rows[0], l = rows[1];
+                if (A[l].size() < A[p].size()) std::swap(p, l);
+                const Row& rowp = A[p];
+                Row& rowl = A[l];
+                const size_t tp = find(p, j), tl = find(l, j);
+                F.divin(F.neg(factor, rowl[tl].second), rowp[tp].second);
+                _operations.push_back(RowOperation{l, p, factor});
+
+                merged.clear();
+                size_t a = 0, b = 0;
+                while (a < rowl.size() || b < rowp.size()) {
+                    if (a == tl) {
+                        ++a;
+                        continue;
+                    }
+                    if (b == tp) {
+                        ++b;
+                        continue;
+                    }
+                    if (b == rowp.size() || (a < rowl.size() && rowl[a].first < rowp[b].first)) {
+                        merged.push_back(rowl[a++]);
+                    }
+                    else if (a == rowl.size() || rowp[b].first < rowl[a].first) {
+                        const size_t k = rowp[b].first;
+                        F.mul(tmp, factor, rowp[b++].second);
+                        merged.push_back(E(k, tmp));
+                        ++colCount[k];
+                        colRows[k].push_back(l);
+                    }
+                    else {
+                        F.axpy(tmp, factor, rowp[b++].second, rowl[a].second);
+                        if (!F.isZero(tmp))
+                            merged.push_back(E(rowl[a].first, tmp));
+                        else
+                            --colCount[rowl[a].first];
+                        ++a;
+                    }
+                }
+                std::swap(rowl, merged);
+                if (rowl.size() <= 1) rowWork.push_back(l);
+                addPivot(p, j);
+            }
+
+            // Rows which are multiples of another one
+            std::vector<size_t> live;
+            for (size_t i = 0; i < Ni; ++i)
+                if (rowAlive[i]) live.push_back(i);
+            std::vector<size_t> hash(live.size());
+            std::vector<Element> lead(live.size());
+            pool.parallelFor(0, live.size(), 0, [&](size_t k) {
+                const Row& row = A[live[k]];
+                F.inv(lead[k], row[0].second);
+                size_t h = row.size();
+                for (const E& e : row) h = h * 1000003 + e.first;
+                hash[k] = h;
+            });
+            std::vector<size_t> byHash(live.size());
+            for (size_t k = 0; k < live.size(); ++k) byHash[k] = k;
+            std::sort(byHash.begin(), byHash.end(), [&](size_t a, size_t b) {
+                return hash[a] != hash[b] ? hash[a] < hash[b] : live[a] < live[b];
+            });
+
+            changed = false;
+            Element u, v;
+            for (size_t s = 0; s < byHash.size();) {
+                size_t e = s + 1;
+                while (e < byHash.size() && hash[byHash[e]] == hash[byHash[s]]) ++e;
+                // Within a group of equal hashes, each row is compared with the first ones
+                for (size_t k = s + 1; k < e; ++k) {
+                    const size_t ik = live[byHash[k]];
+                    for (size_t r = s; r < std::min(k, s + 8); ++r) {
+                        const size_t ir = live[byHash[r]];
+                        if (!rowAlive[ir] || A[ir].size() != A[ik].size()) continue;
+                        bool same = true;
+                        for (size_t t = 0; same && t < A[ik].size(); ++t) {
+                            F.mul(u, A[ik][t].second, lead[byHash[k]]);
+                            F.mul(v, A[ir][t].second, lead[byHash[r]]);
+                            same = A[ik][t].first == A[ir][t].first && F.areEqual(u, v);
+                        }
+                        if (!same) continue;
+                        // row ik - (A[ik][0] / A[ir][0]) row ir = 0
+                        F.mul(factor, A[ik][0].second, lead[byHash[r]]);
+                        F.negin(factor);
+                        _operations.push_back(RowOperation{ik, ir, factor});
+                        removeRow(ik);
+                        _droppedRows.push_back(ik);
+                        changed = true;
+                        break;
+                    }
+                }
+                s = e;
+            }
+        }
+
+        // The remaining rows and columns, in their order in A
+        _rowIndex.clear();
+        _colIndex.clear();
+        std::vector<size_t> newIndex(Nj, 0);
+        for (size_t j = 0; j < Nj; ++j)
+            if (colAlive[j]) {
+                newIndex[j] = _colIndex.size();
+                _colIndex.push_back(j);
+            }
+        for (size_t i = 0; i < Ni; ++i)
+            if (rowAlive[i]) _rowIndex.push_back(i);
+
+        _reduced.resize(_rowIndex.size(), _colIndex.size());
+        for (size_t k = 0; k < _rowIndex.size(); ++k) {
+            Row& row = A[_rowIndex[k]];
+            for (E& e : row) e.first = newIndex[e.first];
+            std::swap(_reduced[k], row);
+        }
+        for (size_t i = 0; i < Ni; ++i) Row().swap(A[i]);
+
+        // det(A) = sign(rows) sign(columns) * product of the pivots * det(reduced())
+        F.assign(_detFactor, F.one);
+        if (!singular()) {
+            std::vector<size_t> rowPerm, colPerm;
+            for (const Pivot& P : _pivots) {
+                rowPerm.push_back(P.row);
+                colPerm.push_back(P.col);
+                F.mulin(_detFactor, P.entries[(size_t)(std::lower_bound(P.entries.begin(), P.entries.end(), P.col,
+                                                                        [](const E& e, size_t c) { return e.first < c; })
+                                                       - P.entries.begin())]
+                                        .second);
+            }
+            rowPerm.insert(rowPerm.end(), _rowIndex.begin(), _rowIndex.end());
+            colPerm.insert(colPerm.end(), _colIndex.begin(), _colIndex.end());
+            if (isOddPermutation(rowPerm) != isOddPermutation(colPerm)) F.negin(_detFactor);
+        }
+    }
+
+    template <class _Field>
+    void StructuredGauss<_Field>::backSubstitute(std::vector<Element>& x, const std::vector<Element>& c) const
+    {
+        // A pivot row only has entries in the columns of later pivots, of reduced() and dropped columns.
+        Element s, pivot;
+        for (size_t k = _pivots.size(); k-- > 0;) {
+            const Pivot& P = _pivots[k];
+            field().assign(s, c[P.row]);
+            for (const auto& e : P.entries) {
+                if (e.first == P.col)
+                    field().assign(pivot, e.second);
+                else
+                    field().maxpyin(s, e.second, x[e.first]);
+            }
+            field().div(x[P.col], s, pivot);
+        }
+    }
+
+    template <class _Field>
+    template <class Vector1, class Vector2, class Solver>
+    Vector1& StructuredGauss<_Field>::solve(Vector1& x, const Vector2& b, Solver&& solveReduced) const
+    {
+        const Field& F = field();
+        std::vector<Element> c(_rowdim);
+        for (size_t i = 0; i < _rowdim; ++i) F.assign(c[i], b[i]);
+        for (const RowOperation& op : _operations) F.axpyin(c[op.target], op.factor, c[op.source]);
+        for (size_t i : _droppedRows)
+            if (!F.isZero(c[i])) throw LinboxMathInconsistentSystem("From structured Gaussian elimination.");
+
+        std::vector<Element> z(_coldim, F.zero);
+        if (_reduced.rowdim() > 0 && _reduced.coldim() > 0) {
+            BlasVector<Field> cr(F, _reduced.rowdim()), y(F, _reduced.coldim());
+            for (size_t k = 0; k < _rowIndex.size(); ++k) F.assign(cr[k], c[_rowIndex[k]]);
+            solveReduced(y, cr);
+            for (size_t k = 0; k < _colIndex.size(); ++k) F.assign(z[_colIndex[k]], y[k]);
+        }
+        backSubstitute(z, c);
+        for (size_t j = 0; j < _coldim; ++j) F.assign(x[j], z[j]);
+        return x;
+    }
+
+    template <class _Field>
+    template <class Block1, class Block2>
+    Block1& StructuredGauss<_Field>::nullspace(Block1& N, const Block2& NS) const
+    {
+        const Field& F = field();
+        const std::vector<Element> c(_rowdim, F.zero);
+        std::vector<Element> z(_coldim);
+        Element v;
+        const size_t k = NS.coldim();
+        for (size_t t = 0; t < k + _droppedColumns.size(); ++t) {
+            std::fill(z.begin(), z.end(), F.zero);
+            if (t < k)
+                for (size_t r = 0; r < _colIndex.size(); ++r) NS.getEntry(z[_colIndex[r]], r, t);
+            else
+                F.assign(z[_droppedColumns[t - k]], F.one);
+            backSubstitute(z, c);
+            for (size_t j = 0; j < _coldim; ++j) N.setEntry(j, t, F.assign(v, z[j]));
+        }
+        return N;
+    }
+}
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
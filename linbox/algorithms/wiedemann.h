@@ -71,11 +71,13 @@
 #include "linbox/blackbox/squarize.h"
 #include "linbox/matrix/sparse-matrix.h"
 #include "linbox/util/debug.h"
+#include "linbox/util/tracer.h"
 #include "linbox/vector/vector-domain.h"
 #include "linbox/solutions/methods.h"
 
 #include "linbox/algorithms/blackbox-container.h"
 #include "linbox/algorithms/blackbox-container-symmetric.h"
+#include "linbox/algorithms/blackbox-multi-container.h"
 
 // massey recurring sequence solver
 #include "linbox/algorithms/massey-domain.h"
@@ -93,6 +95,7 @@ namespace LinBox
 		typedef typename Blackbox::Field Field;
 		typename Field::RandIter i (A.field());
 		size_t            deg;
+		const size_t numProjections = M.numProjections;
 
 		commentator().start ("Wiedemann Minimal polynomial", "minpoly");
 
@@ -112,6 +115,14 @@ namespace LinBox
 
 			WD.minpoly (P, deg);
 		}
+		else if (numProjections > 1) {
+			// Several projections of the same Krylov sequence, for small fields
+			typedef BlackboxMultiContainer<Field, Blackbox> BBContainer;
+			BBContainer TF (&A, A.field(), i, numProjections);
+			MultiMasseyDomain< Field, BBContainer > WD (&TF, M.earlyTerminationThreshold);
+
+			WD.minpoly (P, deg);
+		}
 		else {
 			typedef BlackboxContainer<Field, Blackbox> BBContainer;
 			BBContainer TF (&A, A.field(), i);
@@ -83,6 +83,7 @@ namespace LinBox
 			      (b.size () == A.rowdim ()));
 		linbox_check (_traits.singularity != Singularity::NonSingular || A.coldim () == A.rowdim ());
 
+		LINBOX_TRACE_SPAN ("wiedemann solve");
 		commentator().start ("Solving linear system (Wiedemann)", "WiedemannSolver::solve");
 
 		Singularity singular = _traits.singularity;
@@ -194,6 +195,7 @@ namespace LinBox
 		typedef BlasVector<Field> Polynomial;
 		typedef typename Polynomial::iterator        PolyIterator;
 
+		LINBOX_TRACE_SPAN ("wiedemann solveNonsingular");
 		commentator().start ("Solving nonsingular system (Wiedemann)", "WiedemannSolver::solveNonsingular");
 
 		Polynomial m_A(A.field());
@@ -44,8 +44,10 @@
 #include "linbox/matrix/sparse-matrix.h"
 #include "linbox/matrix/dense-matrix.h"
 #include "linbox/algorithms/lifting-container.h"
+#include "linbox/algorithms/integer-matrix-apply.h"
 #include <vector>
 #include "linbox/vector/blas-vector.h"
+#include "linbox/vector/fixed-precision-vector.h"
 
 
 #include "linbox/util/timer.h"
@@ -288,6 +290,50 @@ namespace LinBox
 		Vector& applyVTrans(Vector& y, Vector& x, Vector&z) const
 		{return _matM.applyTranspose(y,x);}
 
+		/** \brief res = (res - A digit) / p.
+		 * @returns false if checkDivision is set and p does not divide some residue.
+		 */
+		template <class ResVector, class DigitVector>
+		bool residualUpdate(ResVector& res, const DigitVector& digit, const Element& p, bool checkDivision = false) const
+		{
+			ResVector v(_domain, _matM.rowdim());
+			_matM.apply(v, digit);
+			bool divisible = true;
+			for (size_t i = 0; i < res.size(); ++i) {
+				_domain.subin(res[i], v[i]);
+				if (checkDivision && !_domain.isDivisor(res[i], p))
+					divisible = false;
+				_domain.divin(res[i], p);
+			}
+			return divisible;
+		}
+
+		//! Same as above, on limb storage.
+		template <class DigitVector>
+		bool residualUpdate(FixedPrecisionVector& res, const DigitVector& digit, const Element& p, bool checkDivision = false) const
+		{
+			Vector v(_domain, _matM.rowdim());
+			_matM.apply(v, digit);
+
+			integer tmp;
+			size_t bits = 0;
+			for (size_t i = 0; i < v.size(); ++i)
+				bits = std::max(bits, (size_t) _domain.convert(tmp, v[i]).bitsize());
+			res.prepareSubtraction(bits);
+
+			mp_limb_t q = FixedPrecisionVector::toLimb(_domain.convert(tmp, p));
+			const mp_limb_t shift = checkDivision ? res.powerOfBase(q) : 0;
+			bool divisible = true;
+			for (size_t i = 0; i < res.size(); ++i) {
+				res.subin(i, _domain.convert(tmp, v[i]));
+				if (checkDivision && res.mod(i, q, shift) != 0)
+					divisible = false;
+				res.divin(i, q);
+			}
+			res.completeDivision(q);
+			return divisible;
+		}
+
 	private:
 		Domain          _domain;
 		const IMatrix  &_matM;
@@ -1047,12 +1093,13 @@ namespace LinBox
 // #if !defined (__INTEL_COMPILER) && !defined(__clang__)
 // template<>
 // #endif
+	//! Dense integer matrices use the strategies of IntegerMatrixApplyDomain.
 	template <class Domain>
-	class MatrixApplyDomain<Domain, BlasMatrix<Domain> > : public BlasMatrixApplyDomain<Domain, BlasMatrix<Domain> > {
+	class MatrixApplyDomain<Domain, BlasMatrix<Domain> > : public IntegerMatrixApplyDomain<Domain, BlasMatrix<Domain> > {
 
 	public:
 		MatrixApplyDomain (const Domain &D, const  BlasMatrix<Domain> &Mat) :
-			BlasMatrixApplyDomain<Domain, BlasMatrix<Domain> > (D,Mat)
+			IntegerMatrixApplyDomain<Domain, BlasMatrix<Domain> > (D,Mat)
 		{}
 
 	};
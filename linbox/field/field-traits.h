@@ -207,6 +207,17 @@ namespace LinBox {
         template<>
         inline uint64_t FieldTraits<Givaro::ModularBalanced<int64_t> >::bestBitSize(size_t n){return std::max ( UINT64_C(27), uint64_t(64-(n?log2(n):0))>>1);}
 
+	/*! ThreadContext.
+	 * State of a ring kept per thread instead of in the ring, such as the modulus of the NTL rings.
+	 * It is saved on the thread computing with the ring, and restored by the tasks
+	 * running on other threads before they compute with it. Rings have none by default.
+	 */
+	template <class Ring>
+	struct ThreadContext {
+		explicit ThreadContext(const Ring&) {}
+		void restore() const {}
+	};
+
 } // Namespace LinBox
 
 namespace LinBox { /*  areFieldEqual  */
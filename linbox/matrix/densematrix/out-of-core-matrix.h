@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file matrix/densematrix/out-of-core-matrix.h
+ * @ingroup matrix
+ * @brief Dense matrix stored in a file, by panels of columns.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "linbox/util/debug.h"
+#include "linbox/util/error.h"
+#include "linbox/util/tracer.h"
+
+namespace LinBox {
+
+    /**
+     * \brief Dense m x n matrix kept in a file, for matrices larger than the memory.
+     *
+     * The columns are cut in panels of panelWidth() columns. Panel k is stored row by row,
+     * as a contiguous m x panelCols(k) block: a panel is read or written by a single call,
+     * and a panel of m rows and a few columns fits in memory when the matrix does not.
+     *
+     * Without a path, the file is a temporary one, removed at once, in the directory
+     * given by TMPDIR (/tmp otherwise). With a path, an existing file is kept: the matrix
+     * is then the one stored there by a previous OutOfCoreMatrix of the same dimensions.
+     *
+     * Elements are copied bytewise to and from the file: they must be trivially copyable,
+     * as are the ones of the modular fields. Reads and writes are positional (pread, pwrite):
+     * several threads may access disjoint blocks concurrently.
+     *
+     * See OutOfCoreElimination for rank and echelon forms.
+     */
+    template <class _Field>
+    class OutOfCoreMatrix {
+    public:
+        typedef _Field Field;
+        typedef typename Field::Element Element;
+
+        static_assert(std::is_trivially_copyable<Element>::value,
+                      "OutOfCoreMatrix needs elements which can be copied to a file");
+
+        OutOfCoreMatrix(const Field& F, size_t m, size_t n, size_t panelWidth, const std::string& path = "")
+            : _field(&F)
+            , _m(m)
+            , _n(n)
+            , _panelWidth(std::max<size_t>(1, std::min(panelWidth, n)))
+        {
+            if (path.empty()) {
+                const char* dir = std::getenv("TMPDIR");
+                std::string name = std::string((dir && *dir) ? dir : "/tmp") + "/linbox-ooc-XXXXXX";
+                std::vector<char> buffer(name.begin(), name.end());
+                buffer.push_back('\0');
+                _file.fd = ::mkstemp(buffer.data());
+                if (_file.fd < 0) fail("cannot create a temporary file in " + name);
+                ::unlink(buffer.data());
+            }
+            else {
+                _file.fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+                if (_file.fd < 0) fail("cannot open " + path);
+            }
+
+            struct stat st;
+            if (::fstat(_file.fd, &st) != 0) fail("cannot stat the file");
+            const off_t size = static_cast<off_t>(_m * _n * sizeof(Element));
+            if (st.st_size < size) {
+                if (::ftruncate(_file.fd, size) != 0) fail("cannot extend the file");
+                // The new bytes are zeros: fill with F.zero if it is something else.
+                Element zero = F.zero, bits;
+                std::memset(&bits, 0, sizeof(Element));
+                if (std::memcmp(&zero, &bits, sizeof(Element)) != 0) {
+                    std::vector<Element> row(_n, F.zero);
+                    for (size_t i = 0; i < _m; ++i) writeBlock(i, i + 1, 0, _n, row.data());
+                }
+            }
+        }
+
+        OutOfCoreMatrix(const OutOfCoreMatrix&) = delete;
+        OutOfCoreMatrix& operator=(const OutOfCoreMatrix&) = delete;
+
+        const Field& field() const { return *_field; }
+        size_t rowdim() const { return _m; }
+        size_t coldim() const { return _n; }
+
+        size_t panelWidth() const { return _panelWidth; }
+        size_t panelCount() const { return (_n + _panelWidth - 1) / _panelWidth; }
+        size_t panelBegin(size_t k) const { return k * _panelWidth; }
+        size_t panelEnd(size_t k) const { return std::min(_n, (k + 1) * _panelWidth); }
+        size_t panelCols(size_t k) const { return panelEnd(k) - panelBegin(k); }
+
+        /// buf = rows [i0, i1) and columns [j0, j1), row by row.
+        void readBlock(size_t i0, size_t i1, size_t j0, size_t j1, Element* buf) const
+        {
+            transfer(i0, i1, j0, j1, buf, false);
+        }
+
+        /// Rows [i0, i1) and columns [j0, j1) = buf, row by row.
+        void writeBlock(size_t i0, size_t i1, size_t j0, size_t j1, const Element* buf)
+        {
+            transfer(i0, i1, j0, j1, const_cast<Element*>(buf), true);
+        }
+
+        Element& getEntry(Element& x, size_t i, size_t j) const
+        {
+            readBlock(i, i + 1, j, j + 1, &x);
+            return x;
+        }
+
+        Element getEntry(size_t i, size_t j) const
+        {
+            Element x;
+            return getEntry(x, i, j);
+        }
+
+        void setEntry(size_t i, size_t j, const Element& x) { writeBlock(i, i + 1, j, j + 1, &x); }
+
+    private:
+        /// Closes the file, also when the constructor throws after opening it.
+        struct FileDescriptor {
+            int fd = -1;
+
+            FileDescriptor() = default;
+            FileDescriptor(const FileDescriptor&) = delete;
+            FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+            ~FileDescriptor()
+            {
+                if (fd >= 0) ::close(fd);
+            }
+        };
+
+        [[noreturn]] static void fail(const std::string& what)
+        {
+            throw LinboxError("LinBox ERROR: out-of-core matrix: " + what + ": " + std::strerror(errno));
+        }
+
+        /// Whole panels are one contiguous range of the file, pieces of panels one per row.
+        void transfer(size_t i0, size_t i1, size_t j0, size_t j1, Element* buf, bool write) const
+        {
+            linbox_check(i0 <= i1 && i1 <= _m && j0 <= j1 && j1 <= _n);
+            if (i0 == i1 || j0 == j1) return;
+            const size_t ld = j1 - j0;
+            for (size_t k = j0 / _panelWidth; k < panelCount() && panelBegin(k) < j1; ++k) {
+                const size_t c0 = std::max(j0, panelBegin(k)), c1 = std::min(j1, panelEnd(k));
+                const size_t w = panelCols(k);
+                const off_t panel = static_cast<off_t>(panelBegin(k) * _m * sizeof(Element));
+                if (c0 == panelBegin(k) && c1 == panelEnd(k) && ld == w) {
+                    io(buf, (i1 - i0) * w, panel + static_cast<off_t>(i0 * w * sizeof(Element)), write);
+                }
+                else {
+                    for (size_t i = i0; i < i1; ++i)
+                        io(buf + (i - i0) * ld + (c0 - j0), c1 - c0,
+                           panel + static_cast<off_t>((i * w + c0 - panelBegin(k)) * sizeof(Element)), write);
+                }
+            }
+        }
+
+        void io(Element* buf, size_t count, off_t offset, bool write) const
+        {
+            char* p = reinterpret_cast<char*>(buf);
+            size_t bytes = count * sizeof(Element);
+            LINBOX_TRACE_COUNT(BytesMoved, bytes);
+            while (bytes > 0) {
+                const ssize_t done = write ? ::pwrite(_file.fd, p, bytes, offset) : ::pread(_file.fd, p, bytes, offset);
+                if (done < 0 && errno == EINTR) continue;
+                if (done <= 0) fail(write ? "cannot write" : "cannot read");
+                p += done;
+                bytes -= static_cast<size_t>(done);
+                offset += done;
+            }
+        }
+
+        const Field* _field;
+        size_t _m;
+        size_t _n;
+        size_t _panelWidth;
+        FileDescriptor _file;
+    };
+}
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -33,8 +33,92 @@
 #include "linbox/linbox-config.h"
 #include "fflas-ffpack/ffpack/ffpack.h"
 #include "fflas-ffpack/fflas/fflas.h"
+#include "linbox/algorithms/matrix-blas3/mul-integer.h"
+#include "linbox/algorithms/matrix-blas3/small-prime.h"
 
 namespace LinBox {
+
+    namespace Protected {
+        //! FFLAS::fgemm, but for integer matrices, which go to BLAS3::IntegerMulDomain,
+        //! and for 8 and 16 bit residues, which go to BLAS3::SmallPrimeDomain.
+        template <class Field>
+        inline void fgemm(const Field& F, FFLAS::FFLAS_TRANSPOSE ta, FFLAS::FFLAS_TRANSPOSE tb,
+                          size_t m, size_t n, size_t k,
+                          const typename Field::Element& alpha,
+                          typename Field::ConstElement_ptr A, size_t lda,
+                          typename Field::ConstElement_ptr B, size_t ldb,
+                          const typename Field::Element& beta,
+                          typename Field::Element_ptr C, size_t ldc, std::false_type)
+        {
+            FFLAS::fgemm(F, ta, tb, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+        }
+
+        template <class Field>
+        inline void fgemm(const Field& F, FFLAS::FFLAS_TRANSPOSE ta, FFLAS::FFLAS_TRANSPOSE tb,
+                          size_t m, size_t n, size_t k,
+                          const typename Field::Element& alpha,
+                          typename Field::ConstElement_ptr A, size_t lda,
+                          typename Field::ConstElement_ptr B, size_t ldb,
+                          const typename Field::Element& beta,
+                          typename Field::Element_ptr C, size_t ldc, std::true_type)
+        {
+            BLAS3::SmallPrimeDomain<Field>(F).fgemm(ta, tb, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+        }
+
+        template <class Field>
+        inline void fgemm(const Field& F, FFLAS::FFLAS_TRANSPOSE ta, FFLAS::FFLAS_TRANSPOSE tb,
+                          size_t m, size_t n, size_t k,
+                          const typename Field::Element& alpha,
+                          typename Field::ConstElement_ptr A, size_t lda,
+                          typename Field::ConstElement_ptr B, size_t ldb,
+                          const typename Field::Element& beta,
+                          typename Field::Element_ptr C, size_t ldc)
+        {
+            fgemm(F, ta, tb, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc, BLAS3::isSmallPrimeField<Field>());
+        }
+
+        inline void fgemm(const Givaro::ZRing<Integer>&, FFLAS::FFLAS_TRANSPOSE ta, FFLAS::FFLAS_TRANSPOSE tb,
+                          size_t m, size_t n, size_t k,
+                          const Integer& alpha, const Integer* A, size_t lda, const Integer* B, size_t ldb,
+                          const Integer& beta, Integer* C, size_t ldc)
+        {
+            BLAS3::IntegerMulDomain().fgemm(ta, tb, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+        }
+
+        //! FFLAS::fgemv, but for 8 and 16 bit residues, which go to BLAS3::SmallPrimeDomain.
+        template <class Field>
+        inline void fgemv(const Field& F, FFLAS::FFLAS_TRANSPOSE ta, size_t m, size_t n,
+                          const typename Field::Element& alpha,
+                          typename Field::ConstElement_ptr A, size_t lda,
+                          typename Field::ConstElement_ptr X, size_t incX,
+                          const typename Field::Element& beta,
+                          typename Field::Element_ptr Y, size_t incY, std::false_type)
+        {
+            FFLAS::fgemv(F, ta, m, n, alpha, A, lda, X, incX, beta, Y, incY);
+        }
+
+        template <class Field>
+        inline void fgemv(const Field& F, FFLAS::FFLAS_TRANSPOSE ta, size_t m, size_t n,
+                          const typename Field::Element& alpha,
+                          typename Field::ConstElement_ptr A, size_t lda,
+                          typename Field::ConstElement_ptr X, size_t incX,
+                          const typename Field::Element& beta,
+                          typename Field::Element_ptr Y, size_t incY, std::true_type)
+        {
+            BLAS3::SmallPrimeDomain<Field>(F).fgemv(ta, m, n, alpha, A, lda, X, incX, beta, Y, incY);
+        }
+
+        template <class Field>
+        inline void fgemv(const Field& F, FFLAS::FFLAS_TRANSPOSE ta, size_t m, size_t n,
+                          const typename Field::Element& alpha,
+                          typename Field::ConstElement_ptr A, size_t lda,
+                          typename Field::ConstElement_ptr X, size_t incX,
+                          const typename Field::Element& beta,
+                          typename Field::Element_ptr Y, size_t incY)
+        {
+            fgemv(F, ta, m, n, alpha, A, lda, X, incX, beta, Y, incY, BLAS3::isSmallPrimeField<Field>());
+        }
+    }
   
     
  
@@ -73,7 +157,7 @@ namespace LinBox {
             linbox_check( A.coldim() == B.rowdim()); linbox_check( C.rowdim() == A.rowdim());
 			linbox_check( C.coldim() == B.coldim());            
 
-            FFLAS::fgemm( C.field(), isTransposed<Matrix3>::value, isTransposed<Matrix4>::value,
+            Protected::fgemm( C.field(), isTransposed<Matrix3>::value, isTransposed<Matrix4>::value,
                           C.rowdim(), C.coldim(), A.coldim(),
                           alpha, A.getPointer(), A.getStride() , B.getPointer(), B.getStride(),
                           beta,  C.getPointer(), C.getStride());
@@ -99,7 +183,7 @@ namespace LinBox {
         {
            	linbox_check( B.rowdim() == a.size());
 			linbox_check( B.coldim() == c.size());
-			FFLAS::fgemv( B.field(), isTransposed<TransposedBlasMatrix<Matrix>>::value,
+			Protected::fgemv( B.field(), isTransposed<TransposedBlasMatrix<Matrix>>::value,
                           B.rowdim(), B.coldim(),
                           alpha, B.getPointer(), B.getStride(),a.getPointer(), a.getInc(),
                           beta,  c.getPointer(), c.getInc());
@@ -124,7 +208,7 @@ namespace LinBox {
         {
           	linbox_check( A.coldim() == b.size());
 			linbox_check( A.rowdim() == c.size()); 
-			FFLAS::fgemv( A.field(), isTransposed<Matrix>::value,
+			Protected::fgemv( A.field(), isTransposed<Matrix>::value,
                           A.rowdim(), A.coldim(),
                           alpha, A.getPointer(), A.getStride(),b.getPointer(), b.getInc(),
                           beta,  c.getPointer(), c.getInc());
@@ -84,6 +84,27 @@ namespace LinBox
 namespace LinBox
 { /* Rank */
 
+    namespace Protected {
+        //! FFPACK::Rank, but for 8 and 16 bit residues, which go to BLAS3::SmallPrimeDomain.
+        template <class Field>
+        inline size_t rank(const Field& F, size_t m, size_t n, typename Field::Element_ptr A, size_t lda, std::false_type)
+        {
+            return FFPACK::Rank(F, m, n, A, lda);
+        }
+
+        template <class Field>
+        inline size_t rank(const Field& F, size_t m, size_t n, typename Field::Element_ptr A, size_t lda, std::true_type)
+        {
+            return BLAS3::SmallPrimeDomain<Field>(F).rank(m, n, A, lda);
+        }
+
+        template <class Field>
+        inline size_t rank(const Field& F, size_t m, size_t n, typename Field::Element_ptr A, size_t lda)
+        {
+            return rank(F, m, n, A, lda, BLAS3::isSmallPrimeField<Field>());
+        }
+    }
+
 	template<class Matrix>
     size_t
 	BlasMatrixDomainRank<Matrix>::operator() (const  Matrix  &A) const
@@ -96,7 +117,7 @@ namespace LinBox
     size_t
 	BlasMatrixDomainRank<Matrix>::operator() (Matrix        &A) const
 	{
-        return FFPACK::Rank(A.field(),A.rowdim(), A.coldim(), A.getPointer(), A.getStride());
+        return Protected::rank(A.field(), A.rowdim(), A.coldim(), A.getPointer(), A.getStride());
 	}
 
 } // LinBox
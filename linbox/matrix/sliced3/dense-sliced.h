@@ -5,6 +5,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/fcntl.h>
+#include <algorithm>
 
 /**
   The matrix class Sliced is defined.
@@ -15,6 +16,7 @@
 */
 
 #include "dense-matrix.h"
+#include "sliced-kernels.h"
 //#include <linbox/util/timer.h>
 //#include "sliced-stepper.h"
 
@@ -289,18 +291,34 @@ public:
 //  incl functions to handle specialized cases (where submats are not word-aligned)
 #include "dense-sliced.inl"
 
-	//  typical addin, barge right through with the raw iterator
+	typedef void (*Kernel)(SlicedUnit*, const SlicedUnit*, size_t);
+
+	//  applies a SlicedKernels function to the contiguous runs of words
+	//  from x to e (whole rows of a matrix) and the matching words from y
+	static void runKernel(Kernel kernel, RawIterator x, const RawIterator &e, RawIterator y){
+		while(x != e){
+			size_t n = std::min(x._end - x._me, y._end - y._me);
+			if(n == 0) break;
+			kernel(&(*x), &(*y), n);
+			x += n; y += n;
+		}
+	}
+
+	static void runNegin(RawIterator x, const RawIterator &e){
+		while(x != e){
+			size_t n = x._end - x._me;
+			if(n == 0) break;
+			SlicedKernels::negin(&(*x), n);
+			x += n;
+		}
+	}
+
+	//  typical addin, barge right through the rows with the vectorized kernel
 	Sliced& addin(Sliced &other){
 		if(_loff || _roff)
 			return s_addin(other);
 
-		RawIterator a = rawBegin();
-		RawIterator c = rawEnd();
-		RawIterator b = other.rawBegin();
-
-		//for(; &(*a) != &(*c); ++a, ++b)
-		for(; a != c; ++a, ++b)
-			(*a) += (*b);
+		runKernel(&SlicedKernels::addin<SlicedWord>, rawBegin(), rawEnd(), other.rawBegin());
 
 		return *this;
 	}
@@ -316,10 +334,7 @@ public:
 			return zero();
 
 		//  x == 2
-		//int j = 0;
-		//for(RawIterator a = rawBegin(); j < rows()*cols() ; j+=_SIZE, ++a)
-		for(RawIterator a = rawBegin(); a != rawEnd(); ++a)
-			(*a)*=2;
+		runNegin(rawBegin(), rawEnd());
 
 		return *this;
 	}
@@ -389,29 +404,32 @@ public:
 
 	//  begin, end, scalar, other begin
 	Sliced & axpyin(RawIterator &b, RawIterator &e, Scalar &s, RawIterator &ob){
-		RawIterator x = b;
-		RawIterator y = ob;
-
 		switch(static_cast<int>(s)){
 			case 0:
 				return *this;
 			case 1:
 				if(_loff || _roff)
 					return s_axpyin(b, s, ob);
-				for(; x!=e; ++x,++y)
-					(*x) += (*y);
+				runKernel(&SlicedKernels::addin<SlicedWord>, b, e, ob);
 				return *this;
 			case 2:
 				if(_loff || _roff)
 					return s_axpyin(b, s, ob);
-				for(; x!=e; ++x,++y){
-					(*x) += (*y)*2;
-				}
+				runKernel(&SlicedKernels::subin<SlicedWord>, b, e, ob);
 				return *this;
 		}
 		return *this;
 	}
 
+	//  this += s * other, row by row
+	Sliced & axpyin(Scalar &s, Sliced &other){
+		for(size_t i = 0; i < rowdim(); ++i){
+			RawIterator b = rowBegin(i), e = rowEnd(i), ob = other.rowBegin(i);
+			axpyin(b, e, s, ob);
+		}
+		return *this;
+	}
+
 	//  MUL:
 	//  become the product of two sliced matrices
 	//  (only seems to work if row packed so far)
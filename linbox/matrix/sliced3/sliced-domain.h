@@ -104,8 +104,7 @@ public:
 
 	// A += x*B
 	Matrix& axpyin( Matrix& A, Scalar& x, Matrix &B) {
-		typename Matrix::RawIterator Ab(A.rawBegin()), Ae(A.rawEnd()), Bb(B.rawBegin());
-		return A.axpyin(Ab, Ae, x, Bb);
+		return A.axpyin(x, B);
 	}
 
 	//  C += A * B
@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file matrix/sliced3/sliced-kernels.h
+ * @ingroup matrix
+ * @brief Vectorized GF(3) add, sub and neg on arrays of sliced words.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "linbox/linbox-config.h"
+
+#if defined(__LINBOX_HAVE_AVX2_INSTRUCTIONS) || defined(__LINBOX_HAVE_AVX512F_INSTRUCTIONS)
+#include <immintrin.h>
+#endif
+
+namespace LinBox {
+
+    template <class T>
+    struct SlicedBase;
+
+    /**
+     * \brief Kernels on n consecutive SlicedBase units, such as a row of an aligned Sliced matrix.
+     *
+     * A unit holds its two words b0, b1 next to each other, so that an array of units interleaves them.
+     * With 64 bits words, the AVX2 (resp. AVX-512) versions load 4 (resp. 8) units in two registers,
+     * gather the b0 and b1 words with unpacklo/unpackhi, apply the same formula as SlicedBase::operator+=
+     * and interleave them back. The remaining units, and other word sizes, use SlicedBase.
+     */
+    namespace SlicedKernels {
+
+#if defined(__LINBOX_HAVE_AVX512F_INSTRUCTIONS)
+        // x[0..n) += y[0..n), or -= if Negate; returns the number of units done.
+        template <bool Negate>
+        inline size_t addUnits512(uint64_t* x, const uint64_t* y, size_t n)
+        {
+            size_t k = 0;
+            for (; k + 8 <= n; k += 8) {
+                __m512i xl = _mm512_loadu_si512(x + 2 * k), xh = _mm512_loadu_si512(x + 2 * k + 8);
+                __m512i yl = _mm512_loadu_si512(y + 2 * k), yh = _mm512_loadu_si512(y + 2 * k + 8);
+                __m512i x0 = _mm512_unpacklo_epi64(xl, xh), x1 = _mm512_unpackhi_epi64(xl, xh);
+                __m512i y0 = _mm512_unpacklo_epi64(yl, yh), y1 = _mm512_unpackhi_epi64(yl, yh);
+                if (Negate) y1 = _mm512_xor_si512(y1, y0);
+
+                __m512i a = _mm512_xor_si512(x0, y1);
+                __m512i b = _mm512_xor_si512(x1, y0);
+                __m512i s = _mm512_xor_si512(a, x1);
+                __m512i t = _mm512_xor_si512(b, y1);
+                x1 = _mm512_and_si512(a, b);
+                x0 = _mm512_or_si512(s, t);
+
+                _mm512_storeu_si512(x + 2 * k, _mm512_unpacklo_epi64(x0, x1));
+                _mm512_storeu_si512(x + 2 * k + 8, _mm512_unpackhi_epi64(x0, x1));
+            }
+            return k;
+        }
+
+        inline size_t negUnits512(uint64_t* x, size_t n)
+        {
+            const __m512i zero = _mm512_setzero_si512();
+            size_t k = 0;
+            for (; k + 4 <= n; k += 4) {
+                __m512i v = _mm512_loadu_si512(x + 2 * k);
+                // [b0, b1] ^ [0, b0] in each 128 bits lane.
+                _mm512_storeu_si512(x + 2 * k, _mm512_xor_si512(v, _mm512_unpacklo_epi64(zero, v)));
+            }
+            return k;
+        }
+#endif
+
+#if defined(__LINBOX_HAVE_AVX2_INSTRUCTIONS)
+        template <bool Negate>
+        inline size_t addUnits256(uint64_t* x, const uint64_t* y, size_t n)
+        {
+            size_t k = 0;
+            for (; k + 4 <= n; k += 4) {
+                __m256i xl = _mm256_loadu_si256((const __m256i*)(x + 2 * k));
+                __m256i xh = _mm256_loadu_si256((const __m256i*)(x + 2 * k + 4));
+                __m256i yl = _mm256_loadu_si256((const __m256i*)(y + 2 * k));
+                __m256i yh = _mm256_loadu_si256((const __m256i*)(y + 2 * k + 4));
+                __m256i x0 = _mm256_unpacklo_epi64(xl, xh), x1 = _mm256_unpackhi_epi64(xl, xh);
+                __m256i y0 = _mm256_unpacklo_epi64(yl, yh), y1 = _mm256_unpackhi_epi64(yl, yh);
+                if (Negate) y1 = _mm256_xor_si256(y1, y0);
+
+                __m256i a = _mm256_xor_si256(x0, y1);
+                __m256i b = _mm256_xor_si256(x1, y0);
+                __m256i s = _mm256_xor_si256(a, x1);
+                __m256i t = _mm256_xor_si256(b, y1);
+                x1 = _mm256_and_si256(a, b);
+                x0 = _mm256_or_si256(s, t);
+
+                _mm256_storeu_si256((__m256i*)(x + 2 * k), _mm256_unpacklo_epi64(x0, x1));
+                _mm256_storeu_si256((__m256i*)(x + 2 * k + 4), _mm256_unpackhi_epi64(x0, x1));
+            }
+            return k;
+        }
+
+        inline size_t negUnits256(uint64_t* x, size_t n)
+        {
+            const __m256i zero = _mm256_setzero_si256();
+            size_t k = 0;
+            for (; k + 2 <= n; k += 2) {
+                __m256i v = _mm256_loadu_si256((const __m256i*)(x + 2 * k));
+                _mm256_storeu_si256((__m256i*)(x + 2 * k), _mm256_xor_si256(v, _mm256_unpacklo_epi64(zero, v)));
+            }
+            return k;
+        }
+#endif
+
+        // Units done by the vector kernels, 0 when the words are not 64 bits.
+        template <bool Negate, class T>
+        inline size_t addUnits(SlicedBase<T>* x, const SlicedBase<T>* y, size_t n)
+        {
+            if (sizeof(T) != 8 || sizeof(SlicedBase<T>) != 16) return 0;
+            uint64_t* xw = reinterpret_cast<uint64_t*>(x);
+            const uint64_t* yw = reinterpret_cast<const uint64_t*>(y);
+            size_t k = 0;
+#if defined(__LINBOX_HAVE_AVX512F_INSTRUCTIONS)
+            k = addUnits512<Negate>(xw, yw, n);
+#endif
+#if defined(__LINBOX_HAVE_AVX2_INSTRUCTIONS)
+            k += addUnits256<Negate>(xw + 2 * k, yw + 2 * k, n - k);
+#endif
+            (void)xw;
+            (void)yw;
+            (void)n;
+            return k;
+        }
+
+        /// x[0..n) += y[0..n)
+        template <class T>
+        inline void addin(SlicedBase<T>* x, const SlicedBase<T>* y, size_t n)
+        {
+            for (size_t k = addUnits<false>(x, y, n); k < n; ++k) x[k] += y[k];
+        }
+
+        /// x[0..n) -= y[0..n), that is x += 2 y.
+        template <class T>
+        inline void subin(SlicedBase<T>* x, const SlicedBase<T>* y, size_t n)
+        {
+            for (size_t k = addUnits<true>(x, y, n); k < n; ++k) x[k] += y[k] * 2;
+        }
+
+        /// x[0..n) = -x[0..n)
+        template <class T>
+        inline void negin(SlicedBase<T>* x, size_t n)
+        {
+            size_t k = 0;
+            if (sizeof(T) == 8 && sizeof(SlicedBase<T>) == 16) {
+                uint64_t* xw = reinterpret_cast<uint64_t*>(x);
+#if defined(__LINBOX_HAVE_AVX512F_INSTRUCTIONS)
+                k = negUnits512(xw, n);
+#endif
+#if defined(__LINBOX_HAVE_AVX2_INSTRUCTIONS)
+                k += negUnits256(xw + 2 * k, n - k);
+#endif
+                (void)xw;
+            }
+            for (; k < n; ++k) x[k] *= 2;
+        }
+
+        /// x[0..n) += s y[0..n), for s in {0, 1, 2}.
+        template <class T, class Scalar>
+        inline void axpyin(SlicedBase<T>* x, const Scalar& s, const SlicedBase<T>* y, size_t n)
+        {
+            switch (static_cast<int>(s)) {
+            case 1: addin(x, y, n); break;
+            case 2: subin(x, y, n); break;
+            default: break;
+            }
+        }
+    }
+}
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
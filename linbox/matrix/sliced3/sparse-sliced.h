@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file matrix/sliced3/sparse-sliced.h
+ * @ingroup matrix
+ * @brief Sparse GF(3) blackbox applied to sliced block vectors.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <istream>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "linbox/util/debug.h"
+#include "linbox/util/error.h"
+#include "linbox/util/task-pool.h"
+#include "dense-sliced.h"
+
+namespace LinBox {
+
+    /**
+     * \brief Sparse matrix over GF(3) whose apply works on Sliced blocks.
+     *
+     * The nonzero entries of each row (and of each column, for applyTranspose)
+     * are kept as two lists of column indices, those equal to 1 and those equal to 2,
+     * so that Y = A X is, for each row i of Y, a sum of rows of X minus a sum of rows of X.
+     * With row packed X and Y of b columns, each of these is an add of b/64 sliced words,
+     * done by the vectorized SlicedKernels: blocks of 128 (AVX2) or 256 (AVX-512) vectors
+     * or more use the full width of the registers. The rows of Y are computed in parallel
+     * by TaskPool::current().
+     *
+     * Entries are given by setEntry() or read() in SMS format, then finalize() must be called
+     * before the first apply.
+     */
+    template <class _Domain>
+    class SlicedSparse {
+    public:
+        typedef _Domain Domain;
+        typedef typename Domain::Scalar Scalar;
+        typedef Sliced<Domain> Matrix;
+
+        SlicedSparse(const Domain& D, size_t m = 0, size_t n = 0)
+            : _domain(D)
+            , _m(m)
+            , _n(n)
+        {
+        }
+
+        size_t rowdim() const { return _m; }
+        size_t coldim() const { return _n; }
+        const Domain& field() const { return _domain; }
+
+        /// Number of nonzero entries, once finalized.
+        size_t size() const { return _rows.plus.size() + _rows.minus.size(); }
+
+        /// A[i, j] = a mod 3. Takes effect at finalize(); a later entry replaces an earlier one.
+        void setEntry(size_t i, size_t j, long a)
+        {
+            linbox_check(i < _m && j < _n);
+            _triples.emplace_back(i, j, ((a % 3) + 3) % 3);
+        }
+
+        /// Builds the row and column lists from the entries set.
+        void finalize()
+        {
+            std::stable_sort(_triples.begin(), _triples.end(), [](const Triple& a, const Triple& b) {
+                return std::make_pair(std::get<0>(a), std::get<1>(a)) < std::make_pair(std::get<0>(b), std::get<1>(b));
+            });
+            std::vector<Triple> entries;
+            for (size_t k = 0; k < _triples.size(); ++k) {
+                if (k + 1 < _triples.size() && std::get<0>(_triples[k]) == std::get<0>(_triples[k + 1])
+                    && std::get<1>(_triples[k]) == std::get<1>(_triples[k + 1]))
+                    continue;
+                if (std::get<2>(_triples[k]) != 0) entries.push_back(_triples[k]);
+            }
+            _triples.clear();
+
+            _rows.build(entries, _m, false);
+            _cols.build(entries, _n, true);
+        }
+
+        /// Reads "m n M", then "i j a" lines (1-based) up to "0 0 0", and finalizes.
+        std::istream& read(std::istream& is)
+        {
+            char c;
+            is >> _m >> _n >> c;
+            if (!is) throw LinboxError("LinBox ERROR: bad SMS header for a sliced sparse matrix");
+            _triples.clear();
+            size_t i, j;
+            long a;
+            while (is >> i >> j >> a && (i != 0 || j != 0)) {
+                if (i > _m || j > _n || i == 0 || j == 0)
+                    throw LinboxError("LinBox ERROR: SMS entry out of the sliced sparse matrix");
+                setEntry(i - 1, j - 1, a);
+            }
+            finalize();
+            return is;
+        }
+
+        /// Y = A X, for row packed X (coldim() x b) and Y (rowdim() x b).
+        Matrix& apply(Matrix& Y, Matrix& X) const { return applyLists(_rows, Y, X); }
+
+        /// Y = A^T X, for row packed X (rowdim() x b) and Y (coldim() x b).
+        Matrix& applyTranspose(Matrix& Y, Matrix& X) const { return applyLists(_cols, Y, X); }
+
+        /// Same as apply, for BlackboxBlockContainer like uses (see PascalBlackbox::applyLeft).
+        Matrix& applyLeft(Matrix& Y, const Matrix& X) const { return apply(Y, const_cast<Matrix&>(X)); }
+
+    private:
+        typedef std::tuple<size_t, size_t, long> Triple;
+
+        // Indices of the entries equal to 1 then 2 of each row (or column) k:
+        // plus[plusStart[k] .. plusStart[k+1]), minus[minusStart[k] .. minusStart[k+1]).
+        struct Lists {
+            std::vector<size_t> plusStart, minusStart;
+            std::vector<size_t> plus, minus;
+
+            void build(const std::vector<Triple>& entries, size_t dim, bool transposed)
+            {
+                plusStart.assign(dim + 1, 0);
+                minusStart.assign(dim + 1, 0);
+                for (const Triple& t : entries) {
+                    const size_t k = transposed ? std::get<1>(t) : std::get<0>(t);
+                    ++(std::get<2>(t) == 1 ? plusStart : minusStart)[k + 1];
+                }
+                for (size_t k = 0; k < dim; ++k) {
+                    plusStart[k + 1] += plusStart[k];
+                    minusStart[k + 1] += minusStart[k];
+                }
+                plus.resize(plusStart[dim]);
+                minus.resize(minusStart[dim]);
+                std::vector<size_t> nextPlus(plusStart.begin(), plusStart.end() - 1);
+                std::vector<size_t> nextMinus(minusStart.begin(), minusStart.end() - 1);
+                // Entries are sorted by rows, so that the lists of each column are sorted too.
+                for (const Triple& t : entries) {
+                    const size_t k = transposed ? std::get<1>(t) : std::get<0>(t);
+                    const size_t l = transposed ? std::get<0>(t) : std::get<1>(t);
+                    if (std::get<2>(t) == 1)
+                        plus[nextPlus[k]++] = l;
+                    else
+                        minus[nextMinus[k]++] = l;
+                }
+            }
+        };
+
+        Matrix& applyLists(const Lists& lists, Matrix& Y, Matrix& X) const
+        {
+            linbox_check(lists.plusStart.size() == Y.rowdim() + 1);
+            linbox_check(Y.coldim() == X.coldim());
+
+            Y.zero();
+            TaskPool::current().parallelFor(0, Y.rowdim(), 0, [&](size_t i) {
+                Scalar one = 1, two = 2;
+                // Fresh iterators for each row of X, as axpyin moves them on unaligned submatrices.
+                for (size_t k = lists.plusStart[i]; k < lists.plusStart[i + 1]; ++k) {
+                    typename Matrix::RawIterator yb(Y.rowBegin(i)), ye(Y.rowEnd(i)), xb(X.rowBegin(lists.plus[k]));
+                    Y.axpyin(yb, ye, one, xb);
+                }
+                for (size_t k = lists.minusStart[i]; k < lists.minusStart[i + 1]; ++k) {
+                    typename Matrix::RawIterator yb(Y.rowBegin(i)), ye(Y.rowEnd(i)), xb(X.rowBegin(lists.minus[k]));
+                    Y.axpyin(yb, ye, two, xb);
+                }
+            });
+            return Y;
+        }
+
+        Domain _domain;
+        size_t _m, _n;
+        std::vector<Triple> _triples; //!< Entries set since the last finalize().
+        Lists _rows, _cols;
+    };
+}
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
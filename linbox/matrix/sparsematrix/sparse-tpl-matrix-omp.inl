@@ -31,9 +31,9 @@
 
 #include <algorithm>
 #include <iostream>
-#include <omp.h>
 #include "linbox/linbox-config.h"
 #include "linbox/util/debug.h"
+#include "linbox/util/task-pool.h"
 #include "linbox/util/field-axpy.h"
 #include "linbox/blackbox/blackbox-interface.h"
 #include "linbox/field/hom.h"
@@ -231,32 +231,24 @@ applyLeft(Mat1 &Y, const Mat2 &X) const
 {
         Y.zero();
 
-#ifdef __LINBOX_USE_OPENMP
-#pragma omp parallel
-#endif
-	{
-		Index numBlockSizes=rowBlocks_.size();
-		for (Index chunkSizeIx=0;chunkSizeIx<numBlockSizes;++chunkSizeIx) {
-			const VectorChunks *rowChunks=&(rowBlocks_[chunkSizeIx]);
-			Index numChunks=rowChunks->size();
-#ifdef __LINBOX_USE_OPENMP
-#pragma omp for schedule (static,1)
-#endif
-			for (Index rowChunk=0;rowChunk<numChunks;++rowChunk) {
-				const BlockList *blocks=&((*rowChunks)[rowChunk]);
-				Index numBlocks=blocks->size();
-				for (Index block=0;block<numBlocks;++block) {
-                                        const DataBlock *dataBlock=&((*blocks)[block]);
-					for (Index k=0;k<dataBlock->elts_.size();++k) {
-                                                const Index row=dataBlock->getRow((int)k);
-                                                const Index col=dataBlock->getCol((int)k);
-                                                typename Matrix::constSubMatrixType Xr(X,col,0,1,X.coldim());
-                                                typename Matrix::subMatrixType Yr(Y,row,0,1,Y.coldim());
-                                                MD_.saxpyin(Yr,dataBlock->elts_[k],Xr);
-                                        }
+        TaskPool& pool=TaskPool::current();
+	Index numBlockSizes=rowBlocks_.size();
+	for (Index chunkSizeIx=0;chunkSizeIx<numBlockSizes;++chunkSizeIx) {
+		const VectorChunks *rowChunks=&(rowBlocks_[chunkSizeIx]);
+		pool.parallelFor(0,rowChunks->size(),1,[&](size_t rowChunk) {
+			const BlockList *blocks=&((*rowChunks)[rowChunk]);
+			Index numBlocks=blocks->size();
+			for (Index block=0;block<numBlocks;++block) {
+                                const DataBlock *dataBlock=&((*blocks)[block]);
+				for (Index k=0;k<dataBlock->elts_.size();++k) {
+                                        const Index row=dataBlock->getRow((int)k);
+                                        const Index col=dataBlock->getCol((int)k);
+                                        typename Matrix::constSubMatrixType Xr(X,col,0,1,X.coldim());
+                                        typename Matrix::subMatrixType Yr(Y,row,0,1,Y.coldim());
+                                        MD_.saxpyin(Yr,dataBlock->elts_[k],Xr);
                                 }
                         }
-                }
+                });
         }
         return Y;
 }
@@ -269,32 +261,24 @@ applyRight(Mat1 &Y, const Mat2 &X) const
         typedef AbnormalMatrix<Field_,Mat1> AbnormalMat;
         AbnormalMat YTemp(field(),Y);
 
-#ifdef __LINBOX_USE_OPENMP
-#pragma omp parallel
-#endif
-	{
-		Index numBlockSizes=colBlocks_.size();
-		for (Index chunkSizeIx=0;chunkSizeIx<numBlockSizes;++chunkSizeIx) {
-			const VectorChunks *colChunks=&(colBlocks_[chunkSizeIx]);
-			Index numChunks=colChunks->size();
-#ifdef __LINBOX_USE_OPENMP
-#pragma omp for schedule (static,1)
-#endif
-			for (Index colChunk=0;colChunk<numChunks;++colChunk) {
-				const BlockList *blocks=&((*colChunks)[colChunk]);
-				Index numBlocks=blocks->size();
-				for (Index block=0;block<numBlocks;++block) {
-                                        const DataBlock *dataBlock=&((*blocks)[block]);
-					for (Index k=0;k<dataBlock->elts_.size();++k) {
-                                                const Index row=dataBlock->getRow((int)k);
-                                                const Index col=dataBlock->getCol((int)k);
-                                                typename Matrix::constSubMatrixType Xc(X,0,row,X.rowdim(),1);
-                                                YTemp.saxpyin(dataBlock->elts_[k],Xc,
-                                                              0,col,Y.rowdim(),1);
-                                        }
+        TaskPool& pool=TaskPool::current();
+	Index numBlockSizes=colBlocks_.size();
+	for (Index chunkSizeIx=0;chunkSizeIx<numBlockSizes;++chunkSizeIx) {
+		const VectorChunks *colChunks=&(colBlocks_[chunkSizeIx]);
+		pool.parallelFor(0,colChunks->size(),1,[&](size_t colChunk) {
+			const BlockList *blocks=&((*colChunks)[colChunk]);
+			Index numBlocks=blocks->size();
+			for (Index block=0;block<numBlocks;++block) {
+                                const DataBlock *dataBlock=&((*blocks)[block]);
+				for (Index k=0;k<dataBlock->elts_.size();++k) {
+                                        const Index row=dataBlock->getRow((int)k);
+                                        const Index col=dataBlock->getCol((int)k);
+                                        typename Matrix::constSubMatrixType Xc(X,0,row,X.rowdim(),1);
+                                        YTemp.saxpyin(dataBlock->elts_[k],Xc,
+                                                      0,col,Y.rowdim(),1);
                                 }
                         }
-                }
+                });
         }
         YTemp.normalize();
         return Y;
@@ -311,49 +295,34 @@ OutVector & SparseMatrix<Field_,SparseMatrixFormat::TPL_omp>::apply(OutVector &
 	size_t spacePtr=(size_t)yTempSpace;
 	FieldAXPY<Field_>* yTemp=(FieldAXPY<Field_>*)(spacePtr+CACHE_ALIGNMENT-(spacePtr%CACHE_ALIGNMENT));
 
-
-#ifdef __LINBOX_USE_OPENMP
-#pragma omp parallel
-#endif
-	{
-                const Field_& fieldRef=field();
-#ifdef __LINBOX_USE_OPENMP
-#pragma omp for schedule (static,1024)
-#endif
-                for (size_t i=0;i<y.size();++i) {
-                        new ((void*)(yTemp+i)) FieldAXPY<Field_>(fieldRef);
-                }
-
-		Index numBlockSizes=rowBlocks_.size();
-		for (Index chunkSizeIx=0;chunkSizeIx<numBlockSizes;++chunkSizeIx) {
-			const VectorChunks *rowChunks=&(rowBlocks_[chunkSizeIx]);
-			Index numChunks=rowChunks->size();
-#ifdef __LINBOX_USE_OPENMP
-#pragma omp for schedule (static,1)
-#endif
-			for (Index rowChunk=0;rowChunk<numChunks;++rowChunk) {
-				const BlockList *blocks=&((*rowChunks)[rowChunk]);
-				Index numBlocks=blocks->size();
-				for (Index block=0;block<numBlocks;++block) {
-                                        const DataBlock *dataBlock=&((*blocks)[block]);
-					for (Index k=0;k<dataBlock->elts_.size();++k) {
-                                                const Index row=dataBlock->getRow((int)k);
-                                                const Index col=dataBlock->getCol((int)k);
-                                                yTemp[row].mulacc(dataBlock->elts_[k],x[col]);
-					}
+        TaskPool& pool=TaskPool::current();
+        const Field_& fieldRef=field();
+        pool.parallelFor(0,y.size(),1024,[&](size_t i) {
+                new ((void*)(yTemp+i)) FieldAXPY<Field_>(fieldRef);
+        });
+
+	Index numBlockSizes=rowBlocks_.size();
+	for (Index chunkSizeIx=0;chunkSizeIx<numBlockSizes;++chunkSizeIx) {
+		const VectorChunks *rowChunks=&(rowBlocks_[chunkSizeIx]);
+		pool.parallelFor(0,rowChunks->size(),1,[&](size_t rowChunk) {
+			const BlockList *blocks=&((*rowChunks)[rowChunk]);
+			Index numBlocks=blocks->size();
+			for (Index block=0;block<numBlocks;++block) {
+                                const DataBlock *dataBlock=&((*blocks)[block]);
+				for (Index k=0;k<dataBlock->elts_.size();++k) {
+                                        const Index row=dataBlock->getRow((int)k);
+                                        const Index col=dataBlock->getCol((int)k);
+                                        yTemp[row].mulacc(dataBlock->elts_[k],x[col]);
 				}
 			}
-			//implicit barrier
-		}
-#ifdef __LINBOX_USE_OPENMP
-#pragma omp for schedule (static,1024)
-#endif
-		for (Index i = 0; i < y.size(); ++i) {
-			yTemp[i].get(y[i]);
-			yTemp[i].~FieldAXPY<Field_>();
-		}
+		});
 	}
 
+        pool.parallelFor(0,y.size(),1024,[&](size_t i) {
+		yTemp[i].get(y[i]);
+		yTemp[i].~FieldAXPY<Field_>();
+	});
+
 	delete[] yTempSpace;
         return y;
 }
@@ -369,49 +338,34 @@ OutVector & SparseMatrix<Field_,SparseMatrixFormat::TPL_omp>::applyTranspose(Out
 	size_t spacePtr=(size_t)yTempSpace;
 	FieldAXPY<Field_>* yTemp=(FieldAXPY<Field_>*)(spacePtr+CACHE_ALIGNMENT-(spacePtr%CACHE_ALIGNMENT));
 
-
-#ifdef __LINBOX_USE_OPENMP
-#pragma omp parallel
-#endif
-	{
-                const Field_& fieldRef=field();
-#ifdef __LINBOX_USE_OPENMP
-#pragma omp for schedule (static,1024)
-#endif
-                for (size_t i=0;i<y.size();++i) {
-                        new ((void*)(yTemp+i)) FieldAXPY<Field_>(fieldRef);
-                }
-
-		Index numBlockSizes=colBlocks_.size();
-		for (Index chunkSizeIx=0;chunkSizeIx<numBlockSizes;++chunkSizeIx) {
-			const VectorChunks *colChunks=&(colBlocks_[chunkSizeIx]);
-			Index numChunks=colChunks->size();
-#ifdef __LINBOX_USE_OPENMP
-#pragma omp for schedule (static,1)
-#endif
-			for (Index colChunk=0;colChunk<numChunks;++colChunk) {
-				const BlockList *blocks=&((*colChunks)[colChunk]);
-				Index numBlocks=blocks->size();
-				for (Index block=0;block<numBlocks;++block) {
-                                        const DataBlock *dataBlock=&((*blocks)[block]);
-					for (Index k=0;k<dataBlock->elts_.size();++k) {
-                                                const Index row=dataBlock->getRow((int)k);
-                                                const Index col=dataBlock->getCol((int)k);
-                                                yTemp[col].mulacc(dataBlock->elts_[k],x[row]);
-					}
+        TaskPool& pool=TaskPool::current();
+        const Field_& fieldRef=field();
+        pool.parallelFor(0,y.size(),1024,[&](size_t i) {
+                new ((void*)(yTemp+i)) FieldAXPY<Field_>(fieldRef);
+        });
+
+	Index numBlockSizes=colBlocks_.size();
+	for (Index chunkSizeIx=0;chunkSizeIx<numBlockSizes;++chunkSizeIx) {
+		const VectorChunks *colChunks=&(colBlocks_[chunkSizeIx]);
+		pool.parallelFor(0,colChunks->size(),1,[&](size_t colChunk) {
+			const BlockList *blocks=&((*colChunks)[colChunk]);
+			Index numBlocks=blocks->size();
+			for (Index block=0;block<numBlocks;++block) {
+                                const DataBlock *dataBlock=&((*blocks)[block]);
+				for (Index k=0;k<dataBlock->elts_.size();++k) {
+                                        const Index row=dataBlock->getRow((int)k);
+                                        const Index col=dataBlock->getCol((int)k);
+                                        yTemp[col].mulacc(dataBlock->elts_[k],x[row]);
 				}
 			}
-			//implicit barrier
-		}
-#ifdef __LINBOX_USE_OPENMP
-#pragma omp for schedule (static,1024)
-#endif
-		for (Index i = 0; i < y.size(); ++i) {
-			yTemp[i].get(y[i]);
-			yTemp[i].~FieldAXPY<Field_>();
-		}
+		});
 	}
 
+        pool.parallelFor(0,y.size(),1024,[&](size_t i) {
+		yTemp[i].get(y[i]);
+		yTemp[i].~FieldAXPY<Field_>();
+	});
+
 	delete[] yTempSpace;
         return y;
 }
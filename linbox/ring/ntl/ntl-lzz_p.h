@@ -333,6 +333,15 @@ namespace LinBox
 		typedef RingCategories::ModularTag categoryTag;
 	};
 
+	//! The modulus of NTL::zz_p is per thread.
+	template <>
+	struct ThreadContext<NTL_zz_p> {
+		explicit ThreadContext(const NTL_zz_p&) { _context.save(); }
+		void restore() const { _context.restore(); }
+	private:
+		NTL::zz_pContext _context;
+	};
+
 	template<>
 	class UnparametricRandIter<NTL::zz_p> {
 	public:
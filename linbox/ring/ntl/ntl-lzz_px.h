@@ -639,6 +639,15 @@ namespace LinBox
 		const Target& _target;
 	}; // end Hom<NTL_zz_pX, NTL_zz_pE>
 
+	//! The modulus of the coefficients, NTL::zz_p, is per thread.
+	template <>
+	struct ThreadContext<NTL_zz_pX> {
+		explicit ThreadContext(const NTL_zz_pX&) { _context.save(); }
+		void restore() const { _context.restore(); }
+	private:
+		NTL::zz_pContext _context;
+	};
+
 } // end of namespace LinBox
 
 #endif // __LINBOX_field_ntl_lzz_px_H
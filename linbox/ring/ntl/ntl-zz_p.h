@@ -471,6 +471,15 @@ namespace LinBox
 		typedef RingCategories::ModularTag categoryTag;
 	};
 
+	//! The modulus of NTL::ZZ_p is per thread.
+	template <>
+	struct ThreadContext<NTL_ZZ_p> {
+		explicit ThreadContext(const NTL_ZZ_p&) { _context.save(); }
+		void restore() const { _context.restore(); }
+	private:
+		NTL::ZZ_pContext _context;
+	};
+
 	/// Constructor for random field element generator
 	template <>
 	class UnparametricRandIter<NTL::ZZ_p> {
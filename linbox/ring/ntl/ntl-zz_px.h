@@ -339,6 +339,14 @@ namespace LinBox
 		CoeffField _CField;
 	}; // end of class NTL_ZZ_pX
 
+	//! The modulus of the coefficients, NTL::ZZ_p, is per thread.
+	template <>
+	struct ThreadContext<NTL_ZZ_pX> {
+		explicit ThreadContext(const NTL_ZZ_pX&) { _context.save(); }
+		void restore() const { _context.restore(); }
+	private:
+		NTL::ZZ_pContext _context;
+	};
 
 } // end of namespace LinBox
 
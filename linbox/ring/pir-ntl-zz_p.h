@@ -53,6 +53,14 @@ namespace LinBox
 		typedef RingCategories::ModularTag categoryTag;
 	};
 
+	template <class Ring>
+	struct ThreadContext;
+
+	template <>
+	struct ThreadContext<PIR_ntl_ZZ_p> : public ThreadContext<NTL_ZZ_p> {
+		explicit ThreadContext(const NTL_ZZ_p& r) : ThreadContext<NTL_ZZ_p>(r) {}
+	};
+
 	/** \brief extend Wrapper of ZZ_p from NTL.  Add PIR functions
 	  \ingroup field
 	  */
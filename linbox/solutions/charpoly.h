@@ -26,6 +26,7 @@
 #define __LINBOX_charpoly_H
 
 #include "linbox/solutions/methods.h"
+#include "linbox/solutions/cost-model.h"
 #include "linbox/util/debug.h"
 #include "linbox/field/field-traits.h"
 #include "linbox/matrix/dense-matrix.h"
@@ -72,6 +73,7 @@ namespace LinBox
 	Polynomial& charpoly (Polynomial         & P,
                               const Blackbox     & A,
                               const MyMethod     & M){
+		TaskPool::Scope scope(M.taskPool());
 		return charpoly ( P, A, typename FieldTraits<typename Blackbox::Field>::categoryTag(), M);
 	}
 
@@ -193,7 +195,7 @@ namespace LinBox
 						  const Method::Auto	       & M)
 	{
 		commentator().start ("Integer Charpoly", "Icharpoly");
-		if (useBlackboxMethod(A))
+		if (useBlackboxMethod(A, M))
 			charpoly(P, A, tag, Method::Blackbox(M) );
 		else
 			charpoly(P, A, tag, Method::DenseElimination(M) );
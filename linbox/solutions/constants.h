@@ -38,7 +38,20 @@
 #define LINBOX_DEFAULT_EARLY_TERMINATION_THRESHOLD 10
 #endif
 
-// Used to decide which method to use when using Method::Auto on a Blackbox or Sparse matrix.
+// Below this row or column dimension, Method::Auto on a Blackbox or Sparse matrix does not consider
+// blackbox methods (see solutions/cost-model.h).
 #if !defined(LINBOX_USE_BLACKBOX_THRESHOLD)
 #define LINBOX_USE_BLACKBOX_THRESHOLD 1000u
 #endif
+
+// From this row and column dimension, Method::Auto prunes a sparse matrix by structured Gaussian elimination
+// before its rank or determinant (see algorithms/structured-gauss.h).
+#if !defined(LINBOX_STRUCTURED_GAUSS_THRESHOLD)
+#define LINBOX_STRUCTURED_GAUSS_THRESHOLD 1000u
+#endif
+
+// Bytes of memory the dense elimination of an OutOfCoreMatrix may use, when the method does not say
+// (see MethodBase::memoryBudget and algorithms/out-of-core-elimination.h).
+#if !defined(LINBOX_OUT_OF_CORE_MEMORY_BUDGET)
+#define LINBOX_OUT_OF_CORE_MEMORY_BUDGET (size_t(1) << 30)
+#endif
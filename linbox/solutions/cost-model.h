@@ -0,0 +1,357 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file solutions/cost-model.h
+ * @ingroup solutions
+ * @brief Estimated running times of elimination and blackbox methods, used by Method::Auto.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "linbox/integer.h"
+#include "linbox/matrix/dense-matrix.h"
+#include "linbox/solutions/constants.h"
+#include "linbox/solutions/methods.h"
+#include "linbox/util/commentator.h"
+#include "linbox/util/error.h"
+#include "linbox/vector/blas-vector.h"
+
+namespace LinBox {
+
+    template <class _Field, class _Storage>
+    class SparseMatrix;
+
+    /**
+     * \brief Constants of the cost model of Method::Auto, in seconds per basic step.
+     *
+     * The defaults are rough values for a recent x86 core and a word size prime field.
+     * A profile measured on the target machine is written by benchmarks/benchmark-cost-profile
+     * (see the Optimizer of benchmarks/optimizer.h) and read by load().
+     * global() loads the file named by the environment variable LINBOX_COST_PROFILE, if any,
+ * and keeps the defaults with a warning if that file cannot be read.
+     *
+     * The file holds one "name value" pair per line after a "linbox-cost-profile 1" line.
+     * Unknown names are ignored, missing ones keep their default.
+     */
+    struct CostProfile {
+        static constexpr uint32_t Version = 1;
+
+        double denseOp = 1e-10;       //!< Dense elimination, per m n r.
+        double sparseOp = 5e-9;       //!< Sparse elimination, per r w^2 with w the row weight after fill-in.
+        double fillExponent = 0.5;    //!< Row weight after fill-in w = min(n, w0 r^fillExponent).
+        double applyOp = 3e-9;        //!< Sparse apply, per nonzero.
+        double dotOp = 1e-9;          //!< Projections of the Krylov sequences, per element.
+        double masseyOp = 2e-9;       //!< Berlekamp/Massey, per L^2 for a sequence of length L.
+        double generatorOp = 1e-9;    //!< Block generator, per b^2 L log(L)^2 for a block sequence of length L.
+        double blockEfficiency = 0.8; //!< Part of the extra threads used by the b applies of a block step.
+
+        /// Reads a profile written by save(); throws LinboxError if the file cannot be read.
+        void load(const std::string& path)
+        {
+            std::ifstream file(path);
+            std::string name;
+            uint32_t version = 0;
+            if (!(file >> name >> version) || name != "linbox-cost-profile" || version != Version)
+                throw LinboxError("LinBox ERROR: " + path + " is not a cost profile");
+            double value;
+            while (file >> name >> value) {
+                if (double* field = find(name)) *field = value;
+            }
+        }
+
+        void save(const std::string& path) const
+        {
+            std::ofstream file(path);
+            file.precision(6);
+            file << "linbox-cost-profile " << Version << std::endl;
+            for (const auto& entry : entries()) file << entry.first << " " << *entry.second << std::endl;
+            if (!file) throw LinboxError("LinBox ERROR: cannot write cost profile " + path);
+        }
+
+        /// The profile named by LINBOX_COST_PROFILE, or the defaults with a warning if it cannot be read.
+        static CostProfile fromEnvironment()
+        {
+            CostProfile p;
+            const char* path = std::getenv("LINBOX_COST_PROFILE");
+            if (path == nullptr) return p;
+            try {
+                p.load(path);
+            } catch (const LinboxError& e) {
+                commentator().report(Commentator::LEVEL_IMPORTANT, INTERNAL_WARNING)
+                    << e.what() << ", using the default cost profile" << std::endl;
+                p = CostProfile();
+            }
+            return p;
+        }
+
+        /// The profile used by Method::Auto.
+        static CostProfile& global()
+        {
+            static CostProfile profile = fromEnvironment();
+            return profile;
+        }
+
+    private:
+        std::vector<std::pair<std::string, const double*>> entries() const
+        {
+            return {{"denseOp", &denseOp},
+                    {"sparseOp", &sparseOp},
+                    {"fillExponent", &fillExponent},
+                    {"applyOp", &applyOp},
+                    {"dotOp", &dotOp},
+                    {"masseyOp", &masseyOp},
+                    {"generatorOp", &generatorOp},
+                    {"blockEfficiency", &blockEfficiency}};
+        }
+
+        double* find(const std::string& name)
+        {
+            for (const auto& entry : entries())
+                if (entry.first == name) return const_cast<double*>(entry.second);
+            return nullptr;
+        }
+    };
+
+    /// Methods compared by Method::Auto.
+    enum class AutoChoice { DenseElimination, SparseElimination, Wiedemann, BlockWiedemann };
+
+    /**
+     * \brief Estimated times of each method on a given problem, infinite when a method does not apply.
+     */
+    struct MethodCosts {
+        double denseElimination = std::numeric_limits<double>::infinity();
+        double sparseElimination = std::numeric_limits<double>::infinity();
+        double wiedemann = std::numeric_limits<double>::infinity();
+        double blockWiedemann = std::numeric_limits<double>::infinity();
+
+        /// Cheapest method; BlockWiedemann is only considered when the caller has an implementation of it.
+        AutoChoice best(bool withBlockWiedemann = false) const
+        {
+            AutoChoice choice = AutoChoice::SparseElimination;
+            double cost = sparseElimination;
+            if (denseElimination < cost) {
+                choice = AutoChoice::DenseElimination;
+                cost = denseElimination;
+            }
+            if (wiedemann < cost) {
+                choice = AutoChoice::Wiedemann;
+                cost = wiedemann;
+            }
+            if (withBlockWiedemann && blockWiedemann < cost) choice = AutoChoice::BlockWiedemann;
+            return choice;
+        }
+    };
+
+    /**
+     * \brief What the cost model needs to know of a matrix and its field.
+     */
+    struct CostInput {
+        size_t rowdim = 0;
+        size_t coldim = 0;
+        double nonZeros = 0;          //!< Nonzero entries, or their equivalent for the apply time of a blackbox.
+        double applyTime = 0;         //!< Seconds for one apply.
+        double conversionTime = 0;    //!< Seconds to get the entries of a blackbox before elimination.
+        double fieldFactor = 1;       //!< Cost of a field operation relative to a word size prime field.
+        bool blas = true;             //!< Whether dense elimination over the field goes through BLAS.
+        size_t numProjections = 1;    //!< Scalar Wiedemann projections.
+        size_t blockingFactor = LINBOX_DEFAULT_BLOCKING_FACTOR;
+        size_t numThreads = 1;        //!< Threads of the pool, only used by the block Wiedemann estimate.
+    };
+
+    /**
+     * \brief Estimated times from the counts of CostInput and the constants of the profile.
+     *
+     * Elimination and scalar Wiedemann run on a single thread; only the block applies
+     * and projections of block Wiedemann are spread over the threads of the pool.
+     */
+    inline MethodCosts estimateCosts(const CostInput& in, const CostProfile& profile = CostProfile::global())
+    {
+        MethodCosts costs;
+        const double m = (double)in.rowdim, n = (double)in.coldim;
+        const double r = std::max(1.0, std::min(m, n));
+        const double threads = (double)std::max<size_t>(in.numThreads, 1) - 1;
+        const double blockSpeedup = 1 + threads * profile.blockEfficiency;
+
+        if (in.blas) {
+            costs.denseElimination = in.conversionTime + profile.denseOp * m * n * r;
+        }
+
+        const double w0 = std::max(1.0, in.nonZeros / std::max(1.0, m));
+        const double w = std::min(n, w0 * std::pow(r, profile.fillExponent));
+        costs.sparseElimination = in.conversionTime + profile.sparseOp * in.fieldFactor * r * w * w;
+
+        // 2r terms, each one apply and k dot products, then Berlekamp/Massey on each of the k sequences.
+        const double L = 2 * r;
+        const double k = (double)std::max<size_t>(in.numProjections, 1);
+        costs.wiedemann = L * in.applyTime + profile.dotOp * in.fieldFactor * k * n * L
+                          + profile.masseyOp * in.fieldFactor * k * L * L;
+
+        // 2r/b terms (plus the 10 extra steps of BlackboxBlockContainer), each b applies
+        // and a b x n times n x b product, then the matrix generator.
+        const double b = (double)in.blockingFactor;
+        if (b > 1) {
+            const double Lb = 2 * r / b + 10;
+            const double logL = std::log2(Lb + 1);
+            costs.blockWiedemann = Lb * b * in.applyTime / blockSpeedup
+                                   + profile.dotOp * in.fieldFactor * b * b * n * Lb / blockSpeedup
+                                   + profile.generatorOp * in.fieldFactor * b * b * b * Lb * logL * logL;
+        }
+        return costs;
+    }
+
+    namespace CostModel {
+        // Relative cost of the arithmetic, and whether dense elimination over F goes through BLAS.
+        template <class Field>
+        void fieldInput(CostInput& in, const Field& F)
+        {
+            integer c, q;
+            F.characteristic(c);
+            F.cardinality(q);
+            // Integers (cardinality 0) are handled modulo word size primes.
+            if (q <= 1) return;
+            in.blas = (c == q) && (q < BlasBound);
+            const double bits = (double)q.bitsize();
+            in.fieldFactor = std::pow(std::max(1.0, bits / 64), 1.58);
+            if (c != q && c > 1) {
+                const double degree = bits / (double)c.bitsize();
+                in.fieldFactor *= degree * degree;
+            }
+        }
+
+        // Sparse matrices: the apply time follows the number of nonzeros.
+        template <class Field, class Storage>
+        void matrixInput(CostInput& in, const SparseMatrix<Field, Storage>& A, const CostProfile& profile)
+        {
+            in.nonZeros = (double)A.size();
+            in.applyTime = profile.applyOp * in.fieldFactor * in.nonZeros;
+        }
+
+        // Dense matrices: every entry counts.
+        template <class Field>
+        void matrixInput(CostInput& in, const DenseMatrix<Field>& A, const CostProfile& profile)
+        {
+            in.nonZeros = (double)A.rowdim() * (double)A.coldim();
+            in.applyTime = profile.applyOp * in.fieldFactor * in.nonZeros;
+        }
+
+        // Other blackboxes: one apply is timed (two if the first is too short for the clock),
+        // elimination first needs coldim() of them.
+        template <class Blackbox>
+        void matrixInput(CostInput& in, const Blackbox& A, const CostProfile& profile)
+        {
+            typedef typename Blackbox::Field Field;
+            const Field& F = A.field();
+            BlasVector<Field> x(F, A.coldim(), F.one), y(F, A.rowdim());
+            size_t count = 0;
+            std::chrono::duration<double> elapsed(0);
+            const auto start = std::chrono::steady_clock::now();
+            do {
+                A.apply(y, x);
+                ++count;
+                elapsed = std::chrono::steady_clock::now() - start;
+            } while (elapsed.count() < 1e-3 && count < 2);
+            in.applyTime = elapsed.count() / (double)count;
+            in.nonZeros = in.applyTime / (profile.applyOp * in.fieldFactor);
+            in.conversionTime = in.applyTime * (double)A.coldim();
+        }
+    }
+
+    /**
+     * \brief Estimated times of each method for A with the options (blocking factor, number of
+     * projections, and threads for block Wiedemann) of method.
+     */
+    template <class Blackbox>
+    MethodCosts estimateCosts(const Blackbox& A, const MethodBase& method,
+                              const CostProfile& profile = CostProfile::global())
+    {
+        CostInput in;
+        in.rowdim = A.rowdim();
+        in.coldim = A.coldim();
+        CostModel::fieldInput(in, A.field());
+        CostModel::matrixInput(in, A, profile);
+        in.numProjections = std::max<size_t>(method.numProjections, 1);
+        in.blockingFactor = method.blockingFactor;
+        in.numThreads = method.taskPool().numThreads();
+        return estimateCosts(in, profile);
+    }
+
+    /**
+     * \brief The method Method::Auto uses for A.
+     *
+     * Below LINBOX_USE_BLACKBOX_THRESHOLD rows or columns, only elimination is considered.
+     * Otherwise the cheapest estimate of estimateCosts() wins; BlockWiedemann only when
+     * withBlockWiedemann is set by a caller that implements it.
+     */
+    template <class Blackbox>
+    AutoChoice chooseMethod(const Blackbox& A, const MethodBase& method, bool withBlockWiedemann = false)
+    {
+        MethodCosts costs = estimateCosts(A, method);
+        if ((A.coldim() <= LINBOX_USE_BLACKBOX_THRESHOLD) || (A.rowdim() <= LINBOX_USE_BLACKBOX_THRESHOLD)) {
+            costs.wiedemann = costs.blockWiedemann = std::numeric_limits<double>::infinity();
+        }
+        return costs.best(withBlockWiedemann);
+    }
+
+    // Dense matrices are already stored for elimination.
+    template <class Field>
+    AutoChoice chooseMethod(const DenseMatrix<Field>& A, const MethodBase&, bool = false)
+    {
+        CostInput in;
+        CostModel::fieldInput(in, A.field());
+        return in.blas ? AutoChoice::DenseElimination : AutoChoice::SparseElimination;
+    }
+
+    /// Whether Method::Auto should use a blackbox method on A rather than elimination.
+    template <class Matrix>
+    bool useBlackboxMethod(const Matrix& A, const MethodBase& method = MethodBase())
+    {
+        if ((A.coldim() <= LINBOX_USE_BLACKBOX_THRESHOLD) || (A.rowdim() <= LINBOX_USE_BLACKBOX_THRESHOLD)) {
+            return false;
+        }
+        const AutoChoice choice = chooseMethod(A, method);
+        return (choice == AutoChoice::Wiedemann) || (choice == AutoChoice::BlockWiedemann);
+    }
+
+    template <class Field>
+    bool useBlackboxMethod(const DenseMatrix<Field>&, const MethodBase& = MethodBase())
+    {
+        return false;
+    }
+}
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
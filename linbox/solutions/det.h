@@ -33,6 +33,7 @@
 #include "linbox/blackbox/diagonal.h"
 #include "linbox/blackbox/compose.h"
 #include "linbox/solutions/methods.h"
+#include "linbox/solutions/cost-model.h"
 #include "linbox/solutions/getentry.h"
 #include "linbox/vector/blas-vector.h"
 
@@ -42,6 +43,8 @@
 #include "linbox/algorithms/massey-domain.h"
 #include "linbox/matrix/matrix-domain.h"
 #include "linbox/algorithms/gauss.h"
+#include "linbox/algorithms/structured-gauss.h"
+#include "linbox/field/gf2.h"
 #include "linbox/vector/vector-traits.h"
 #include "linbox/util/prime-stream.h"
 #include "linbox/util/debug.h"
@@ -104,6 +107,7 @@ namespace LinBox
 						const Blackbox				&A,
 						const MyMethod				&Meth)
 	{
+		TaskPool::Scope scope(Meth.taskPool());
 		return det(d, A, typename FieldTraits<typename Blackbox::Field>::categoryTag(), Meth);
 	}
 
@@ -113,9 +117,55 @@ namespace LinBox
 						  Blackbox                              &A,
 						  const MyMethod                        &Meth)
 	{
+		TaskPool::Scope scope(Meth.taskPool());
 		return detInPlace(d, A, typename FieldTraits<typename Blackbox::Field>::categoryTag(), Meth);
 	}
 
+	// The det with Auto Method of a large sparse matrix, after structured Gaussian elimination
+	// when it makes the matrix smaller enough; false if not used.
+	template<class Blackbox>
+	bool detByStructuredGauss (typename Blackbox::Field::Element &, const Blackbox &, const Method::Auto &)
+	{
+		return false;
+	}
+
+	template<class Storage>
+	bool detByStructuredGauss (GF2::Element &, const SparseMatrix<GF2, Storage> &, const Method::Auto &)
+	{
+		return false;
+	}
+
+	template<class Field, class Storage>
+	bool detByStructuredGauss (typename Field::Element		&d,
+				   const SparseMatrix<Field, Storage>	&A,
+				   const Method::Auto			&Meth)
+	{
+		if (!Meth.structuredElimination || A.rowdim() != A.coldim()
+		    || A.rowdim() < LINBOX_STRUCTURED_GAUSS_THRESHOLD)
+			return false;
+		if (!StructuredGauss<Field>::mayPayOff(A))
+			return false;
+
+		StructuredGauss<Field> SG(A.field());
+		SG.reduce(A, Meth.taskPool());
+		if (SG.singular()) {
+			A.field().assign(d, A.field().zero);
+			return true;
+		}
+		if (!SG.paysOff())
+			return false;
+
+		typename Field::Element dr;
+		A.field().assign(dr, A.field().one);
+		if (SG.reduced().rowdim() > 0) {
+			Method::Auto M(Meth);
+			M.structuredElimination = false;
+			det(dr, SG.reduced(), RingCategories::ModularTag(), M);
+		}
+		SG.det(d, dr);
+		return true;
+	}
+
 	// The det with Auto Method
 	template<class Blackbox>
 	typename Blackbox::Field::Element &det (typename Blackbox::Field::Element	&d,
@@ -123,11 +173,18 @@ namespace LinBox
 						const RingCategories::ModularTag	&tag,
 						const Method::Auto			&Meth)
 	{
-		if (useBlackboxMethod(A))
-			return det(d, A, tag, Method::Blackbox(Meth));
-		else
+		if (detByStructuredGauss(d, A, Meth))
+			return d;
 
-			return det(d, A, tag, Method::Elimination(Meth));
+		// There is no block Wiedemann determinant, BlockWiedemann is not a candidate.
+		switch (chooseMethod(A, Meth)) {
+		case AutoChoice::Wiedemann:
+			return det(d, A, tag, Method::Blackbox(Meth));
+		case AutoChoice::DenseElimination:
+			return det(d, A, tag, Method::DenseElimination(Meth));
+		default:
+			return det(d, A, tag, Method::SparseElimination(Meth));
+		}
 	}
 	template<class Blackbox>
 	typename Blackbox::Field::Element &detInPlace (typename Blackbox::Field::Element	&d,
@@ -362,6 +419,7 @@ namespace LinBox
 			for(size_t j = 0; j < A.coldim(); ++j)
 				A1.setEntry(i,j,getEntry(tmp, A, i, j));
 		GaussDomain<Field> GD ( A1.field() );
+		GD.setPivotSearch (Meth.pivotSearch);
 		GD.detInPlace (d, A1, Meth.pivotStrategy);
 		commentator().stop ("done", NULL, "SEDet");
 		return d;
@@ -381,6 +439,7 @@ namespace LinBox
 		// We make a copy as these data will be destroyed
 		SparseMatrix<Field, SparseMatrixFormat::SparseSeq> A1 (A);
 		GaussDomain<Field> GD ( A.field() );
+		GD.setPivotSearch (Meth.pivotSearch);
 		GD.detInPlace (d, A1, Meth.pivotStrategy);
 		commentator().stop ("done", NULL, "SEDet");
 		return d;
@@ -396,6 +455,7 @@ namespace LinBox
 			throw LinboxError("LinBox ERROR: matrix must be square for determinant computation\n");
         commentator().start ("Sparse Elimination Determinant in place", "SEDetin", A.rowdim() );
 		GaussDomain<Field> GD ( A.field() );
+		GD.setPivotSearch (Meth.pivotSearch);
 		GD.detInPlace (d, A, Meth.pivotStrategy);
         commentator().stop ("done", NULL, "SEDetin");
 		return d;
@@ -606,9 +666,52 @@ namespace LinBox
 #include "linbox/algorithms/rational-cra-var-prec.h"
 #include "linbox/algorithms/cra-builder-var-prec-early-single.h"
 #include "linbox/algorithms/det-rational.h"
+#include "linbox/algorithms/dense-integer-det.h"
 namespace LinBox
 {
 
+	// The elimination methods on a dense integer matrix: batched PLUQ determinants
+	// and last invariant factor, see dense_integer_det, or the distributed
+	// remaindering of cra_det when the method has a communicator.
+	template <class Ring, class MyMethod>
+	typename Ring::Element &blas_integer_det (typename Ring::Element &d,
+						  const BlasMatrix<Ring>  &A,
+						  const MyMethod          &Meth)
+	{
+#ifdef __LINBOX_HAVE_MPI
+		if (Meth.pCommunicator != nullptr)
+			return cra_det(d, A, RingCategories::IntegerTag(), Meth, Meth.pCommunicator);
+#endif
+		return dense_integer_det(d, A, Meth);
+	}
+
+	template <class Ring>
+	typename Ring::Element &det (typename Ring::Element                   &d,
+				     const BlasMatrix<Ring>                   &A,
+				     const RingCategories::IntegerTag          &tag,
+				     const Method::Auto                        &Meth)
+	{
+		return blas_integer_det(d, A, Meth);
+	}
+
+	template <class Ring>
+	typename Ring::Element &det (typename Ring::Element                   &d,
+				     const BlasMatrix<Ring>                   &A,
+				     const RingCategories::IntegerTag          &tag,
+				     const Method::Elimination                 &Meth)
+	{
+		return blas_integer_det(d, A, Meth);
+	}
+
+	template <class Ring>
+	typename Ring::Element &det (typename Ring::Element                   &d,
+				     const BlasMatrix<Ring>                   &A,
+				     const RingCategories::IntegerTag          &tag,
+				     const Method::DenseElimination            &Meth)
+	{
+		return blas_integer_det(d, A, Meth);
+	}
+
 	template <class Blackbox, class MyMethod>
 	typename Blackbox::Field::Element &det (typename Blackbox::Field::Element         &d,
 						const Blackbox                            &A,
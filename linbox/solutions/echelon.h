@@ -662,6 +662,7 @@ namespace LinBox {
 
 // Elimination
 #include "./echelon/echelon-dense-elimination.h"
+#include "./echelon/echelon-out-of-core.h"
 // #include "./echelon/echelon-elimination.h"
 // #include "./echelon/echelon-sparse-elimination.h"
 
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+#pragma once
+
+#include <linbox/algorithms/out-of-core-elimination.h>
+#include <linbox/field/field-traits.h>
+#include <linbox/matrix/densematrix/out-of-core-matrix.h>
+#include <linbox/solutions/constants.h>
+#include <linbox/solutions/methods.h>
+
+namespace LinBox {
+    //
+    // row echelon of matrices larger than the memory
+    //
+
+    namespace Protected {
+        inline size_t outOfCoreMemoryBudget(const MethodBase& M)
+        {
+            return M.memoryBudget ? M.memoryBudget : LINBOX_OUT_OF_CORE_MEMORY_BUDGET;
+        }
+    }
+
+    /**
+     * \brief rowEchelon specialisation for DenseElimination with OutOfCoreMatrix and ModularTag.
+     * At most M.memoryBudget bytes are in memory (see OutOfCoreElimination): E is the work matrix
+     * if its panels fit within it, a temporary file otherwise. The pivots are not normalized.
+     */
+    template <class Field>
+    inline size_t rowEchelon(OutOfCoreMatrix<Field>& E, const OutOfCoreMatrix<Field>& A,
+                             const RingCategories::ModularTag& tag, const Method::DenseElimination& M)
+    {
+        linbox_check((A.coldim() == E.coldim()) && (A.rowdim() == E.rowdim()));
+
+        const size_t budget = Protected::outOfCoreMemoryBudget(M);
+        OutOfCoreElimination<Field> OE(A.field(), budget, M.taskPool());
+        if (OE.fits(E)) {
+            OE.factorize(E, &A);
+            OE.echelonForm(E, E);
+        }
+        else {
+            OutOfCoreMatrix<Field> W(A.field(), A.rowdim(), A.coldim(), OE.panelWidth(A.rowdim(), budget));
+            OE.factorize(W, &A);
+            OE.echelonForm(E, W);
+        }
+        return OE.rank();
+    }
+
+    /**
+     * \brief rowEchelon specialisation for Auto with OutOfCoreMatrix and ModularTag.
+     */
+    template <class Field>
+    inline size_t rowEchelon(OutOfCoreMatrix<Field>& E, const OutOfCoreMatrix<Field>& A,
+                             const RingCategories::ModularTag& tag, const Method::Auto& m)
+    {
+        return rowEchelon(E, A, tag, reinterpret_cast<const Method::DenseElimination&>(m));
+    }
+
+    /**
+     * \brief rowEchelonize specialisation for DenseElimination with OutOfCoreMatrix and ModularTag.
+     * In place if the panels of A fit within M.memoryBudget, through a temporary file otherwise.
+     */
+    template <class Field>
+    inline size_t rowEchelonize(OutOfCoreMatrix<Field>& A, const RingCategories::ModularTag& tag,
+                                const Method::DenseElimination& M)
+    {
+        const size_t budget = Protected::outOfCoreMemoryBudget(M);
+        OutOfCoreElimination<Field> OE(A.field(), budget, M.taskPool());
+        if (OE.fits(A)) {
+            OE.factorize(A);
+            OE.echelonForm(A, A);
+        }
+        else {
+            OutOfCoreMatrix<Field> W(A.field(), A.rowdim(), A.coldim(), OE.panelWidth(A.rowdim(), budget));
+            OE.factorize(W, &A);
+            OE.echelonForm(A, W);
+        }
+        return OE.rank();
+    }
+
+    /**
+     * \brief rowEchelonize specialisation for Auto with OutOfCoreMatrix and ModularTag.
+     */
+    template <class Field>
+    inline size_t rowEchelonize(OutOfCoreMatrix<Field>& A, const RingCategories::ModularTag& tag,
+                                const Method::Auto& m)
+    {
+        return rowEchelonize(A, tag, reinterpret_cast<const Method::DenseElimination&>(m));
+    }
+}
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
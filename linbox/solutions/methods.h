@@ -23,9 +23,10 @@
 #pragma once
 
 #include <linbox/field/field-traits.h>
-#include <linbox/matrix/dense-matrix.h> // Only for useBlackboxMethod
+#include <linbox/matrix/dense-matrix.h>
 #include <linbox/solutions/constants.h>
 #include <linbox/util/mpicpp.h>
+#include <linbox/util/task-pool.h>
 #include <string>
 
 /**
@@ -66,19 +67,6 @@
 
 namespace LinBox {
 
-    // Used to decide which method to use when using Method::Auto on a Blackbox or Sparse matrix.
-    template <class Matrix>
-    bool useBlackboxMethod(const Matrix& A)
-    {
-        return (A.coldim() > LINBOX_USE_BLACKBOX_THRESHOLD) && (A.rowdim() > LINBOX_USE_BLACKBOX_THRESHOLD);
-    }
-
-    template <class Field>
-    bool useBlackboxMethod(const LinBox::DenseMatrix<Field>& A)
-    {
-        return false;
-    }
-
     /**
      * Rank of the system, if known.
      */
@@ -174,8 +162,11 @@ namespace LinBox {
      * Pivoting strategy for elimination-based methods.
      */
     enum class PivotStrategy {
-        None,
-        Linear,
+        None,           //!< First non-zero of each row.
+        Linear,         //!< Sparsest row, sparsest column in it (Dumas-Villard).
+        Markowitz,      //!< Smallest (r-1)(c-1) among the sparsest rows and columns, see MethodBase::pivotSearch.
+        ColumnOrdering, //!< Columns ordered beforehand by approximate minimum degree (COLAMD-like), sparsest row in each.
+        Singletons,     //!< Singleton columns and rows first, then as Linear.
     };
 
     /**
@@ -196,6 +187,7 @@ namespace LinBox {
         MethodBase(Preconditioner _preconditioner) : preconditioner(_preconditioner) {}
         MethodBase(Dispatch _dispatch) : dispatch(_dispatch) {}
         MethodBase(Communicator* _pCommunicator) : pCommunicator(_pCommunicator) {}
+        MethodBase(TaskPool* _pTaskPool) : pTaskPool(_pTaskPool) {}
         MethodBase(PivotStrategy _pivotStrategy) : pivotStrategy(_pivotStrategy) {}
         MethodBase(SingularSolutionType _singularSolutionType) : singularSolutionType(_singularSolutionType) {}
 
@@ -213,8 +205,15 @@ namespace LinBox {
         Communicator* pCommunicator = nullptr;
         bool master() const { return (pCommunicator == nullptr) || pCommunicator->master(); }
 
+        // ----- Shared-memory parallelism.
+        TaskPool* pTaskPool = nullptr; //!< Threads used by the computation, TaskPool::current() if null.
+        TaskPool& taskPool() const { return (pTaskPool == nullptr) ? TaskPool::current() : *pTaskPool; }
+
         // ----- For Elimination-based methods.
         PivotStrategy pivotStrategy = PivotStrategy::Linear;
+        size_t pivotSearch = 4; //!< Rows and columns examined by PivotStrategy::Markowitz for each pivot.
+        bool structuredElimination = true; //!< Whether Method::Auto may first prune a sparse matrix, see StructuredGauss.
+        size_t memoryBudget = 0; //!< Bytes for the elimination of an OutOfCoreMatrix, LINBOX_OUT_OF_CORE_MEMORY_BUDGET if 0.
 
         // ----- For Dixon method.
         // @fixme SingularSolutionType::Deterministic fails with Dense Dixon
@@ -232,6 +231,7 @@ namespace LinBox {
 
         // ----- For Wiedemann (Berlekamp Massey) methods.
         size_t earlyTerminationThreshold = LINBOX_DEFAULT_EARLY_TERMINATION_THRESHOLD;
+        size_t numProjections = 1; //!< Left projections sharing the Krylov sequence, see suggestedNumProjections() for small fields.
     };
 
     /**
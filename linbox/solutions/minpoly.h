@@ -86,6 +86,7 @@ namespace LinBox
 			     const Blackbox & A,
 			     const MyMethod & M)
 	{
+		TaskPool::Scope scope(M.taskPool());
 		return minpoly (P, A, typename FieldTraits<typename Blackbox::Field>::categoryTag(), M);
 	}
 
@@ -41,6 +41,8 @@
 #include "linbox/algorithms/massey-domain.h"
 #include "linbox/algorithms/gauss.h"
 #include "linbox/algorithms/gauss-gf2.h"
+#include "linbox/algorithms/structured-gauss.h"
+#include "linbox/algorithms/out-of-core-elimination.h"
 #include "linbox/matrix/matrix-domain.h"
 #include "linbox/algorithms/whisart_trace.h"
 #include "linbox/matrix/dense-matrix.h"
@@ -49,6 +51,8 @@
 #include "linbox/vector/vector-traits.h"
 #include "linbox/solutions/trace.h"
 #include "linbox/solutions/methods.h"
+#include "linbox/solutions/cost-model.h"
+#include "linbox/solutions/echelon/echelon-out-of-core.h"
 
 
 #include "linbox/util/debug.h"
@@ -109,6 +113,7 @@ namespace LinBox
 	inline size_t &rank (size_t &r, const Blackbox &A,
 				    const Method &M)
 	{
+		TaskPool::Scope scope(M.taskPool());
 		return rank(r, A, typename FieldTraits<typename Blackbox::Field>::categoryTag(), M);
 	}
 
@@ -40,19 +40,64 @@ namespace LinBox
 {
 
 
+	// Rank with Method::Auto of a large sparse matrix, after structured Gaussian elimination
+	// when it makes the matrix smaller enough; false if not used.
+	template <class Blackbox>
+	inline bool rankByStructuredGauss (size_t &, const Blackbox &, const Method::Auto &)
+	{
+		return false;
+	}
+
+	template <class Storage>
+	inline bool rankByStructuredGauss (size_t &, const SparseMatrix<GF2, Storage> &, const Method::Auto &)
+	{
+		return false;
+	}
+
+	template <class Field, class Storage>
+	inline bool rankByStructuredGauss (size_t                            &r,
+					   const SparseMatrix<Field, Storage> &A,
+					   const Method::Auto                 &m)
+	{
+		if (!m.structuredElimination
+		    || A.rowdim() < LINBOX_STRUCTURED_GAUSS_THRESHOLD || A.coldim() < LINBOX_STRUCTURED_GAUSS_THRESHOLD)
+			return false;
+		if (!StructuredGauss<Field>::mayPayOff(A))
+			return false;
+
+		StructuredGauss<Field> SG(A.field());
+		SG.reduce(A, m.taskPool());
+		if (!SG.paysOff())
+			return false;
+
+		size_t rr = 0;
+		if (SG.reduced().rowdim() > 0 && SG.reduced().coldim() > 0) {
+			Method::Auto mm(m);
+			mm.structuredElimination = false;
+			rank(rr, SG.reduced(), RingCategories::ModularTag(), mm);
+		}
+		r = SG.rank(rr);
+		return true;
+	}
+
 	template <class Blackbox>
 	inline size_t &rank (size_t                    &r,
 				    const Blackbox                   &A,
 				    const RingCategories::ModularTag &tag,
 				    const Method::Auto             &m)
 	{
+		if (rankByStructuredGauss(r, A, m))
+			return r;
+
 		// we need a BB/Blas hybrid in the style of Duran/Saunders/Wan.
-		//! @bug choose (benchmark) better cuttoff (size, nbnz, sparse rep)
-		if (useBlackboxMethod(A)) {
+		// There is no block Wiedemann rank, BlockWiedemann is not a candidate.
+		switch (chooseMethod(A, m)) {
+		case AutoChoice::Wiedemann:
 			return rank(r, A, tag, Method::Blackbox(m ));
-		}
-		else {
-			return rank(r, A, tag, Method::Elimination( m ));
+		case AutoChoice::DenseElimination:
+			return rank(r, A, tag, Method::DenseElimination( m ));
+		default:
+			return rank(r, A, tag, Method::SparseElimination( m ));
 		}
 	}
 
@@ -429,6 +474,33 @@ namespace LinBox
 		return r;
 	}
 
+	// M may be <code>Method::DenseElimination()</code>: at most M.memoryBudget bytes
+	// are in memory, A is copied panel by panel to a temporary file and eliminated there.
+	template <class Field>
+	inline size_t &rank (size_t                           &r,
+				    const OutOfCoreMatrix<Field>        &A,
+				    const RingCategories::ModularTag   &tag,
+				    const Method::DenseElimination      &M)
+	{
+		commentator().start ("Out-of-core Rank", "oocrank");
+		const size_t budget = Protected::outOfCoreMemoryBudget(M);
+		OutOfCoreElimination<Field> OE(A.field(), budget, M.taskPool());
+		OutOfCoreMatrix<Field> W(A.field(), A.rowdim(), A.coldim(), OE.panelWidth(A.rowdim(), budget));
+		r = OE.factorize(W, &A);
+		commentator().stop ("done", NULL, "oocrank");
+		return r;
+	}
+
+	// An OutOfCoreMatrix is only eliminated by panels.
+	template <class Field>
+	inline size_t &rank (size_t                           &r,
+				    const OutOfCoreMatrix<Field>        &A,
+				    const RingCategories::ModularTag   &tag,
+				    const Method::Auto                  &M)
+	{
+		return rank(r, A, tag, Method::DenseElimination(M));
+	}
+
 
 	template <class Blackbox, class MyMethod>
 	inline size_t &integral_rank (size_t	&r,
@@ -653,6 +725,7 @@ namespace LinBox { /*  rankInPlace */
 	{
 		commentator().start ("Sparse Elimination Rank", "serank");
 		GaussDomain<typename Blackbox::Field> GD (A.field());
+		GD.setPivotSearch(M.pivotSearch);
 		GD.rankInPlace( r, A, M.pivotStrategy);
 		commentator().stop ("done", NULL, "serank");
 		return r;
@@ -29,6 +29,7 @@
 #include <vector>
 #include <iterator>
 #include "linbox/util/error.h"
+#include "linbox/solutions/methods.h"
 #include "linbox/algorithms/matrix-hom.h"
 #include "linbox/algorithms/smith-form-adaptive.h"
 #include "givaro/zring.h"
@@ -122,6 +123,7 @@ namespace LinBox
 			  const Blackbox                     & A,
 			  const Method                     & M)
 	{
+		TaskPool::Scope scope(M.taskPool());
 		smithForm(S, A, typename FieldTraits<typename Blackbox::Field>::categoryTag(), M);
 		return S;
 	}
@@ -131,6 +133,7 @@ namespace LinBox
 			  const Blackbox                     & A,
 			  const Method                     & M)
 	{
+		TaskPool::Scope scope(M.taskPool());
 		smithForm(V, A, typename FieldTraits<typename Blackbox::Field>::categoryTag(), M);
 		return V;
 	}
@@ -54,8 +54,9 @@ namespace LinBox {
      *      - DenseMatrix   > Method::DenseElimination
      *      - SparseMatrix  > Method::SparseElimination
      *      - Otherwise
-     *      |   - Row or column dimension < LINBOX_USE_BLACKBOX_THRESHOLD > Method::Elimination
-     *      |   - Otherwise                                               > Method::Blackbox
+     *      |   - Row or column dimension <= LINBOX_USE_BLACKBOX_THRESHOLD > Method::Elimination
+     *      |   - Otherwise, Method::Blackbox if the cost model (solutions/cost-model.h) estimates
+     *      |     Wiedemann faster than elimination from nnz and field, else Method::Elimination
      * - Method::Elimination
      *      - DenseMatrix   > Method::DenseElimination
      *      - SparseMatrix  > Method::SparseElimination
@@ -129,6 +130,7 @@ namespace LinBox {
     template <class ResultVector, class Matrix, class Vector, class SolveMethod>
     inline ResultVector& solve(ResultVector& x, const Matrix& A, const Vector& b, const SolveMethod& m)
     {
+        TaskPool::Scope scope(m.taskPool());
         return solve(x, A, b, typename FieldTraits<typename Matrix::Field>::categoryTag(), m);
     }
 
@@ -235,6 +237,7 @@ namespace LinBox {
     template <class IntVector, class Matrix, class Vector, class SolveMethod>
     inline void solve(IntVector& xNum, typename IntVector::Element& xDen, const Matrix& A, const Vector& b, const SolveMethod& m)
     {
+        TaskPool::Scope scope(m.taskPool());
         solve(xNum, xDen, A, b, typename FieldTraits<typename Matrix::Field>::categoryTag(), m);
     }
 
@@ -275,6 +278,7 @@ namespace LinBox {
     template <class ResultVector, class Matrix, class Vector, class SolveMethod>
     inline ResultVector& solveInPlace(ResultVector& x, Matrix& A, const Vector& b, const SolveMethod& m)
     {
+        TaskPool::Scope scope(m.taskPool());
         return solveInPlace(x, A, b, typename FieldTraits<typename Matrix::Field>::categoryTag(), m);
     }
 
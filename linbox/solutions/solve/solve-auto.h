@@ -24,6 +24,7 @@
 
 #include <linbox/matrix/dense-matrix.h>
 #include <linbox/matrix/sparse-matrix.h>
+#include <linbox/solutions/cost-model.h>
 #include <linbox/solutions/methods.h>
 
 namespace LinBox {
@@ -37,7 +38,7 @@ namespace LinBox {
     template <class ResultVector, class Matrix, class Vector, class CategoryTag>
     ResultVector& solve(ResultVector& x, const Matrix& A, const Vector& b, const CategoryTag& tag, const Method::Auto& m)
     {
-        if (useBlackboxMethod(A)) {
+        if (useBlackboxMethod(A, m)) {
             return solve(x, A, b, tag, reinterpret_cast<const Method::Blackbox&>(m));
         }
         else {
@@ -109,7 +110,7 @@ namespace LinBox {
     template <class ResultVector, class Matrix, class Vector, class CategoryTag>
     ResultVector& solveInPlace(ResultVector& x, Matrix& A, const Vector& b, const CategoryTag& tag, const Method::Auto& m)
     {
-        if (useBlackboxMethod(A)) {
+        if (useBlackboxMethod(A, m)) {
             return solve(x, A, b, tag, reinterpret_cast<const Method::Blackbox&>(m));
         }
         else {
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file util/checkpoint.h
+ * @ingroup util
+ * @brief Periodic saving of the state of long computations, to resume them after a failure.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "linbox/util/error.h"
+#include "linbox/util/serialization.h"
+
+namespace LinBox {
+
+    /**
+     * \brief File holding the last saved state of a computation.
+     *
+     * The state is written with the binary format of util/serialization.h,
+     * after a small header (magic, version and length of the state).
+     * A new checkpoint first goes to path.tmp, then replaces the previous one,
+     * so that a failure while saving keeps the previous checkpoint.
+     *
+     * Algorithms accepting a checkpoint (ChineseRemainderSequential::setCheckpoint,
+     * RationalReconstruction::setCheckpoint) save when due() and, when the file exists,
+     * resume from it instead of starting over.
+     * The file is never removed by the algorithms: call remove() once the result is safe.
+     *
+     * Objects can be saved directly when they provide
+     * <code>uint64_t serialize(std::vector<uint8_t>&) const</code> and
+     * <code>uint64_t unserialize(const std::vector<uint8_t>&, uint64_t offset)</code>,
+     * as the CRA builders do.
+     */
+    class Checkpoint {
+    public:
+        static constexpr uint32_t Magic = 0x4B43424C; // "LBCK"
+        static constexpr uint32_t Version = 1;
+
+        /// The state will be saved to path, at most every period seconds.
+        explicit Checkpoint(const std::string& path, double period = 600.0)
+            : _path(path)
+            , _period(period)
+            , _lastSave(std::chrono::steady_clock::now())
+        {
+        }
+
+        const std::string& path() const { return _path; }
+
+        double period() const { return _period; }
+
+        /// Whether period seconds have passed since the last save.
+        bool due() const
+        {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - _lastSave;
+            return elapsed.count() >= _period;
+        }
+
+        /// Replaces the checkpoint with the serialized state.
+        void save(const std::vector<uint8_t>& state)
+        {
+            std::vector<uint8_t> bytes;
+            serialize(bytes, Magic);
+            serialize(bytes, Version);
+            serialize(bytes, static_cast<uint64_t>(state.size()));
+            bytes.insert(bytes.end(), state.begin(), state.end());
+
+            const std::string tmpPath = _path + ".tmp";
+            {
+                std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+                file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+                if (!file) throw LinboxError("LinBox ERROR: cannot write checkpoint " + tmpPath);
+            }
+            if (std::rename(tmpPath.c_str(), _path.c_str()) != 0) {
+                throw LinboxError("LinBox ERROR: cannot write checkpoint " + _path);
+            }
+
+            _lastSave = std::chrono::steady_clock::now();
+        }
+
+        template <class State>
+        void save(const State& state)
+        {
+            std::vector<uint8_t> bytes;
+            state.serialize(bytes);
+            save(bytes);
+        }
+
+        /**
+         * \brief Reads the serialized state.
+         * @returns false if there is no checkpoint yet.
+         */
+        bool load(std::vector<uint8_t>& state) const
+        {
+            std::ifstream file(_path, std::ios::binary);
+            if (!file) return false;
+
+            std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            const uint64_t headerSize = 16u;
+            uint32_t magic = 0, version = 0;
+            uint64_t size = 0;
+            if (bytes.size() >= headerSize) {
+                unserialize(magic, bytes, 0u);
+                unserialize(version, bytes, 4u);
+                unserialize(size, bytes, 8u);
+            }
+            if (magic != Magic || version != Version || bytes.size() != headerSize + size) {
+                throw LinboxError("LinBox ERROR: " + _path + " is not a valid checkpoint");
+            }
+
+            state.assign(bytes.begin() + headerSize, bytes.end());
+            return true;
+        }
+
+        /// @returns false if there is no checkpoint yet.
+        template <class State>
+        bool restore(State& state) const
+        {
+            std::vector<uint8_t> bytes;
+            if (!load(bytes)) return false;
+            state.unserialize(bytes, 0u);
+            return true;
+        }
+
+        /// Removes the checkpoint, once the computation is done.
+        void remove() const { std::remove(_path.c_str()); }
+
+    private:
+        std::string _path;
+        double _period;
+        std::chrono::steady_clock::time_point _lastSave;
+    };
+}
+
@@ -250,11 +250,14 @@ namespace LinBox
         if (act->_progress > act->_len)
             act->_len = act->_progress;
 
+        // Progress is called in inner loops: nothing is formatted when it is not printed
         std::ostream &rep = report (LEVEL_IMPORTANT, PROGRESS_REPORT);
-        rep.precision (3);
-        rep.setf (std::ios::fixed);
-        rep << "Progress: " << act->_progress << " out of " << act->_len
-        << " (" << act->_timer.time () << "s elapsed)" << std::endl;
+        if (!isNullStream (rep)) {
+            rep.precision (3);
+            rep.setf (std::ios::fixed);
+            rep << "Progress: " << act->_progress << " out of " << act->_len
+            << " (" << act->_timer.time () << "s elapsed)" << std::endl;
+        }
 
         if (_show_progress && isPrinted (_activities.size () - 1, LEVEL_IMPORTANT, BRIEF_REPORT, act->_fn))
             updateActivityReport (*act);
@@ -34,15 +34,19 @@ namespace LinBox {
         inline int rank() const { return 0; }
         inline bool master() const { return true; }
 
-        template <class T> inline void send(const T& value, int dest) {}
-        template <class T> inline void ssend(const T& value, int dest) {}
-        template <class T> inline void recv(T& value, int src) {}
+        template <class T> inline void send(const T& value, int dest, int tag = 0) {}
+        template <class T> inline void ssend(const T& value, int dest, int tag = 0) {}
+        template <class T> inline void recv(T& value, int src, int tag = 0) {}
         template <class T> inline void bcast(T& value, int src) {}
+        inline bool iprobe(int src, int tag = 0) { return false; }
     };
 }
 #else
 
 #include <mpi.h>
+#include <vector>
+
+#include "linbox/integer.h"
 
 namespace LinBox {
     /**
@@ -83,12 +87,19 @@ namespace LinBox {
         template <class Ptr> void recv(Ptr begin, Ptr end, int dest, int tag);
         template <class X> void recv(X* begin, X* end, int dest, int tag);
 
-        // whole object communication
-        template <class T> void send(const T& value, int dest);
-        template <class T> void ssend(const T& value, int dest);
-        template <class T> void recv(T& value, int src);
+        // whole object communication, src may be MPI_ANY_SOURCE
+        template <class T> void send(const T& value, int dest, int tag = 0);
+        template <class T> void ssend(const T& value, int dest, int tag = 0);
+        template <class T> void recv(T& value, int src, int tag = 0);
         template <class T> void bcast(T& value, int src);
 
+        // Whether a message from src with this tag is waiting to be received, without blocking.
+        bool iprobe(int src, int tag = 0);
+
+        // Integer vectors, all limbs packed in a single message
+        void send(const std::vector<Integer>& values, int dest, int tag = 0);
+        void recv(std::vector<Integer>& values, int src, int tag = 0);
+
     protected:
         MPI_Comm _comm;       // MPI's handle for the communicator
         MPI_Status _status;   // status from most recent receive
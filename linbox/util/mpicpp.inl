@@ -94,31 +94,89 @@ namespace LinBox {
 
     // whole object communication
 
-    template <class T> void Communicator::send(const T& value, int dest)
+    template <class T> void Communicator::send(const T& value, int dest, int tag)
     {
         std::vector<uint8_t> bytes;
         uint64_t length = serialize(bytes, value);
-        MPI_Send(bytes.data(), length, MPI_UINT8_T, dest, 0, _comm);
+        MPI_Send(bytes.data(), length, MPI_UINT8_T, dest, tag, _comm);
     }
 
-    template <class T> void Communicator::ssend(const T& value, int dest)
+    template <class T> void Communicator::ssend(const T& value, int dest, int tag)
     {
         std::vector<uint8_t> bytes;
         uint64_t length = serialize(bytes, value);
-        MPI_Ssend(bytes.data(), length, MPI_UINT8_T, dest, 0, _comm);
+        MPI_Ssend(bytes.data(), length, MPI_UINT8_T, dest, tag, _comm);
     }
 
-    template <class T> void Communicator::recv(T& value, int src)
+    template <class T> void Communicator::recv(T& value, int src, int tag)
     {
         int length = 0;
-        MPI_Probe(src, 0, _comm, &_status);
+        MPI_Probe(src, tag, _comm, &_status);
         MPI_Get_count(&_status, MPI_UINT8_T, &length);
 
+        // With MPI_ANY_SOURCE, the message probed is the one to receive.
         std::vector<uint8_t> bytes(length);
-        MPI_Recv(bytes.data(), length, MPI_UINT8_T, src, 0, _comm, &_status);
+        MPI_Recv(bytes.data(), length, MPI_UINT8_T, _status.MPI_SOURCE, tag, _comm, &_status);
         unserialize(value, bytes);
     }
 
+    inline bool Communicator::iprobe(int src, int tag)
+    {
+        int flag = 0;
+        MPI_Iprobe(src, tag, _comm, &flag, &_status);
+        return flag != 0;
+    }
+
+    // Integer vectors
+    //
+    // Message format, in limbs: the number of integers,
+    // then the signed number of limbs of each integer, then all the limbs.
+
+    inline void Communicator::send(const std::vector<Integer>& values, int dest, int tag)
+    {
+        size_t length = 1 + values.size();
+        for (const auto& value : values) length += mpz_size(value.get_mpz_const());
+
+        std::vector<mp_limb_t> buffer;
+        buffer.reserve(length);
+        buffer.push_back(values.size());
+        for (const auto& value : values) {
+            buffer.push_back(static_cast<mp_limb_t>(static_cast<int64_t>(value.get_mpz_const()->_mp_size)));
+        }
+        for (const auto& value : values) {
+            mpz_srcptr z = value.get_mpz_const();
+            const mp_limb_t* limbs = mpz_limbs_read(z);
+            buffer.insert(buffer.end(), limbs, limbs + mpz_size(z));
+        }
+
+        MPI_Send(buffer.data(), length * sizeof(mp_limb_t), MPI_BYTE, dest, tag, _comm);
+    }
+
+    inline void Communicator::recv(std::vector<Integer>& values, int src, int tag)
+    {
+        int bytes = 0;
+        MPI_Probe(src, tag, _comm, &_status);
+        MPI_Get_count(&_status, MPI_BYTE, &bytes);
+
+        std::vector<mp_limb_t> buffer(bytes / sizeof(mp_limb_t));
+        MPI_Recv(buffer.data(), bytes, MPI_BYTE, _status.MPI_SOURCE, tag, _comm, &_status);
+
+        values.resize(buffer[0]);
+        const mp_limb_t* limbs = buffer.data() + 1 + values.size();
+        for (size_t i = 0; i < values.size(); ++i) {
+            const int64_t size = static_cast<int64_t>(buffer[1 + i]);
+            const mp_size_t n = static_cast<mp_size_t>(size < 0 ? -size : size);
+            mpz_ptr z = values[i].get_mpz();
+            if (n == 0) {
+                mpz_set_ui(z, 0);
+                continue;
+            }
+            std::copy(limbs, limbs + n, mpz_limbs_write(z, n));
+            mpz_limbs_finish(z, size < 0 ? -n : n);
+            limbs += n;
+        }
+    }
+
     template <class T> void Communicator::bcast(T& value, int src)
     {
         uint64_t length = 0;
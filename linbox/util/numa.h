@@ -0,0 +1,253 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file util/numa.h
+ * @ingroup util
+ * @brief Placement of large buffers on the NUMA nodes, and thread pinning.
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <fstream>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "linbox/util/task-pool.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace LinBox {
+
+    /// Where the pages of a buffer are placed.
+    enum class MemoryPolicy {
+        Default,     //!< Left to the system, usually the node of the allocating thread.
+        Interleaved, //!< Pages are spread round-robin over all nodes.
+        FirstTouch,  //!< Thread t of TaskPool::current() touches the t-th part of the buffer, see Numa::threadRange().
+        Partitioned, //!< The buffer is cut in one contiguous part per node (row blocks of a dense matrix).
+    };
+
+    namespace Numa {
+        // Parses a sysfs list such as "0-3,8,10-11".
+        inline std::vector<int> parseList(const std::string& list)
+        {
+            std::vector<int> values;
+            size_t pos = 0;
+            while (pos < list.size()) {
+                int first, last, read = 0;
+                if (std::sscanf(list.c_str() + pos, "%d-%d%n", &first, &last, &read) == 2 && read > 0) {
+                    for (int v = first; v <= last; ++v) values.push_back(v);
+                }
+                else if (std::sscanf(list.c_str() + pos, "%d%n", &first, &read) == 1 && read > 0) {
+                    values.push_back(first);
+                }
+                else {
+                    break;
+                }
+                pos += read;
+                if (pos < list.size() && list[pos] == ',') ++pos;
+            }
+            return values;
+        }
+
+        inline std::string readLine(const std::string& path)
+        {
+            std::ifstream file(path);
+            std::string line;
+            std::getline(file, line);
+            return line;
+        }
+
+        /// Online NUMA nodes, {0} when the topology is unknown.
+        inline const std::vector<int>& nodes()
+        {
+            static const std::vector<int> nodes = []() {
+                auto list = parseList(readLine("/sys/devices/system/node/online"));
+                return list.empty() ? std::vector<int>(1, 0) : list;
+            }();
+            return nodes;
+        }
+
+        inline size_t numNodes() { return nodes().size(); }
+
+        /// CPUs grouped by node: all the CPUs of the first node, then of the second, and so on.
+        inline std::vector<int> cpusByNode()
+        {
+            std::vector<int> cpus;
+            for (int node : nodes()) {
+                auto list = parseList(readLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+                cpus.insert(cpus.end(), list.begin(), list.end());
+            }
+            if (cpus.empty()) {
+                for (unsigned c = 0; c < std::thread::hardware_concurrency(); ++c) cpus.push_back(c);
+            }
+            return cpus;
+        }
+
+        /**
+         * \brief Part [first, second) of [0, count) of thread t among numThreads.
+         * FirstTouch places the pages with this partition over TaskPool::forEachThread():
+         * a thread computing on the rows threadRange(t, numThreads, rowdim) of a dense matrix
+         * finds them on its node, up to one page at each boundary.
+         */
+        inline std::pair<size_t, size_t> threadRange(size_t t, size_t numThreads, size_t count)
+        {
+            return {count * t / numThreads, count * (t + 1) / numThreads};
+        }
+
+        inline size_t pageSize()
+        {
+#if defined(__linux__)
+            return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+            return 4096;
+#endif
+        }
+
+        /**
+         * \brief Sets the policy of the pages of [p, p + bytes), p being page-aligned.
+         * Must be called before the pages are touched.
+         * @returns false if the system did not apply it.
+         */
+        inline bool place(void* p, size_t bytes, MemoryPolicy policy)
+        {
+            if (policy == MemoryPolicy::Default || numNodes() < 2) return true;
+
+            if (policy == MemoryPolicy::FirstTouch) {
+                const size_t page = pageSize();
+                const size_t numPages = (bytes + page - 1) / page;
+                auto& pool = TaskPool::current();
+                const size_t numThreads = pool.numThreads();
+                pool.forEachThread([p, page, numPages, numThreads](size_t t) {
+                    const auto range = threadRange(t, numThreads, numPages);
+                    for (size_t k = range.first; k < range.second; ++k) static_cast<volatile char*>(p)[k * page] = 0;
+                });
+                return true;
+            }
+
+#if defined(__linux__) && defined(SYS_mbind)
+            const unsigned long Bind = 2, Interleave = 3;
+            const unsigned long maxNode = 8 * sizeof(unsigned long);
+
+            if (policy == MemoryPolicy::Interleaved) {
+                unsigned long mask = 0;
+                for (int node : nodes()) mask |= 1ul << node;
+                return syscall(SYS_mbind, p, bytes, Interleave, &mask, maxNode + 1, 0) == 0;
+            }
+
+            // Partitioned, on page boundaries
+            const size_t page = pageSize();
+            const size_t numPages = (bytes + page - 1) / page;
+            bool placed = true;
+            for (size_t k = 0; k < numNodes(); ++k) {
+                const size_t firstPage = numPages * k / numNodes();
+                const size_t lastPage = numPages * (k + 1) / numNodes();
+                if (firstPage == lastPage) continue;
+                unsigned long mask = 1ul << nodes()[k];
+                placed = (syscall(SYS_mbind, static_cast<char*>(p) + firstPage * page, (lastPage - firstPage) * page, Bind,
+                                  &mask, maxNode + 1, 0) == 0)
+                         && placed;
+            }
+            return placed;
+#else
+            return false;
+#endif
+        }
+
+        /// Pins the workers of the pool, one per CPU, filling the nodes one after the other.
+        inline bool pinThreads(TaskPool& pool = TaskPool::global())
+        {
+            return pool.pinWorkers(cpusByNode());
+        }
+    }
+
+    /**
+     * \brief Allocator placing large buffers on the NUMA nodes following Policy.
+     *
+     * To be used as the storage of dense matrices and vectors, e.g.
+     * <code>BlasMatrix<Field, std::vector<Element, NumaAllocator<Element, MemoryPolicy::Interleaved>>></code>.
+     * Buffers of at least MinMappedBytes are mapped directly from the system
+     * so that their pages are placed before being touched, smaller ones use operator new.
+     */
+    template <class T, MemoryPolicy Policy>
+    class NumaAllocator {
+    public:
+        using value_type = T;
+
+        template <class U>
+        struct rebind {
+            using other = NumaAllocator<U, Policy>;
+        };
+
+        static constexpr size_t MinMappedBytes = size_t(1) << 20;
+
+        NumaAllocator() = default;
+
+        template <class U>
+        NumaAllocator(const NumaAllocator<U, Policy>&)
+        {
+        }
+
+        T* allocate(size_t n)
+        {
+            const size_t bytes = n * sizeof(T);
+#if defined(__linux__)
+            if (bytes >= MinMappedBytes) {
+                void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (p == MAP_FAILED) throw std::bad_alloc();
+                Numa::place(p, bytes, Policy);
+                return static_cast<T*>(p);
+            }
+#endif
+            return static_cast<T*>(::operator new(bytes));
+        }
+
+        void deallocate(T* p, size_t n)
+        {
+#if defined(__linux__)
+            if (n * sizeof(T) >= MinMappedBytes) {
+                munmap(p, n * sizeof(T));
+                return;
+            }
+#endif
+            ::operator delete(p);
+        }
+
+        template <class U>
+        bool operator==(const NumaAllocator<U, Policy>&) const
+        {
+            return true;
+        }
+
+        template <class U>
+        bool operator!=(const NumaAllocator<U, Policy>&) const
+        {
+            return false;
+        }
+    };
+}
@@ -21,6 +21,8 @@
 
 #pragma once
 
+#include <algorithm>
+
 #include "serialization.h"
 
 namespace LinBox {
@@ -213,17 +215,19 @@ namespace LinBox {
         uint64_t bytesRead = 0u;
         bytesRead += unserialize(mpSize, bytes, offset + bytesRead);
 
-        mpzStruct->_mp_alloc = std::abs(mpSize);
-        mpzStruct->_mp_size = mpSize;
-        _mpz_realloc(mpzStruct, mpzStruct->_mp_alloc);
+        // @note mpz_limbs_write reallocates properly even when
+        // the integer has no allocated limbs yet (fresh mpz_init).
+        const mp_size_t l = std::abs(mpSize);
+        mp_limb_t* limbs = mpz_limbs_write(mpzStruct, std::max<mp_size_t>(l, 1));
 
         // @note We use this proxy limb for the very same reason
         // than above: the GMP real limb can be 64 or 32.
         uint64_t limb;
-        for (auto i = 0, l = std::abs(mpSize); i < l; ++i) {
+        for (mp_size_t i = 0; i < l; ++i) {
             bytesRead += unserialize(limb, bytes, offset + bytesRead);
-            mpzStruct->_mp_d[i] = static_cast<mp_limb_t>(limb);
+            limbs[i] = static_cast<mp_limb_t>(limb);
         }
+        mpz_limbs_finish(mpzStruct, mpSize);
 
         return bytesRead;
     }
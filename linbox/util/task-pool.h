@@ -0,0 +1,465 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file util/task-pool.h
+ * @ingroup util
+ * @brief Work-stealing thread pool, shared by the parallel algorithms.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace LinBox {
+
+    /**
+     * \brief Work-stealing pool of threads executing tasks.
+     *
+     * A pool of N threads is made of N - 1 workers plus the thread waiting
+     * for the tasks: parallelFor() and get() run pending tasks while waiting,
+     * so that nested parallel sections (a parallel CRA over a parallel sparse
+     * apply for instance) share the same N threads instead of oversubscribing
+     * the machine.
+     *
+     * Each worker owns a queue: it pushes and pops its own tasks at the back,
+     * idle workers steal at the front of the other queues.
+     *
+     * TaskPool::global() is the pool used by default. Its size is the number
+     * of OpenMP threads when compiled with OpenMP, 1 otherwise, and can be changed
+     * with resize(). Methods can carry their own pool, see MethodBase::pTaskPool:
+     * the solutions make it current with a TaskPool::Scope, and the parallel loops
+     * run on TaskPool::current().
+     */
+    class TaskPool {
+    public:
+        explicit TaskPool(size_t numThreads = defaultNumThreads())
+        {
+            start(numThreads);
+        }
+
+        TaskPool(const TaskPool&) = delete;
+        TaskPool& operator=(const TaskPool&) = delete;
+
+        /// Pending tasks which did not start are dropped, their futures get a broken promise.
+        ~TaskPool() { stop(); }
+
+        /// Number of threads, including the waiting one.
+        size_t numThreads() const { return _workers.size() + 1; }
+
+        /// Changes the number of threads, must not be called while tasks are running.
+        void resize(size_t numThreads)
+        {
+            stop();
+            start(numThreads);
+        }
+
+        /**
+         * \brief Runs f() asynchronously.
+         * Within a task, wait for the result with get() rather than std::future::get(),
+         * so that the thread keeps working meanwhile.
+         */
+        template <class Function>
+        auto submit(Function f) -> std::future<decltype(f())>
+        {
+            using Result = decltype(f());
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::move(f));
+            auto future = task->get_future();
+            if (_workers.empty()) {
+                (*task)();
+            }
+            else {
+                push([task]() { (*task)(); });
+            }
+            return future;
+        }
+
+        /// Result of a future, running pending tasks until it is ready.
+        template <class T>
+        T get(std::future<T>& future)
+        {
+            while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                if (!runPendingTask()) std::this_thread::yield();
+            }
+            return future.get();
+        }
+
+        /**
+         * \brief Calls f(i) for i in [first, last).
+         * The range is cut into chunks of grain indices, distributed dynamically.
+         * A grain of 0 lets the pool choose, a few chunks per thread.
+         * The first exception thrown by f is rethrown once all chunks are done.
+         */
+        template <class Function>
+        void parallelFor(size_t first, size_t last, size_t grain, Function&& f)
+        {
+            if (first >= last) return;
+
+            const size_t count = last - first;
+            if (grain == 0) grain = std::max<size_t>(1, count / (4 * numThreads()));
+            const size_t numChunks = (count + grain - 1) / grain;
+
+            if (numChunks == 1 || _workers.empty()) {
+                for (size_t i = first; i < last; ++i) f(i);
+                return;
+            }
+
+            struct State {
+                std::atomic<size_t> nextChunk{0};
+                std::atomic<size_t> runningHelpers{0};
+                std::mutex errorMutex;
+                std::exception_ptr error;
+            };
+            auto state = std::make_shared<State>();
+
+            auto work = [state, first, last, grain, numChunks, &f]() {
+                size_t chunk;
+                while ((chunk = state->nextChunk++) < numChunks) {
+                    const size_t begin = first + chunk * grain;
+                    const size_t end = std::min(last, begin + grain);
+                    try {
+                        for (size_t i = begin; i < end; ++i) f(i);
+                    }
+                    catch (...) {
+                        std::lock_guard<std::mutex> lock(state->errorMutex);
+                        if (!state->error) state->error = std::current_exception();
+                        state->nextChunk = numChunks;
+                    }
+                }
+            };
+
+            const size_t numHelpers = std::min(numChunks, numThreads()) - 1;
+            state->runningHelpers = numHelpers;
+            for (size_t h = 0; h < numHelpers; ++h) {
+                push([state, work]() {
+                    work();
+                    --state->runningHelpers;
+                });
+            }
+
+            work();
+            while (state->runningHelpers > 0) {
+                if (!runPendingTask()) std::this_thread::yield();
+            }
+
+            if (state->error) std::rethrow_exception(state->error);
+        }
+
+        /**
+         * \brief Calls f(t) once on each thread of the pool, t being the index of the thread
+         * (numThreads() - 1 for the calling one), so that the same thread always gets the same t.
+         * Meant for work whose placement matters, such as touching the pages of a buffer
+         * with the partition later used to compute on it.
+         * The call of worker t is queued where only worker t takes it, and the calling
+         * thread runs other pending tasks until all calls are done.
+         * Called from a task of the pool, it runs f(t) for every t in the calling thread.
+         */
+        template <class Function>
+        void forEachThread(Function&& f)
+        {
+            const size_t numWorkers = _workers.size();
+            if (numWorkers == 0 || currentPool() == this) {
+                for (size_t t = 0; t < numThreads(); ++t) f(t);
+                return;
+            }
+
+            struct State {
+                std::atomic<size_t> running{0};
+                std::mutex errorMutex;
+                std::exception_ptr error;
+            };
+            auto state = std::make_shared<State>();
+            auto call = [state, &f](size_t t) {
+                try {
+                    f(t);
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(state->errorMutex);
+                    if (!state->error) state->error = std::current_exception();
+                }
+            };
+
+            state->running = numWorkers;
+            for (size_t w = 0; w < numWorkers; ++w) {
+                pushTo(w, [state, call, w]() {
+                    call(w);
+                    --state->running;
+                });
+            }
+
+            call(numWorkers);
+            while (state->running > 0) {
+                if (!runPendingTask()) std::this_thread::yield();
+            }
+
+            if (state->error) std::rethrow_exception(state->error);
+        }
+
+        /**
+         * \brief Binds worker w to the CPU cpus[w % cpus.size()].
+         * @returns false if thread affinity is not supported or failed.
+         */
+        bool pinWorkers(const std::vector<int>& cpus)
+        {
+            if (cpus.empty()) return false;
+#if defined(__linux__)
+            bool pinned = true;
+            for (size_t w = 0; w < _workers.size(); ++w) {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpus[w % cpus.size()], &set);
+                pinned = (pthread_setaffinity_np(_workers[w].native_handle(), sizeof(set), &set) == 0) && pinned;
+            }
+            return pinned;
+#else
+            return false;
+#endif
+        }
+
+        /// Runs one pending task in the calling thread, returns false if there was none.
+        bool runPendingTask()
+        {
+            std::function<void()> task;
+            if (!pop(task)) return false;
+            task();
+            return true;
+        }
+
+        /// The default pool.
+        static TaskPool& global()
+        {
+            static TaskPool pool;
+            return pool;
+        }
+
+        /**
+         * \brief The pool of the calling thread: the one of the innermost Scope on this thread,
+         * else the pool of which it is a worker, else global().
+         */
+        static TaskPool& current()
+        {
+            if (scopedPool() != nullptr) return *scopedPool();
+            if (currentPool() != nullptr) return *currentPool();
+            return global();
+        }
+
+        /**
+         * \brief Makes a pool current() on the calling thread until the end of the scope.
+         * The tasks it runs are current() on its workers.
+         */
+        class Scope {
+        public:
+            explicit Scope(TaskPool& pool)
+                : _previous(scopedPool())
+            {
+                scopedPool() = &pool;
+            }
+
+            ~Scope() { scopedPool() = _previous; }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            TaskPool* _previous;
+        };
+
+        static size_t defaultNumThreads()
+        {
+#ifdef _OPENMP
+            return std::max(1, omp_get_max_threads());
+#else
+            return 1;
+#endif
+        }
+
+    private:
+        struct Queue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+            std::deque<std::function<void()>> own; // run by the owner only, never stolen
+            size_t numOwn = 0;                      // size of own, guarded by _sleepMutex
+        };
+
+        // Index of the calling thread in this pool, numThreads() - 1 if it is not a worker.
+        size_t threadIndex() const
+        {
+            return (currentPool() == this) ? currentIndex() : _workers.size();
+        }
+
+        static TaskPool*& currentPool()
+        {
+            static thread_local TaskPool* pool = nullptr;
+            return pool;
+        }
+
+        static TaskPool*& scopedPool()
+        {
+            static thread_local TaskPool* pool = nullptr;
+            return pool;
+        }
+
+        static size_t& currentIndex()
+        {
+            static thread_local size_t index = 0;
+            return index;
+        }
+
+        void start(size_t numThreads)
+        {
+            const size_t numWorkers = (numThreads > 1) ? numThreads - 1 : 0;
+            _stopping = false;
+            _pending = 0;
+            _queues.clear();
+            for (size_t w = 0; w < numWorkers; ++w) _queues.emplace_back(new Queue());
+            for (size_t w = 0; w < numWorkers; ++w) _workers.emplace_back([this, w]() { workerLoop(w); });
+        }
+
+        void stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_sleepMutex);
+                _stopping = true;
+            }
+            _wakeUp.notify_all();
+            for (auto& worker : _workers) worker.join();
+            _workers.clear();
+        }
+
+        void workerLoop(size_t index)
+        {
+            currentPool() = this;
+            currentIndex() = index;
+
+            std::function<void()> task;
+            while (true) {
+                if (pop(task)) {
+                    task();
+                    task = nullptr;
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(_sleepMutex);
+                const Queue& queue = *_queues[index];
+                _wakeUp.wait(lock, [this, &queue]() { return _stopping || _pending > 0 || queue.numOwn > 0; });
+                if (_stopping) return;
+            }
+        }
+
+        void push(std::function<void()> task)
+        {
+            const size_t index = threadIndex();
+            Queue& queue = *_queues[(index < _queues.size()) ? index : (_nextQueue++ % _queues.size())];
+            {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.tasks.push_back(std::move(task));
+            }
+            {
+                std::lock_guard<std::mutex> lock(_sleepMutex);
+                ++_pending;
+            }
+            _wakeUp.notify_one();
+        }
+
+        // Task only worker w may run.
+        void pushTo(size_t w, std::function<void()> task)
+        {
+            Queue& queue = *_queues[w];
+            {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.own.push_back(std::move(task));
+            }
+            {
+                std::lock_guard<std::mutex> lock(_sleepMutex);
+                ++queue.numOwn;
+            }
+            _wakeUp.notify_all();
+        }
+
+        // Tasks of the worker only first, then own queue (newest task),
+        // then steal from the others (oldest task).
+        bool pop(std::function<void()>& task)
+        {
+            const size_t numQueues = _queues.size();
+            if (numQueues == 0) return false;
+
+            const size_t index = threadIndex();
+            if (index < numQueues) {
+                Queue& queue = *_queues[index];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (!queue.own.empty()) {
+                    task = std::move(queue.own.front());
+                    queue.own.pop_front();
+                    std::lock_guard<std::mutex> sleepLock(_sleepMutex);
+                    --queue.numOwn;
+                    return true;
+                }
+                if (!queue.tasks.empty()) {
+                    task = std::move(queue.tasks.back());
+                    queue.tasks.pop_back();
+                    --_pending;
+                    return true;
+                }
+            }
+
+            for (size_t k = 1; k <= numQueues; ++k) {
+                Queue& queue = *_queues[(index + k) % numQueues];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (!queue.tasks.empty()) {
+                    task = std::move(queue.tasks.front());
+                    queue.tasks.pop_front();
+                    --_pending;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        std::vector<std::thread> _workers;
+        std::vector<std::unique_ptr<Queue>> _queues;
+        std::atomic<size_t> _nextQueue{0};
+        std::atomic<long> _pending{0};
+        std::mutex _sleepMutex;
+        std::condition_variable _wakeUp;
+        bool _stopping = false;
+    };
+}
@@ -0,0 +1,288 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file util/tracer.h
+ * @ingroup util
+ * @brief Low overhead spans and counters, written as a Chrome trace or as CSV.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "linbox/util/error.h"
+
+namespace LinBox {
+
+    /// What the counters of the trace count.
+    enum class TraceCounter : size_t {
+        SpMV,          //!< Blackbox applies, one per vector of a block.
+        Primes,        //!< Primes used by a CRA loop, good or bad.
+        LiftingDigits, //!< p-adic digits of a Dixon lifting.
+        FillIn,        //!< Net growth of the rows updated by a sparse elimination.
+        BytesMoved,    //!< Bytes written to or read from files.
+        Count
+    };
+
+    /// Name of the counter in the trace files.
+    inline const char* traceCounterName(TraceCounter c)
+    {
+        static const char* names[] = {"SpMV", "primes", "lifting_digits", "fill_in", "bytes_moved"};
+        return names[(size_t)c];
+    }
+
+    /// A closed span: its name, its times in ns since the start of the trace,
+    /// and how much the counters of its thread moved in between (nested spans included).
+    struct TraceEvent {
+        const char* name;
+        uint64_t begin, end;
+        uint64_t counts[(size_t)TraceCounter::Count];
+    };
+
+    /// Spans and counters of one thread. Only this thread writes to it.
+    struct TraceLog {
+        size_t thread;
+        std::vector<TraceEvent> events;
+        uint64_t counts[(size_t)TraceCounter::Count] = {};
+    };
+
+    /**
+     * \brief Collects the spans and counters of all threads.
+     *
+     * Tracing is off by default; then a span or a count costs one relaxed atomic load.
+     * It is turned on by enable(), or by the environment variable LINBOX_TRACE=file,
+     * in which case the trace is written to file at exit:
+     * a Chrome trace (chrome://tracing, ui.perfetto.dev) for a .json file, CSV otherwise.
+     * Defining LINBOX_DISABLE_TRACE removes the LINBOX_TRACE_SPAN and LINBOX_TRACE_COUNT
+     * macros at compile time.
+     *
+     * Each thread records in its own TraceLog, without locks, so write() and total()
+     * must only be called when no traced computation is running.
+     */
+    class Tracer {
+    public:
+        static Tracer& global()
+        {
+            static Tracer tracer;
+            return tracer;
+        }
+
+        ~Tracer()
+        {
+            if (!_path.empty()) {
+                try {
+                    write(_path);
+                } catch (const LinboxError&) {
+                }
+            }
+        }
+
+        bool enabled() const { return _enabled.load(std::memory_order_relaxed); }
+        void enable(bool on = true) { _enabled.store(on, std::memory_order_relaxed); }
+
+        /// Nanoseconds since the tracer was created.
+        uint64_t now() const
+        {
+            return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - _start).count();
+        }
+
+        /// The log of the calling thread, created on first use.
+        TraceLog& log()
+        {
+            static thread_local TraceLog* local = nullptr;
+            if (local == nullptr) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _logs.emplace_back(new TraceLog);
+                local = _logs.back().get();
+                local->thread = _logs.size() - 1;
+            }
+            return *local;
+        }
+
+        void count(TraceCounter c, uint64_t n)
+        {
+            if (enabled()) log().counts[(size_t)c] += n;
+        }
+
+        /// Sum of a counter over all threads.
+        uint64_t total(TraceCounter c) const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            uint64_t sum = 0;
+            for (auto& l : _logs) sum += l->counts[(size_t)c];
+            return sum;
+        }
+
+        /// Forgets the spans and counters recorded so far.
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (auto& l : _logs) {
+                l->events.clear();
+                for (auto& c : l->counts) c = 0;
+            }
+        }
+
+        /// Chrome trace event format: one complete ("X") event per span, counters in args,
+        /// thread totals in otherData.
+        void writeJson(std::ostream& os) const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            os << "{\"traceEvents\":[";
+            const char* sep = "\n";
+            for (auto& l : _logs) {
+                os << sep << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << l->thread
+                   << ",\"args\":{\"name\":\"linbox " << l->thread << "\"}}";
+                sep = ",\n";
+                for (const TraceEvent& e : l->events) {
+                    os << sep << "{\"name\":\"" << e.name << "\",\"cat\":\"linbox\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                       << l->thread << std::fixed << std::setprecision(3) << ",\"ts\":" << e.begin / 1e3
+                       << ",\"dur\":" << (e.end - e.begin) / 1e3 << ",\"args\":{";
+                    const char* argsep = "";
+                    for (size_t c = 0; c < (size_t)TraceCounter::Count; ++c) {
+                        if (e.counts[c] == 0) continue;
+                        os << argsep << '"' << traceCounterName((TraceCounter)c) << "\":" << e.counts[c];
+                        argsep = ",";
+                    }
+                    os << "}}";
+                }
+            }
+            os << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{";
+            sep = "";
+            for (auto& l : _logs) {
+                os << sep << "\"thread " << l->thread << "\":{";
+                for (size_t c = 0; c < (size_t)TraceCounter::Count; ++c)
+                    os << (c ? "," : "") << '"' << traceCounterName((TraceCounter)c) << "\":" << l->counts[c];
+                os << '}';
+                sep = ",";
+            }
+            os << "}}\n";
+        }
+
+        /// One line per span: thread, name, begin and duration in microseconds, then the counters.
+        void writeCsv(std::ostream& os) const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            os << "thread,name,begin_us,duration_us";
+            for (size_t c = 0; c < (size_t)TraceCounter::Count; ++c) os << ',' << traceCounterName((TraceCounter)c);
+            os << '\n' << std::fixed << std::setprecision(3);
+            for (auto& l : _logs) {
+                for (const TraceEvent& e : l->events) {
+                    os << l->thread << ',' << e.name << ',' << e.begin / 1e3 << ',' << (e.end - e.begin) / 1e3;
+                    for (size_t c = 0; c < (size_t)TraceCounter::Count; ++c) os << ',' << e.counts[c];
+                    os << '\n';
+                }
+            }
+        }
+
+        /// Chrome trace if path ends with .json, CSV otherwise.
+        void write(const std::string& path) const
+        {
+            std::ofstream os(path);
+            if (!os) throw LinboxError("LinBox ERROR: cannot write trace " + path);
+            if (path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0)
+                writeJson(os);
+            else
+                writeCsv(os);
+        }
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        Tracer()
+            : _start(Clock::now())
+        {
+            const char* path = std::getenv("LINBOX_TRACE");
+            if (path != nullptr && *path != '\0') {
+                _path = path;
+                enable();
+            }
+        }
+
+        std::atomic<bool> _enabled{false};
+        Clock::time_point _start;
+        std::string _path; //!< Written at exit, from LINBOX_TRACE.
+        mutable std::mutex _mutex;
+        std::vector<std::unique_ptr<TraceLog>> _logs;
+    };
+
+    /// Records a span from its construction to its destruction, when tracing is on.
+    /// The name must outlive the tracer, e.g. a string literal.
+    class TraceSpan {
+    public:
+        explicit TraceSpan(const char* name)
+        {
+            Tracer& tracer = Tracer::global();
+            if (!tracer.enabled()) return;
+            _log = &tracer.log();
+            _event.name = name;
+            for (size_t c = 0; c < (size_t)TraceCounter::Count; ++c) _event.counts[c] = _log->counts[c];
+            _event.begin = tracer.now();
+        }
+
+        ~TraceSpan()
+        {
+            if (_log == nullptr) return;
+            _event.end = Tracer::global().now();
+            for (size_t c = 0; c < (size_t)TraceCounter::Count; ++c) _event.counts[c] = _log->counts[c] - _event.counts[c];
+            _log->events.push_back(_event);
+        }
+
+        TraceSpan(const TraceSpan&) = delete;
+        TraceSpan& operator=(const TraceSpan&) = delete;
+
+    private:
+        TraceLog* _log = nullptr;
+        TraceEvent _event;
+    };
+}
+
+#define __LINBOX_TRACE_CAT2(a, b) a##b
+#define __LINBOX_TRACE_CAT(a, b) __LINBOX_TRACE_CAT2(a, b)
+
+#ifndef LINBOX_DISABLE_TRACE
+/// Traces the enclosing scope under name.
+#define LINBOX_TRACE_SPAN(name) LinBox::TraceSpan __LINBOX_TRACE_CAT(__linbox_trace_span_, __LINE__)(name)
+/// Adds n to the TraceCounter c of the calling thread.
+#define LINBOX_TRACE_COUNT(c, n) LinBox::Tracer::global().count(LinBox::TraceCounter::c, (uint64_t)(n))
+#else
+#define LINBOX_TRACE_SPAN(name) ((void)0)
+#define LINBOX_TRACE_COUNT(c, n) ((void)0)
+#endif
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
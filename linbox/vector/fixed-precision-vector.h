@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2018 The LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "linbox/integer.h"
+#include "linbox/util/debug.h"
+#include "linbox/util/error.h"
+
+namespace LinBox {
+
+    /**
+     * \brief Vector of signed integers sharing one fixed number of GMP limbs.
+     *
+     * Every entry is stored in two's complement on limbs() limbs,
+     * all entries in a single contiguous array.
+     * Subtractions and exact divisions by a word run on the mpn layer of GMP
+     * and never allocate: the storage only grows when prepareSubtraction()
+     * needs more bits than currently available.
+     *
+     * This is a residual representation for p-adic lifting
+     * (see LiftingContainerBase), where each step subtracts a bounded vector
+     * and divides exactly by a word-size prime. The bound on the bit size
+     * of the entries is tracked along these operations.
+     *
+     * Operations on distinct entries may run concurrently.
+     */
+    class FixedPrecisionVector {
+    public:
+        FixedPrecisionVector() = default;
+
+        /// Copy of an integer vector, v.field() must convert its elements to Integer.
+        template <class Vector>
+        explicit FixedPrecisionVector(const Vector& v)
+        {
+            load(v.field(), v);
+        }
+
+        template <class Ring, class Vector>
+        void load(const Ring& R, const Vector& v)
+        {
+            Integer x;
+            size_t bits = 0;
+            for (size_t i = 0; i < v.size(); ++i) {
+                R.convert(x, v[i]);
+                bits = std::max<size_t>(bits, x.bitsize());
+            }
+
+            _size = v.size();
+            _limbs = 0;
+            _data.clear();
+            _bitBound = 0;
+            reserve(bits);
+            _bitBound = bits;
+
+            for (size_t i = 0; i < _size; ++i) {
+                R.convert(x, v[i]);
+                setEntry(i, x);
+            }
+        }
+
+        template <class Ring, class Vector>
+        Vector& store(const Ring& R, Vector& v) const
+        {
+            Integer x;
+            for (size_t i = 0; i < _size; ++i) {
+                R.init(v[i], getEntry(x, i));
+            }
+            return v;
+        }
+
+        size_t size() const { return _size; }
+
+        /// Number of limbs of every entry.
+        size_t limbs() const { return _limbs; }
+
+        /// Every entry is smaller than 2^bitBound() in absolute value.
+        size_t bitBound() const { return _bitBound; }
+
+        Integer& getEntry(Integer& x, size_t i) const
+        {
+            const mp_limb_t* e = entry(i);
+            mpz_ptr z = x.get_mpz();
+            mp_limb_t* d = mpz_limbs_write(z, static_cast<mp_size_t>(_limbs));
+            const bool negative = isNegative(i);
+            if (negative) {
+                mpn_neg(d, e, static_cast<mp_size_t>(_limbs));
+            }
+            else {
+                std::copy(e, e + _limbs, d);
+            }
+
+            mp_size_t n = static_cast<mp_size_t>(_limbs);
+            while (n > 0 && d[n - 1] == 0) --n;
+            mpz_limbs_finish(z, negative ? -n : n);
+            return x;
+        }
+
+        void setEntry(size_t i, const Integer& x)
+        {
+            mpz_srcptr z = x.get_mpz_const();
+            const size_t n = mpz_size(z);
+            linbox_check(x.bitsize() < _limbs * GMP_NUMB_BITS);
+
+            mp_limb_t* e = entry(i);
+            const mp_limb_t* d = mpz_limbs_read(z);
+            std::copy(d, d + n, e);
+            std::fill(e + n, e + _limbs, mp_limb_t(0));
+            if (mpz_sgn(z) < 0) mpn_neg(e, e, static_cast<mp_size_t>(_limbs));
+        }
+
+        bool isNegative(size_t i) const
+        {
+            return (entry(i)[_limbs - 1] >> (GMP_NUMB_BITS - 1)) != 0;
+        }
+
+        /// Grow the storage so that entries up to bits bits (plus sign) fit.
+        void reserve(size_t bits)
+        {
+            const size_t limbs = (bits + 1 + GMP_NUMB_BITS - 1) / GMP_NUMB_BITS;
+            if (limbs <= _limbs) return;
+
+            std::vector<mp_limb_t> data(_size * limbs);
+            for (size_t i = 0; i < _size; ++i) {
+                const mp_limb_t fill = (_limbs > 0 && isNegative(i)) ? ~mp_limb_t(0) : mp_limb_t(0);
+                std::copy(entry(i), entry(i) + _limbs, data.begin() + i * limbs);
+                std::fill(data.begin() + i * limbs + _limbs, data.begin() + (i + 1) * limbs, fill);
+            }
+            _data.swap(data);
+            _limbs = limbs;
+        }
+
+        /**
+         * \brief To be called before subtracting values of at most bits bits from the entries.
+         * Grows the storage if needed, so it must not be called concurrently with other operations.
+         */
+        void prepareSubtraction(size_t bits)
+        {
+            _bitBound = std::max(_bitBound, bits) + 1;
+            reserve(_bitBound);
+        }
+
+        /// To be called once every entry has been divided by p.
+        void completeDivision(mp_limb_t p)
+        {
+            size_t logp = 0;
+            while (p >>= 1) ++logp;
+            _bitBound = (_bitBound > logp) ? _bitBound - logp : 0;
+        }
+
+        /// v[i] -= x, x must satisfy the bound given to prepareSubtraction().
+        void subin(size_t i, const Integer& x)
+        {
+            mpz_srcptr z = x.get_mpz_const();
+            const mp_size_t n = static_cast<mp_size_t>(mpz_size(z));
+            if (n == 0) return;
+
+            mp_limb_t* e = entry(i);
+            const mp_size_t limbs = static_cast<mp_size_t>(_limbs);
+            linbox_check(n <= limbs);
+            if (mpz_sgn(z) > 0) {
+                mpn_sub(e, e, limbs, mpz_limbs_read(z), n);
+            }
+            else {
+                mpn_add(e, e, limbs, mpz_limbs_read(z), n);
+            }
+        }
+
+        /// v[i] mod p, in [0, p).
+        mp_limb_t mod(size_t i, mp_limb_t p) const
+        {
+            return mod(i, p, powerOfBase(p));
+        }
+
+        /// v[i] mod p, in [0, p), with shift = powerOfBase(p), for reducing many entries.
+        mp_limb_t mod(size_t i, mp_limb_t p, mp_limb_t shift) const
+        {
+            const mp_limb_t r = mpn_mod_1(entry(i), static_cast<mp_size_t>(_limbs), p);
+            if (!isNegative(i)) return r;
+
+            // The limbs read as unsigned are v[i] + 2^(limbs * GMP_NUMB_BITS).
+            return (r >= shift) ? r - shift : r + (p - shift);
+        }
+
+        /// 2^(limbs() * GMP_NUMB_BITS) mod p
+        mp_limb_t powerOfBase(mp_limb_t p) const
+        {
+            const mp_limb_t base[2] = {0, 1};
+            const mp_limb_t b = mpn_mod_1(base, 2, p);
+            mp_limb_t r = 1 % p;
+            for (size_t l = 0; l < _limbs; ++l) r = mulmod(r, b, p);
+            return r;
+        }
+
+        /// v[i] /= p, p must divide v[i].
+        void divin(size_t i, mp_limb_t p)
+        {
+            mp_limb_t* e = entry(i);
+            const mp_size_t limbs = static_cast<mp_size_t>(_limbs);
+            if (isNegative(i)) {
+                mpn_neg(e, e, limbs);
+                mpn_divexact_1(e, e, limbs, p);
+                mpn_neg(e, e, limbs);
+            }
+            else {
+                mpn_divexact_1(e, e, limbs, p);
+            }
+        }
+
+        /// p as a single limb, throws if it does not fit.
+        static mp_limb_t toLimb(const Integer& p)
+        {
+            mpz_srcptr z = p.get_mpz_const();
+            if (mpz_sgn(z) <= 0 || mpz_size(z) > 1) {
+                throw LinboxError("FixedPrecisionVector: the divisor must fit in a single limb.");
+            }
+            return mpz_getlimbn(z, 0);
+        }
+
+    private:
+        static mp_limb_t mulmod(mp_limb_t a, mp_limb_t b, mp_limb_t p)
+        {
+            mp_limb_t product[2];
+            product[1] = mpn_mul_1(product, &a, 1, b);
+            return mpn_mod_1(product, 2, p);
+        }
+
+        mp_limb_t* entry(size_t i) { return _data.data() + i * _limbs; }
+        const mp_limb_t* entry(size_t i) const { return _data.data() + i * _limbs; }
+
+        size_t _size = 0;
+        size_t _limbs = 0;
+        size_t _bitBound = 0;
+        std::vector<mp_limb_t> _data;
+    };
+}